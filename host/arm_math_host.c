@@ -0,0 +1,106 @@
+/* -----------------------------------------------------------------------------
+ * arm_math_host.c - Host stand-in for the CMSIS DSP functions used on target
+ *
+ * The pre-compiled CMSIS DSP library only exists for the Cortex-M0+, so host
+ * builds link against this reference implementation instead. The real FFT is
+ * computed in double precision and scaled to the same fixed-point formats the
+ * CMSIS q15 functions produce, i.e. arm_rfft_q15() of length N returns the
+ * full N point complex spectrum downscaled by N and
+ * arm_cmplx_mag_squared_q15() returns (re^2 + im^2) >> 17. On the test
+ * waveform in test_dsp_analysis.c this matches the on-target capture in
+ * documentation/minicom.cap in 255 of 256 bins, the other is off by one.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <math.h>
+#include "arm_math.h"
+
+#define MAX_FFT_LEN  (4096)
+
+// see arm_math.h
+arm_status arm_rfft_init_q15(arm_rfft_instance_q15 *S, uint32_t fftLenReal,
+                             uint32_t ifftFlagR, uint32_t bitReverseFlag) {
+
+  // only power of two forward transforms are needed on host
+  if (S == NULL || fftLenReal < 32 || fftLenReal > MAX_FFT_LEN ||
+      (fftLenReal & (fftLenReal-1)) || ifftFlagR) {
+    return ARM_MATH_ARGUMENT_ERROR;
+  }
+
+  S->fftLenReal = fftLenReal;
+  S->ifftFlagR = ifftFlagR;
+  S->bitReverseFlagR = bitReverseFlag;
+  return ARM_MATH_SUCCESS;
+}
+
+// see arm_math.h
+void arm_rfft_q15(const arm_rfft_instance_q15 *S, q15_t *pSrc, q15_t *pDst) {
+
+  uint32_t n = S->fftLenReal;
+  static double re[MAX_FFT_LEN];
+  static double im[MAX_FFT_LEN];
+  static double tw_re[MAX_FFT_LEN/2];
+  static double tw_im[MAX_FFT_LEN/2];
+  static uint32_t tw_n = 0;
+
+  // twiddle factors are computed once per transform length
+  if (tw_n != n) {
+    for (uint32_t k=0; k<n/2; k++) {
+      tw_re[k] = cos(-2*M_PI*k/n);
+      tw_im[k] = sin(-2*M_PI*k/n);
+    }
+    tw_n = n;
+  }
+
+  // bit reversed copy of the input
+  for (uint32_t i=0, j=0; i<n; i++) {
+    re[j] = pSrc[i];
+    im[j] = 0;
+    uint32_t bit = n>>1;
+    while (j & bit) {
+      j ^= bit;
+      bit >>= 1;
+    }
+    j |= bit;
+  }
+
+  // iterative radix-2 decimation in time
+  for (uint32_t len=2; len<=n; len<<=1) {
+    uint32_t step = n/len;
+    for (uint32_t i=0; i<n; i+=len) {
+      for (uint32_t k=0; k<len/2; k++) {
+        double wr = tw_re[k*step];
+        double wi = tw_im[k*step];
+        uint32_t a = i+k;
+        uint32_t b = i+k+len/2;
+        double tr = re[b]*wr - im[b]*wi;
+        double ti = re[b]*wi + im[b]*wr;
+        re[b] = re[a]-tr;
+        im[b] = im[a]-ti;
+        re[a] += tr;
+        im[a] += ti;
+      }
+    }
+  }
+
+  // the q15 transform is downscaled by n, rounding towards -inf like the
+  // arithmetic shifts of the fixed-point butterflies
+  for (uint32_t i=0; i<n; i++) {
+    pDst[2*i]   = (q15_t)floor(re[i]/n);
+    pDst[2*i+1] = (q15_t)floor(im[i]/n);
+  }
+}
+
+// see arm_math.h
+void arm_cmplx_mag_squared_q15(q15_t *pSrc, q15_t *pDst, uint32_t numSamples) {
+  for (uint32_t i=0; i<numSamples; i++) {
+    q31_t real = pSrc[2*i];
+    q31_t imag = pSrc[2*i+1];
+    pDst[i] = (q15_t)(((q63_t)real*real + (q63_t)imag*imag) >> 17);
+  }
+}
@@ -0,0 +1,168 @@
+/* -----------------------------------------------------------------------------
+ * rec2wav.c - Turns a flash recording dump back into a WAV file
+ *
+ * Reads the output of rec_dump() (see flash_rec.h) as captured from the debug
+ * console, or from fw_sim, and writes the recorded frames back to back as a
+ * 16-bit 48 kHz WAV file that viz_host or fw_sim can replay. ADPCM records
+ * are decoded with the firmware's own coder. Other console output mixed in
+ * with the dump is ignored. The recorded frames are not
+ * contiguous in time; the samples missing between them are counted on stderr.
+ *
+ *   usage: rec2wav DUMP OUT.wav
+ *     DUMP    the captured console output, - for stdin
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include "analog_input.h"
+#include "adpcm.h"
+#include "flash_rec.h"
+#include "src_host.h"
+
+#define LINE_LEN     (256)
+#define BLOCK_BYTES  ADPCM_BLOCK_BYTES(AIN_FRAME_SAMPLES)
+#define MAX_WORDS    (AIN_FRAME_SAMPLES*REC_MAX_CHANNELS)
+
+static uint16_t* samples = NULL;
+static uint32_t nsamples = 0;      // samples stored, all channels
+static uint32_t capacity = 0;
+
+static void _usage() {
+  fprintf(stderr, "usage: rec2wav (DUMP | -) OUT.wav\n");
+  exit(2);
+}
+
+// the 16-bit words of data a record holds
+static uint32_t _record_words(uint32_t nchannels, uint8_t encoding) {
+  return encoding == REC_ADPCM ? nchannels*BLOCK_BYTES/sizeof(uint16_t) :
+                                 nchannels*AIN_FRAME_SAMPLES;
+}
+
+// appends the samples of a complete record, returns -1 if one is corrupt
+static int _append(const uint16_t* words, uint32_t nchannels,
+                   uint8_t encoding) {
+
+  uint32_t n = AIN_FRAME_SAMPLES*nchannels;
+  if (nsamples + n > capacity) {
+    capacity = capacity ? 2*capacity : n*16;
+    samples = realloc(samples, capacity*sizeof(uint16_t));
+    if (samples == NULL) {
+      fprintf(stderr, "rec2wav: out of memory\n");
+      exit(1);
+    }
+  }
+
+  if (encoding == REC_RAW) {
+    memcpy(samples + nsamples, words, n*sizeof(uint16_t));
+  } else {
+    // the words hold the blocks' bytes in little endian order
+    const uint8_t* blocks = (const uint8_t*)words;
+    for (uint32_t ch=0; ch<nchannels; ch++) {
+      if (adpcm_decode(blocks + ch*BLOCK_BYTES, AIN_FRAME_SAMPLES,
+                       samples + nsamples + ch, nchannels)) {
+        return -1;
+      }
+    }
+  }
+  nsamples += n;
+  return 0;
+}
+
+int main(int argc, char** argv) {
+
+  char line[LINE_LEN];
+  static uint16_t words[MAX_WORDS];
+  uint32_t nwords = 0;          // words seen of the current record
+  uint32_t nframes = 0;
+  uint32_t nchannels = 0;
+  uint8_t encoding = REC_RAW;
+  uint32_t last_idx = 0;
+  uint32_t nmissed = 0;         // samples not recorded between frames
+  bool is_in_frame = false;
+
+  if (argc != 3) _usage();
+
+  FILE* in = strcmp(argv[1], "-") ? fopen(argv[1], "r") : stdin;
+  if (in == NULL) {
+    perror(argv[1]);
+    return 1;
+  }
+
+  while (fgets(line, sizeof(line), in) != NULL) {
+
+    uint32_t n, ch, seq, idx, t;
+    int nmatched = 0;
+    if (sscanf(line, "rec frame %" SCNu32 " ch %" SCNu32 " seq %" SCNu32
+               " idx %" SCNu32 " t %" SCNu32 "%n", &n, &ch, &seq, &idx, &t,
+               &nmatched) == 5) {
+      if (is_in_frame && (nwords != _record_words(nchannels, encoding) ||
+                          _append(words, nchannels, encoding))) {
+        fprintf(stderr, "rec2wav: frame %" PRIu32 " is truncated or "
+                "corrupt\n", nframes-1);
+        return 1;
+      }
+      if (ch < 1 || ch > REC_MAX_CHANNELS ||
+          (nchannels && ch != nchannels)) {
+        fprintf(stderr, "rec2wav: frame %" PRIu32 " has %" PRIu32
+                " channels, expected %" PRIu32 "\n", n, ch, nchannels);
+        return 1;
+      }
+      if (nframes) {
+        nmissed += idx - last_idx - AIN_FRAME_SAMPLES;
+      }
+      nchannels = ch;
+      encoding = strncmp(line + nmatched, " adpcm", 6) ? REC_RAW : REC_ADPCM;
+      last_idx = idx;
+      nwords = 0;
+      is_in_frame = true;
+      nframes++;
+      continue;
+    }
+
+    if (!is_in_frame || strncmp(line, "recd", 4)) continue;
+
+    char* p = line+4;
+    char* end;
+    unsigned long value;
+    while ((value = strtoul(p, &end, 16)), end != p) {
+      if (value > UINT16_MAX || nwords == _record_words(nchannels, encoding)) {
+        fprintf(stderr, "rec2wav: bad data in frame %" PRIu32 "\n",
+                nframes-1);
+        return 1;
+      }
+      words[nwords++] = value;
+      p = end;
+    }
+  }
+
+  if (in != stdin) fclose(in);
+
+  if (nframes == 0) {
+    fprintf(stderr, "rec2wav: no recording found\n");
+    return 1;
+  }
+  if (nwords != _record_words(nchannels, encoding) ||
+      _append(words, nchannels, encoding)) {
+    fprintf(stderr, "rec2wav: frame %" PRIu32 " is truncated or corrupt\n",
+            nframes-1);
+    return 1;
+  }
+
+  if (src_wav_write(argv[2], samples, nsamples/nchannels, nchannels)) {
+    return 1;
+  }
+  fprintf(stderr, "rec2wav: %" PRIu32 " frames of %" PRIu32 " channels, "
+          "%" PRIu32 " samples not recorded between them\n", nframes,
+          nchannels, nmissed);
+  free(samples);
+  return 0;
+}
@@ -0,0 +1,104 @@
+/* -----------------------------------------------------------------------------
+ * MKL25Z4.h - Host simulation stand-in for the KL25Z device header
+ *
+ * Found ahead of CMSIS/MKL25Z4.h in the fw_sim build. It pulls in the real
+ * register layouts and bit field macros, but replaces the Cortex-M0+ core
+ * header (inline assembly) with calls into the simulator and points the
+ * peripherals the firmware uses at simulated register files. Every use of a
+ * peripheral pointer first calls sim_access(), which brings the simulated
+ * hardware up to the current virtual time, so plain loads and stores from
+ * the unmodified firmware see (and drive) the peripherals like on target.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _SIM_MKL25Z4_H_
+#define _SIM_MKL25Z4_H_
+
+#include <stdint.h>
+
+// keep the real core header (and its inline assembly) out
+#define __CORE_CM0PLUS_H_GENERIC
+#define __CORE_CM0PLUS_H_DEPENDANT
+
+#define __I   volatile const
+#define __O   volatile
+#define __IO  volatile
+#define __IM  volatile const
+#define __OM  volatile
+#define __IOM volatile
+
+#include "../../CMSIS/MKL25Z4.h"
+
+// the simulated register files, see sim.c
+extern ADC_Type sim_adc0;
+extern DMA_Type sim_dma0;
+extern DMAMUX_Type sim_dmamux0;
+extern TPM_Type sim_tpm0;
+extern TPM_Type sim_tpm1;
+extern TPM_Type sim_tpm2;
+extern SIM_Type sim_sim;
+extern PORT_Type sim_porta;
+extern PORT_Type sim_portd;
+extern GPIO_Type sim_gpioa;
+extern MCG_Type sim_mcg;
+extern SMC_Type sim_smc;
+extern UART0_Type sim_uart0;
+extern SPI_Type sim_spi0;
+
+/*
+ * @brief   Synchronizes the simulated hardware with the firmware
+ *
+ * Picks up the register writes made since the previous call, advances the
+ * virtual clock and runs any interrupt handler that became due.
+ *
+ * @param   none
+ * @return  none
+ */
+void sim_access();
+
+#undef ADC0
+#undef DMA0
+#undef DMAMUX0
+#undef TPM0
+#undef TPM1
+#undef TPM2
+#undef SIM
+#undef PORTA
+#undef PORTD
+#undef GPIOA
+#undef MCG
+#undef SMC
+#undef UART0
+#undef SPI0
+#define ADC0     (sim_access(), &sim_adc0)
+#define DMA0     (sim_access(), &sim_dma0)
+#define DMAMUX0  (sim_access(), &sim_dmamux0)
+#define TPM0     (sim_access(), &sim_tpm0)
+#define TPM1     (sim_access(), &sim_tpm1)
+#define TPM2     (sim_access(), &sim_tpm2)
+#define SIM      (sim_access(), &sim_sim)
+#define PORTA    (sim_access(), &sim_porta)
+#define PORTD    (sim_access(), &sim_portd)
+#define GPIOA    (sim_access(), &sim_gpioa)
+#define MCG      (sim_access(), &sim_mcg)
+#define SMC      (sim_access(), &sim_smc)
+#define UART0    (sim_access(), &sim_uart0)
+#define SPI0     (sim_access(), &sim_spi0)
+
+// the core functions used by the firmware, implemented by the simulator
+uint32_t __get_PRIMASK();
+void __set_PRIMASK(uint32_t primask);
+void __disable_irq();
+void __enable_irq();
+void NVIC_EnableIRQ(IRQn_Type irq);
+void NVIC_DisableIRQ(IRQn_Type irq);
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority);
+void NVIC_ClearPendingIRQ(IRQn_Type irq);
+void NVIC_SetPendingIRQ(IRQn_Type irq);
+uint32_t __get_IPSR();
+
+#endif // _SIM_MKL25Z4_H_
@@ -0,0 +1,27 @@
+/* -----------------------------------------------------------------------------
+ * board.h - Host simulation stand-in for the board support headers
+ *
+ * board.h, clock_config.h, peripherals.h and pin_mux.h all map here. The
+ * init functions are implemented in sim.c.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _SIM_BOARD_H_
+#define _SIM_BOARD_H_
+
+#include "fsl_clock.h"
+
+#define BOARD_DEBUG_UART_CLK_FREQ CLOCK_GetPllFllSelClkFreq()
+#define BOARD_DEBUG_UART_BAUDRATE 115200
+#define BOARD_BOOTCLOCKRUN_CORE_CLOCK 48000000U
+
+void BOARD_InitBootPins(void);
+void BOARD_InitBootClocks(void);
+void BOARD_InitBootPeripherals(void);
+void BOARD_InitDebugConsole(void);
+
+#endif // _SIM_BOARD_H_
@@ -0,0 +1,31 @@
+/* -----------------------------------------------------------------------------
+ * fsl_clock.h - Host simulation stand-in for the SDK clock driver
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _SIM_FSL_CLOCK_H_
+#define _SIM_FSL_CLOCK_H_
+
+#include "fsl_smc.h"
+
+typedef enum _mcg_mode {
+  kMCG_ModeFEI = 0U,
+  kMCG_ModeFBI,
+  kMCG_ModeBLPI,
+  kMCG_ModeFEE,
+  kMCG_ModeFBE,
+  kMCG_ModeBLPE,
+  kMCG_ModePBE,
+  kMCG_ModePEE,
+  kMCG_ModeError
+} mcg_mode_t;
+
+mcg_mode_t CLOCK_GetMode(void);
+uint32_t CLOCK_GetPllFllSelClkFreq(void);
+status_t CLOCK_SetPeeMode(void);
+
+#endif // _SIM_FSL_CLOCK_H_
@@ -0,0 +1,35 @@
+/* -----------------------------------------------------------------------------
+ * fsl_common.h - Host simulation stand-in for the SDK common definitions
+ *
+ * Only the status codes used by the driver stand-ins are provided.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _SIM_FSL_COMMON_H_
+#define _SIM_FSL_COMMON_H_
+
+#include <stdint.h>
+
+typedef int32_t status_t;
+
+#define MAKE_STATUS(group, code)  ((((group)*100) + (code)))
+
+enum {
+  kStatusGroupGeneric = 0,
+  kStatusGroupFlashDriver = 1,
+  kStatusGroup_LPSCI = 12
+};
+
+enum {
+  kStatus_Success = 0,
+  kStatus_Fail = 1,
+  kStatus_ReadOnly = 2,
+  kStatus_OutOfRange = 3,
+  kStatus_InvalidArgument = 4
+};
+
+#endif // _SIM_FSL_COMMON_H_
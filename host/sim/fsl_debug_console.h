@@ -0,0 +1,2 @@
+// host simulation: the debug console is stdout
+#include <stdio.h>
@@ -0,0 +1,53 @@
+/* -----------------------------------------------------------------------------
+ * fsl_flash.h - Host simulation stand-in for the SDK flash driver
+ *
+ * Only the calls made by the firmware are provided. The upper 64 KB of the
+ * 128 KB program flash is mapped at its target address on the host, so the
+ * firmware reads it through plain pointers. Erase and program commands
+ * enforce the FTFA alignment rules and take their typical time with the
+ * core stalled (see sim.c).
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _SIM_FSL_FLASH_H_
+#define _SIM_FSL_FLASH_H_
+
+#include <stdint.h>
+#include "fsl_common.h"
+
+#define FOUR_CHAR_CODE(a, b, c, d) \
+          (((uint32_t)(d) << 24) | ((uint32_t)(c) << 16) | \
+           ((uint32_t)(b) << 8) | ((uint32_t)(a)))
+
+enum {
+  kStatus_FLASH_Success = MAKE_STATUS(kStatusGroupGeneric, 0),
+  kStatus_FLASH_InvalidArgument = MAKE_STATUS(kStatusGroupGeneric, 4),
+  kStatus_FLASH_AlignmentError = MAKE_STATUS(kStatusGroupFlashDriver, 1),
+  kStatus_FLASH_AddressError = MAKE_STATUS(kStatusGroupFlashDriver, 2),
+  kStatus_FLASH_AccessError = MAKE_STATUS(kStatusGroupFlashDriver, 3),
+  kStatus_FLASH_ProtectionViolation = MAKE_STATUS(kStatusGroupFlashDriver, 4),
+  kStatus_FLASH_EraseKeyError = MAKE_STATUS(kStatusGroupFlashDriver, 7)
+};
+
+enum {
+  kFLASH_ApiEraseKey = FOUR_CHAR_CODE('k', 'f', 'e', 'k')
+};
+
+typedef struct {
+  uint32_t PFlashBlockBase;
+  uint32_t PFlashTotalSize;
+  uint32_t PFlashBlockCount;
+  uint32_t PFlashSectorSize;
+} flash_config_t;
+
+status_t FLASH_Init(flash_config_t *config);
+status_t FLASH_Erase(flash_config_t *config, uint32_t start,
+                     uint32_t lengthInBytes, uint32_t key);
+status_t FLASH_Program(flash_config_t *config, uint32_t start, uint32_t *src,
+                       uint32_t lengthInBytes);
+
+#endif // _SIM_FSL_FLASH_H_
@@ -0,0 +1,44 @@
+/* -----------------------------------------------------------------------------
+ * fsl_lpsci.h - Host simulation stand-in for the SDK LPSCI (UART0) driver
+ *
+ * Only the calls made by the firmware are provided. They program the
+ * simulated UART0 registers the way the SDK driver does (see sim.c).
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _SIM_FSL_LPSCI_H_
+#define _SIM_FSL_LPSCI_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "MKL25Z4.h"
+#include "fsl_common.h"
+
+enum {
+  kStatus_LPSCI_BaudrateNotSupport = MAKE_STATUS(kStatusGroup_LPSCI, 5)
+};
+
+status_t LPSCI_SetBaudRate(UART0_Type *base, uint32_t baudRate_Bps,
+                           uint32_t srcClock_Hz);
+
+void LPSCI_WriteByte(UART0_Type *base, uint8_t data);
+
+static inline uint32_t LPSCI_GetDataRegisterAddress(UART0_Type *base) {
+  return (uint32_t)(uintptr_t)&(base->D);
+}
+
+static inline void LPSCI_EnableTxDMA(UART0_Type *base, bool enable) {
+  if (enable) {
+    base->C5 |= UART0_C5_TDMAE_MASK;
+    base->C2 |= UART0_C2_TIE_MASK;
+  } else {
+    base->C5 &= ~UART0_C5_TDMAE_MASK;
+    base->C2 &= ~UART0_C2_TIE_MASK;
+  }
+}
+
+#endif // _SIM_FSL_LPSCI_H_
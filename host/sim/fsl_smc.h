@@ -0,0 +1,34 @@
+/* -----------------------------------------------------------------------------
+ * fsl_smc.h - Host simulation stand-in for the SDK SMC driver
+ *
+ * Only the calls made by the firmware are provided. Entering WAIT or VLPS
+ * lets the virtual clock run until an interrupt wakes the core (see sim.c).
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _SIM_FSL_SMC_H_
+#define _SIM_FSL_SMC_H_
+
+#include <stdint.h>
+#include "MKL25Z4.h"
+#include "fsl_common.h"
+
+typedef enum _smc_power_mode_protection {
+  kSMC_AllowPowerModeVlls = SMC_PMPROT_AVLLS_MASK,
+  kSMC_AllowPowerModeLls  = SMC_PMPROT_ALLS_MASK,
+  kSMC_AllowPowerModeVlp  = SMC_PMPROT_AVLP_MASK,
+  kSMC_AllowPowerModeAll  = (SMC_PMPROT_AVLLS_MASK | SMC_PMPROT_ALLS_MASK |
+                             SMC_PMPROT_AVLP_MASK)
+} smc_power_mode_protection_t;
+
+void SMC_SetPowerModeProtection(SMC_Type *base, uint8_t allowedModes);
+void SMC_PreEnterStopModes(void);
+void SMC_PostExitStopModes(void);
+status_t SMC_SetPowerModeWait(SMC_Type *base);
+status_t SMC_SetPowerModeVlps(SMC_Type *base);
+
+#endif // _SIM_FSL_SMC_H_
@@ -0,0 +1,2 @@
+// host simulation: see board.h
+#include "board.h"
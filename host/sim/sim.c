@@ -0,0 +1,1676 @@
+/* -----------------------------------------------------------------------------
+ * sim.c - Register-level simulation of the KL25Z peripherals used on target
+ *
+ * The firmware reads and writes the register files below with plain loads
+ * and stores. Every peripheral access first calls sim_access() (see the
+ * MKL25Z4.h shim), which
+ *   1. picks up the writes made since the previous access by comparing each
+ *      register file with a shadow copy and applies their side effects,
+ *   2. advances the virtual clock, processing timer overflows, ADC
+ *      conversions, DMA requests and interrupts in time order,
+ *   3. publishes the hardware owned bits (counters, flags, results) back into
+ *      the register files and refreshes the shadows.
+ * A write that stores the value a register already holds cannot be seen this
+ * way. The only such writes the firmware makes are write-1-to-clear flag
+ * acknowledgements in interrupt handlers, so the flag that raised an
+ * interrupt is cleared when its handler returns. Interrupts are taken with
+ * zero entry latency, one at a time in NVIC priority order.
+ *
+ * Flash commands stall the core for their typical time, as the single flash
+ * block cannot be read while it is erased or programmed. UART0 transmits
+ * what DMA or LPSCI_WriteByte() writes into D at the configured baud rate
+ * and raises its interrupt while TIE is set and D has room. Keys from the
+ * run configuration arrive in D with RDRF set once the receiver and RIE are
+ * enabled, raise the interrupt, and are taken as read when its handler
+ * returns.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+#include "MKL25Z4.h"
+#include "fsl_smc.h"
+#include "fsl_clock.h"
+#include "fsl_flash.h"
+#include "fsl_lpsci.h"
+#include "board.h"
+#include "tpm_pixl.h"
+#include "sim.h"
+
+#define NEVER             (UINT64_MAX)
+#define BUS_HZ            (SIM_CORE_HZ/2)
+#define ACCESS_CYCLES     (4)                   // charged per peripheral access
+#define SAMPLE_CYCLES     (SIM_CORE_HZ/48000)   // audio sample period
+#define ALTCLK_HZ         (8000000UL)           // OSCERCLK, the 8 MHz crystal
+#define ADACK_HZ          (4000000UL)           // ADACK with ADLPC = 0
+#define ADACK_LP_HZ       (2400000UL)           // ADACK with ADLPC = 1
+#define PLL_LOCK_CYCLES   (SIM_CORE_HZ/2000)    // ~500 us to relock the PLL
+#define LED_RESET_CYCLES  (SIM_CORE_HZ/20000)   // 50 us low latches WS2812
+#define LED_ONE_CYCLES    (30)                  // high >= 625 ns is a 1 bit
+#define LED_T0H_MIN       (10)                  // a 0 bit is high 200-500 ns
+#define LED_T0H_MAX       (24)
+#define LED_TL_MIN        (14)                  // and any bit low >= 300 ns
+#define LED_STRIPS        (PIXL_NUM_STRIPS)     // on TPM1 channels 0 and 1
+#define LED_IDLE_CYCLES   (SIM_CORE_HZ/200000)  // 5 us low ends a MOSI bit
+#define LED_MASKED_CYCLES (SIM_CORE_HZ/600000)  // 1.67 us, a TPM1 bit period
+#define MAX_WARNINGS      (10)
+#define UART_FRAME_BITS   (10)                  // start, 8 data, stop
+#define FLASH_SIM_BASE    (0x10000U)            // the part mapped on the host
+#define FLASH_SIM_SIZE    (0x10000U)
+#define FLASH_TOTAL_SIZE  (0x20000U)
+#define FLASH_SECTOR_SIZE (1024U)
+#define FLASH_ERASE_CYCLES   (SIM_CORE_HZ/1000*14)  // 14 ms per sector
+#define FLASH_PROGRAM_CYCLES (SIM_CORE_HZ/1000000*65) // 65 us per longword
+
+#define NUM_IRQS          (32)
+#define THREAD_PRIORITY   (4)                   // below all 2-bit priorities
+#define DMA_CHANNELS      (4)
+#define DMA_SRC_UART0_TX  (3)
+#define DMA_SRC_SPI0_TX   (17)
+#define DMA_SRC_ADC0      (40)
+#define DMA_SRC_TPM0_OVF  (54)                  // TPM1, TPM2 follow
+#define ADC_TRGSEL_TPM0   (8)                   // TPM1, TPM2 follow
+#define ADC_CH_DISABLED   (31)
+#define DSR_STATUS_MASK   (0xFF000000U)
+
+// the simulated register files
+ADC_Type sim_adc0;
+DMA_Type sim_dma0;
+DMAMUX_Type sim_dmamux0;
+TPM_Type sim_tpm0;
+TPM_Type sim_tpm1;
+TPM_Type sim_tpm2;
+SIM_Type sim_sim;
+PORT_Type sim_porta;
+PORT_Type sim_portd;
+GPIO_Type sim_gpioa;
+SPI_Type sim_spi0;
+MCG_Type sim_mcg;
+SMC_Type sim_smc;
+UART0_Type sim_uart0;
+
+// the firmware's interrupt handlers, any of which may be missing
+void DMA0_IRQHandler() __attribute__((weak));
+void DMA1_IRQHandler() __attribute__((weak));
+void DMA2_IRQHandler() __attribute__((weak));
+void DMA3_IRQHandler() __attribute__((weak));
+void ADC0_IRQHandler() __attribute__((weak));
+void TPM0_IRQHandler() __attribute__((weak));
+void TPM1_IRQHandler() __attribute__((weak));
+void TPM2_IRQHandler() __attribute__((weak));
+void UART0_IRQHandler() __attribute__((weak));
+
+// a timer/PWM module
+typedef struct {
+  TPM_Type* regs;
+  TPM_Type shadow;
+  int idx;
+  bool is_counting;     // enabled (CMOD) and clocked
+  uint64_t t_zero;      // when the counter was last 0, while counting
+  uint64_t next_ovf;    // when the counter next wraps to 0, while counting
+  uint32_t cnt;         // the counter, while not counting
+  uint32_t ps;          // prescaler shift in use
+  uint32_t mod;         // modulo in use
+  bool tof;             // overflow flag
+  uint32_t duty[2];     // channel 0, 1 values loaded at the last overflow
+} tpm_t;
+
+static const sim_config_t* cfg;
+static sim_stats_t stats;
+static uint64_t now;              // the virtual time, in core cycles
+static struct timespec t_host_start;
+static struct timespec t_cpu_mark;
+static int warnings;
+
+static ADC_Type adc_shadow;
+static DMA_Type dma_shadow;
+static tpm_t tpms[3];
+static bool is_tpm_clock_on;      // the TPM clock is off in VLPS and PBE
+
+static struct {
+  bool is_converting;
+  bool is_cal;
+  bool coco;
+  uint64_t t_done;
+  uint16_t sample;      // sampled when the conversion started
+  uint16_t result;
+} adc;
+
+static struct {
+  bool is_enabled[NUM_IRQS];
+  bool is_pending[NUM_IRQS];
+  uint32_t priority[NUM_IRQS];
+  uint32_t active_priority;
+  uint32_t primask;
+  uint32_t ntaken;
+  uint64_t t_masked;        // when PRIMASK was last set
+  bool is_masked_sending;   // and whether a strip was mid-frame then
+} nvic;
+
+static bool is_stopped;           // in VLPS
+static mcg_mode_t mcg_mode;
+static uint64_t t_pll_lock;
+
+static struct {
+  ain_frame_t frame;
+  uint64_t first_idx;   // sample index of frame.samples[0]
+  bool is_valid;
+} audio;
+
+static struct {
+  uint32_t next_key;    // index of the next key in cfg->keys
+  bool is_presented;    // a key is in D, RDRF set
+  uint8_t rx_data;      // the key presented
+  bool is_tx_full;      // a byte waits for the shifter (TDRE clear)
+  uint8_t tx_data;
+  uint64_t t_shifted;   // when the shifter is done, NEVER when idle
+} uart;
+
+static struct {
+  bool is_tx_full;      // a byte waits for the shifter (SPTEF clear)
+  uint8_t tx_data;
+  uint64_t t_shifted;   // when the shifter is done, NEVER when idle
+  uint32_t high_cycles; // of the WS2812 bit on MOSI so far
+  uint32_t low_cycles;
+} spi;
+
+static uint8_t* flash;            // FLASH_SIM_BASE on the host, or NULL
+
+// the length of each strip, as tpm_pixl.h lays them out
+static const uint32_t led_npixels[LED_STRIPS] = {
+  PIXL_STRIP0_PIXELS,
+#if PIXL_NUM_STRIPS > 1
+  PIXL_STRIP1_PIXELS,
+#endif
+};
+
+// a WS2812 strip
+typedef struct {
+  uint32_t bits;
+  uint32_t nbits;
+  uint32_t* colors;     // its part of led_colors
+  bool is_low;
+  uint64_t t_latch;
+} led_strip_t;
+
+static led_strip_t leds[LED_STRIPS];
+
+static uint32_t led_colors[NUM_PIXELS];   // of all strips, in frame order
+
+static void _sync_writes();
+static void _publish();
+static void _dma_service();
+
+static void _warn(const char* msg, int arg) {
+  if (warnings++ < MAX_WARNINGS) {
+    fprintf(stderr, "sim: %.6f s: ", (double)now/SIM_CORE_HZ);
+    fprintf(stderr, msg, arg);
+    fprintf(stderr, "\n");
+  }
+}
+
+static double _elapsed_sec(struct timespec* since, clockid_t clock) {
+  struct timespec ts;
+  clock_gettime(clock, &ts);
+  return (ts.tv_sec - since->tv_sec) + (ts.tv_nsec - since->tv_nsec)*1e-9;
+}
+
+// the target time the firmware spent since the last call into the simulator
+static uint64_t _cpu_charge() {
+  if (cfg->cpu_scale <= 0) return 0;
+  double sec = _elapsed_sec(&t_cpu_mark, CLOCK_THREAD_CPUTIME_ID);
+  return (uint64_t)(sec*cfg->cpu_scale*SIM_CORE_HZ);
+}
+
+static void _cpu_mark() {
+  if (cfg->cpu_scale > 0) {
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t_cpu_mark);
+  }
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ *    AUDIO INPUT
+ * -----------------------------------------------------------------------------
+ */
+
+// the capture order of analog_input: SE14, SE15, SE11, SE12
+static int _audio_channel(uint32_t adch) {
+  switch (adch) {
+    case 14: return 0;
+    case 15: return 1;
+    case 11: return 2;
+    case 12: return 3;
+    default: return -1;
+  }
+}
+
+static uint16_t _audio_sample(uint32_t adch) {
+
+  int ch = _audio_channel(adch);
+  if (ch < 0) return 0x8000;
+
+  uint64_t idx = now/SAMPLE_CYCLES;
+  while (!audio.is_valid || idx >= audio.first_idx + AIN_FRAME_SAMPLES) {
+    if (!src_is_avail(cfg->src) || src_get_frame(cfg->src, &audio.frame)) {
+      sim_finish("end of audio", false);
+    }
+    audio.first_idx = audio.is_valid ? audio.first_idx + AIN_FRAME_SAMPLES : 0;
+    audio.is_valid = true;
+  }
+  if (idx < audio.first_idx) idx = audio.first_idx;
+
+  return audio.frame.samples[(idx - audio.first_idx)*audio.frame.nchannels +
+                             ch % audio.frame.nchannels];
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ *    NVIC
+ * -----------------------------------------------------------------------------
+ */
+
+static void (*_handler(int irq))() {
+  switch (irq) {
+    case DMA0_IRQn: return DMA0_IRQHandler;
+    case DMA1_IRQn: return DMA1_IRQHandler;
+    case DMA2_IRQn: return DMA2_IRQHandler;
+    case DMA3_IRQn: return DMA3_IRQHandler;
+    case ADC0_IRQn: return ADC0_IRQHandler;
+    case TPM0_IRQn: return TPM0_IRQHandler;
+    case TPM1_IRQn: return TPM1_IRQHandler;
+    case TPM2_IRQn: return TPM2_IRQHandler;
+    case UART0_IRQn: return UART0_IRQHandler;
+    default: return NULL;
+  }
+}
+
+static void _pend(int irq) {
+  nvic.is_pending[irq] = true;
+}
+
+// the pending interrupt that would preempt the current priority, or -1
+static int _next_irq() {
+  int best = -1;
+  for (int irq=0; irq<NUM_IRQS; irq++) {
+    if (nvic.is_pending[irq] && nvic.is_enabled[irq] &&
+        nvic.priority[irq] < nvic.active_priority &&
+        (best < 0 || nvic.priority[irq] < nvic.priority[best])) {
+      best = irq;
+    }
+  }
+  return best;
+}
+
+// the handlers acknowledge their flag, see the top of this file
+static void _ack(int irq) {
+  if (irq <= DMA3_IRQn) {
+    sim_dma0.DMA[irq].DSR_BCR &= ~DSR_STATUS_MASK;
+  } else if (irq == ADC0_IRQn) {
+    adc.coco = false;
+  } else if (irq >= TPM0_IRQn && irq <= TPM2_IRQn) {
+    tpms[irq - TPM0_IRQn].tof = false;
+  } else if (irq == UART0_IRQn && uart.is_presented) {
+    uart.is_presented = false;
+    sim_uart0.S1 &= ~UART0_S1_RDRF_MASK;
+  }
+  _publish();
+}
+
+static void _dispatch() {
+
+  int irq;
+
+  while (!nvic.primask && (irq = _next_irq()) >= 0) {
+    void (*handler)() = _handler(irq);
+    if (handler == NULL) {
+      _warn("IRQ %d has no handler", irq);
+      sim_finish("unhandled interrupt", true);
+    }
+
+    uint32_t saved_priority = nvic.active_priority;
+    nvic.is_pending[irq] = false;
+    nvic.active_priority = nvic.priority[irq];
+    nvic.ntaken++;
+
+    _cpu_mark();
+    handler();
+    _sync_writes();
+    _ack(irq);
+
+    nvic.active_priority = saved_priority;
+  }
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ *    TPM
+ * -----------------------------------------------------------------------------
+ */
+
+static uint64_t _tpm_period(tpm_t* t) {
+  return (uint64_t)(t->mod + 1) << t->ps;
+}
+
+static uint32_t _tpm_count(tpm_t* t) {
+  if (!t->is_counting) return t->cnt;
+  return ((now - t->t_zero) >> t->ps) % (t->mod + 1);
+}
+
+// stop counting (before a configuration change)
+static void _tpm_freeze(tpm_t* t) {
+  t->cnt = _tpm_count(t);
+  t->is_counting = false;
+}
+
+// count on from t->cnt with the configuration in the registers
+static void _tpm_resume(tpm_t* t) {
+  t->ps = t->regs->SC & TPM_SC_PS_MASK;
+  t->mod = t->regs->MOD & TPM_MOD_MOD_MASK;
+  t->is_counting = (t->regs->SC & TPM_SC_CMOD_MASK) && is_tpm_clock_on;
+  if (t->cnt > t->mod) t->cnt = 0;
+  if (t->is_counting) {
+    t->t_zero = now - ((uint64_t)t->cnt << t->ps);
+    t->next_ovf = t->t_zero + _tpm_period(t);
+  }
+}
+
+static bool _tpm_is_dma_consumer(tpm_t* t) {
+  if (!(t->regs->SC & TPM_SC_DMA_MASK)) return false;
+  for (int ch=0; ch<DMA_CHANNELS; ch++) {
+    uint8_t mux = sim_dmamux0.CHCFG[ch];
+    if ((mux & DMAMUX_CHCFG_ENBL_MASK) &&
+        (mux & DMAMUX_CHCFG_SOURCE_MASK) == DMA_SRC_TPM0_OVF + t->idx &&
+        (sim_dma0.DMA[ch].DCR & DMA_DCR_ERQ_MASK) &&
+        (sim_dma0.DMA[ch].DSR_BCR & DMA_DSR_BCR_BCR_MASK)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool _tpm_is_adc_trigger(tpm_t* t) {
+  return (sim_sim.SOPT7 & SIM_SOPT7_ADC0ALTTRGEN_MASK) &&
+         (sim_sim.SOPT7 & SIM_SOPT7_ADC0TRGSEL_MASK) ==
+             ADC_TRGSEL_TPM0 + t->idx &&
+         (sim_adc0.SC2 & ADC_SC2_ADTRG_MASK);
+}
+
+// whether each overflow has to be processed, otherwise they are skipped
+static bool _tpm_is_observed(tpm_t* t) {
+  return t->is_counting &&
+         ((t->regs->SC & TPM_SC_TOIE_MASK) ||
+          _tpm_is_adc_trigger(t) ||
+          _tpm_is_dma_consumer(t) ||
+          (t->idx == 1 && (t->duty[0] || t->regs->CONTROLS[0].CnV ||
+                           t->duty[1] || t->regs->CONTROLS[1].CnV)));
+}
+
+// skip over overflows that have no effect besides setting TOF
+static void _tpm_catch_up(tpm_t* t) {
+  if (t->is_counting && t->next_ovf <= now && !_tpm_is_observed(t)) {
+    uint64_t n = (now - t->next_ovf)/_tpm_period(t) + 1;
+    t->next_ovf += n*_tpm_period(t);
+    t->tof = true;
+    t->duty[0] = t->regs->CONTROLS[0].CnV;
+    t->duty[1] = t->regs->CONTROLS[1].CnV;
+  }
+}
+
+static void _led_period(int strip, uint32_t high_cycles,
+                        uint32_t period_cycles);
+static void _adc_start(bool is_hw_trigger);
+
+static void _tpm_overflow(tpm_t* t) {
+
+  t->next_ovf += _tpm_period(t);
+  t->tof = true;
+
+  // edge-aligned PWM: the channel value written since the last overflow
+  // takes effect for the period starting now
+  t->duty[0] = t->regs->CONTROLS[0].CnV & TPM_CnV_VAL_MASK;
+  t->duty[1] = t->regs->CONTROLS[1].CnV & TPM_CnV_VAL_MASK;
+  if (t->idx == 1) {
+    for (int i=0; i<LED_STRIPS; i++) {
+      _led_period(i, t->duty[i] << t->ps, _tpm_period(t));
+    }
+  }
+
+  if (t->regs->SC & TPM_SC_TOIE_MASK) {
+    _pend(TPM0_IRQn + t->idx);
+  }
+  if (_tpm_is_adc_trigger(t)) {
+    _adc_start(true);
+  }
+}
+
+static void _tpm_writes(tpm_t* t) {
+
+  TPM_Type* r = t->regs;
+  TPM_Type* s = &t->shadow;
+
+  if (r->SC != s->SC) {
+    if (r->SC & TPM_SC_TOF_MASK) {
+      t->tof = false;
+    }
+    if ((r->SC ^ s->SC) & (TPM_SC_CMOD_MASK | TPM_SC_PS_MASK)) {
+      _tpm_freeze(t);
+      _tpm_resume(t);
+    }
+  }
+  // any write clears the counter
+  if (r->CNT != s->CNT) {
+    _tpm_freeze(t);
+    t->cnt = 0;
+    _tpm_resume(t);
+  }
+  if (r->MOD != s->MOD) {
+    _tpm_freeze(t);
+    _tpm_resume(t);
+  }
+}
+
+static void _tpm_publish(tpm_t* t) {
+  t->regs->CNT = _tpm_count(t);
+  t->regs->SC = (t->regs->SC & ~TPM_SC_TOF_MASK) |
+                (t->tof ? TPM_SC_TOF_MASK : 0);
+  memcpy(&t->shadow, t->regs, sizeof(TPM_Type));
+}
+
+static void _tpm_set_clock(bool is_on) {
+  is_tpm_clock_on = is_on;
+  for (int i=0; i<3; i++) {
+    _tpm_freeze(&tpms[i]);
+    _tpm_resume(&tpms[i]);
+  }
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ *    ADC
+ * -----------------------------------------------------------------------------
+ */
+
+static uint64_t _adc_conv_cycles() {
+
+  uint32_t cfg1 = sim_adc0.CFG1;
+  uint32_t hz;
+  switch (cfg1 & ADC_CFG1_ADICLK_MASK) {
+    case 0: hz = BUS_HZ; break;
+    case 1: hz = BUS_HZ/2; break;
+    case 2: hz = ALTCLK_HZ; break;
+    default: hz = (cfg1 & ADC_CFG1_ADLPC_MASK) ? ADACK_LP_HZ : ADACK_HZ; break;
+  }
+  hz >>= (cfg1 & ADC_CFG1_ADIV_MASK) >> ADC_CFG1_ADIV_SHIFT;
+
+  // base conversion time plus the long sample adder, per averaged sample
+  uint32_t mode = (cfg1 & ADC_CFG1_MODE_MASK) >> ADC_CFG1_MODE_SHIFT;
+  uint32_t adck = (mode == 3) ? 25 : (mode == 0) ? 17 : 20;
+  if (cfg1 & ADC_CFG1_ADLSMP_MASK) adck += 20;
+  if ((sim_adc0.SC3 & ADC_SC3_AVGE_MASK) || adc.is_cal) {
+    adck *= 4 << (sim_adc0.SC3 & ADC_SC3_AVGS_MASK);
+  }
+
+  // plus the single or first conversion adder of 3 ADCK + 5 bus cycles
+  return (uint64_t)(adck + 3)*SIM_CORE_HZ/hz + 5*(SIM_CORE_HZ/BUS_HZ);
+}
+
+static void _adc_start(bool is_hw_trigger) {
+
+  uint32_t adch = sim_adc0.SC1[0] & ADC_SC1_ADCH_MASK;
+
+  if (adc.is_converting) {
+    if (is_hw_trigger) {
+      stats.adc_ignored++;
+    }
+    return;
+  }
+  if (adch == ADC_CH_DISABLED) return;
+
+  adc.is_converting = true;
+  adc.sample = _audio_sample(adch);
+  adc.t_done = now + _adc_conv_cycles();
+}
+
+static bool _adc_compare(uint32_t result) {
+  uint32_t sc2 = sim_adc0.SC2;
+  uint32_t cv1 = sim_adc0.CV1;
+  uint32_t cv2 = sim_adc0.CV2;
+  bool is_gt = sc2 & ADC_SC2_ACFGT_MASK;
+
+  if (!(sc2 & ADC_SC2_ACREN_MASK)) {
+    return is_gt ? result >= cv1 : result < cv1;
+  }
+  if (is_gt) {
+    return cv1 <= cv2 ? (result >= cv1 && result <= cv2)
+                      : (result >= cv1 || result <= cv2);
+  }
+  return cv1 <= cv2 ? (result < cv1 || result > cv2)
+                    : (result < cv1 && result > cv2);
+}
+
+static void _adc_complete() {
+
+  static const int shift[4] = { 8, 4, 6, 0 }; // 8, 12, 10, 16-bit
+
+  adc.is_converting = false;
+
+  if (adc.is_cal) {
+    adc.is_cal = false;
+    adc.coco = true;
+    sim_adc0.SC3 &= ~ADC_SC3_CAL_MASK;
+    return;
+  }
+
+  uint32_t mode = (sim_adc0.CFG1 & ADC_CFG1_MODE_MASK) >> ADC_CFG1_MODE_SHIFT;
+  uint32_t result = adc.sample >> shift[mode];
+
+  if (!(sim_adc0.SC2 & ADC_SC2_ACFE_MASK) || _adc_compare(result)) {
+    // only a lost sample if the DMA was meant to pick the result up
+    if (adc.coco && (sim_adc0.SC2 & ADC_SC2_DMAEN_MASK)) {
+      stats.adc_overruns++;
+      if (stats.adc_overruns == 1) {
+        _warn("ADC0 result overwritten before it was read", 0);
+      }
+    }
+    adc.result = result;
+    adc.coco = true;
+    if (sim_adc0.SC1[0] & ADC_SC1_AIEN_MASK) {
+      _pend(ADC0_IRQn);
+    }
+  }
+
+  // continuous conversions in software trigger mode
+  if ((sim_adc0.SC3 & ADC_SC3_ADCO_MASK) &&
+      !(sim_adc0.SC2 & ADC_SC2_ADTRG_MASK)) {
+    _adc_start(false);
+  }
+}
+
+static void _adc_writes() {
+
+  ADC_Type* r = &sim_adc0;
+  ADC_Type* s = &adc_shadow;
+
+  // calibration aborts any conversion
+  if ((r->SC3 & ADC_SC3_CAL_MASK) && !(s->SC3 & ADC_SC3_CAL_MASK)) {
+    adc.is_cal = true;
+    adc.is_converting = true;
+    adc.coco = false;
+    adc.t_done = now + _adc_conv_cycles();
+  }
+
+  // writing SC1A aborts the conversion and, with a software trigger, starts
+  // a new one
+  if (r->SC1[0] != s->SC1[0] && !adc.is_cal) {
+    adc.is_converting = false;
+    adc.coco = false;
+    if (!(r->SC2 & ADC_SC2_ADTRG_MASK)) {
+      _adc_start(false);
+    }
+  }
+}
+
+static void _adc_publish() {
+  sim_adc0.SC1[0] = (sim_adc0.SC1[0] & ~ADC_SC1_COCO_MASK) |
+                    (adc.coco ? ADC_SC1_COCO_MASK : 0);
+  sim_adc0.SC2 = (sim_adc0.SC2 & ~ADC_SC2_ADACT_MASK) |
+                 (adc.is_converting ? ADC_SC2_ADACT_MASK : 0);
+  *(volatile uint32_t*)&sim_adc0.R[0] = adc.result;
+  memcpy(&adc_shadow, &sim_adc0, sizeof(ADC_Type));
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ *    DMA
+ * -----------------------------------------------------------------------------
+ */
+
+static uint32_t _dma_size(uint32_t size_field) {
+  return size_field == 0 ? 4 : size_field == 1 ? 1 : 2;
+}
+
+// address increment within a circular buffer of 16 << (mod-1) bytes
+static uint32_t _dma_mod_add(uint32_t addr, uint32_t inc, uint32_t mod) {
+  if (mod == 0) return addr + inc;
+  uint32_t size = 16U << (mod-1);
+  return (addr & ~(size-1)) | ((addr + inc) & (size-1));
+}
+
+static bool _dma_is_active(int ch) {
+  return (dma_shadow.DMA[ch].DCR & DMA_DCR_ERQ_MASK) &&
+         (dma_shadow.DMA[ch].DSR_BCR & DMA_DSR_BCR_BCR_MASK) &&
+         (sim_dmamux0.CHCFG[ch] & DMAMUX_CHCFG_ENBL_MASK);
+}
+
+static bool _is_within(uint32_t addr, void* base, size_t size) {
+  return addr >= (uintptr_t)base && addr < (uintptr_t)base + size;
+}
+
+static void _dma_link(int ch);
+static void _uart_tx(uint8_t data);
+static bool _uart_is_dma_requesting();
+static void _uart_publish();
+static void _spi_tx(uint8_t data);
+static bool _spi_is_dma_requesting();
+static void _spi_publish();
+
+static void _dma_transfer(int ch, int request_src) {
+
+  uint32_t dcr = sim_dma0.DMA[ch].DCR;
+  uint32_t bcr = sim_dma0.DMA[ch].DSR_BCR & DMA_DSR_BCR_BCR_MASK;
+  uint32_t sar = sim_dma0.DMA[ch].SAR;
+  uint32_t dar = sim_dma0.DMA[ch].DAR;
+  uint32_t ssize = _dma_size((dcr & DMA_DCR_SSIZE_MASK) >> DMA_DCR_SSIZE_SHIFT);
+  uint32_t dsize = _dma_size((dcr & DMA_DCR_DSIZE_MASK) >> DMA_DCR_DSIZE_SHIFT);
+  uint8_t data[4];
+
+  if (bcr == 0 || ssize != dsize || sar == 0 || dar == 0) {
+    stats.dma_errors++;
+    _warn("DMA%d transfer with a bad configuration", ch);
+    sim_dma0.DMA[ch].DSR_BCR |= DMA_DSR_BCR_CE_MASK;
+    return;
+  }
+
+  // the addresses are host addresses (the build does not use PIE)
+  memcpy(data, (void*)(uintptr_t)sar, ssize);
+  memcpy((void*)(uintptr_t)dar, data, dsize);
+
+  // the DMA acknowledge clears the requesting flag
+  if (request_src == DMA_SRC_ADC0 ||
+      _is_within(sar, (void*)&sim_adc0.R[0], sizeof(sim_adc0.R[0]))) {
+    adc.coco = false;
+  } else if (request_src >= DMA_SRC_TPM0_OVF &&
+             request_src < DMA_SRC_TPM0_OVF + 3) {
+    tpms[request_src - DMA_SRC_TPM0_OVF].tof = false;
+  }
+
+  if (dcr & DMA_DCR_SINC_MASK) {
+    sar = _dma_mod_add(sar, ssize, (dcr & DMA_DCR_SMOD_MASK) >>
+                                   DMA_DCR_SMOD_SHIFT);
+  }
+  if (dcr & DMA_DCR_DINC_MASK) {
+    dar = _dma_mod_add(dar, dsize, (dcr & DMA_DCR_DMOD_MASK) >>
+                                   DMA_DCR_DMOD_SHIFT);
+  }
+  bcr = bcr > dsize ? bcr - dsize : 0;
+
+  sim_dma0.DMA[ch].SAR = sar;
+  sim_dma0.DMA[ch].DAR = dar;
+  sim_dma0.DMA[ch].DSR_BCR = (sim_dma0.DMA[ch].DSR_BCR & DSR_STATUS_MASK) |
+                             bcr;
+  if (bcr == 0) {
+    sim_dma0.DMA[ch].DSR_BCR |= DMA_DSR_BCR_DONE_MASK;
+    if (dcr & DMA_DCR_D_REQ_MASK) {
+      sim_dma0.DMA[ch].DCR &= ~DMA_DCR_ERQ_MASK;
+    }
+    if (dcr & DMA_DCR_EINT_MASK) {
+      _pend(DMA0_IRQn + ch);
+    }
+    if (ch == 0) {
+      stats.adc_frames++;
+    }
+  }
+  memcpy(&dma_shadow.DMA[ch], &sim_dma0.DMA[ch], sizeof(sim_dma0.DMA[ch]));
+
+  // a write into a peripheral has the same effect as one from the core
+  if (_is_within(dar, &sim_adc0, sizeof(sim_adc0))) {
+    _adc_writes();
+    _adc_publish();
+  }
+  if (_is_within(dar, (void*)&sim_uart0.D, sizeof(sim_uart0.D))) {
+    _uart_tx(data[0]);
+    _uart_publish();
+  }
+  if (_is_within(dar, (void*)&sim_spi0.D, sizeof(sim_spi0.D))) {
+    _spi_tx(data[0]);
+    _spi_publish();
+  }
+
+  // channel linking
+  uint32_t linkcc = (dcr & DMA_DCR_LINKCC_MASK) >> DMA_DCR_LINKCC_SHIFT;
+  uint32_t lch1 = (dcr & DMA_DCR_LCH1_MASK) >> DMA_DCR_LCH1_SHIFT;
+  uint32_t lch2 = (dcr & DMA_DCR_LCH2_MASK) >> DMA_DCR_LCH2_SHIFT;
+  if (linkcc == 1 || linkcc == 2) {
+    _dma_link(lch1);
+  }
+  if ((linkcc == 1 && bcr == 0)) {
+    _dma_link(lch2);
+  } else if (linkcc == 3 && bcr == 0) {
+    _dma_link(lch1);
+  }
+}
+
+// a channel link (or the START bit) runs one cycle-steal transfer
+static void _dma_link(int ch) {
+  _dma_transfer(ch, -1);
+}
+
+static bool _dma_is_requesting(int ch) {
+
+  uint8_t mux = sim_dmamux0.CHCFG[ch];
+  uint32_t src = mux & DMAMUX_CHCFG_SOURCE_MASK;
+
+  if (!(mux & DMAMUX_CHCFG_ENBL_MASK) ||
+      !(sim_dma0.DMA[ch].DCR & DMA_DCR_ERQ_MASK) ||
+      !(sim_dma0.DMA[ch].DSR_BCR & DMA_DSR_BCR_BCR_MASK)) {
+    return false;
+  }
+  if (src == DMA_SRC_ADC0) {
+    return adc.coco && (sim_adc0.SC2 & ADC_SC2_DMAEN_MASK);
+  }
+  if (src >= DMA_SRC_TPM0_OVF && src < DMA_SRC_TPM0_OVF + 3) {
+    tpm_t* t = &tpms[src - DMA_SRC_TPM0_OVF];
+    return t->tof && (t->regs->SC & TPM_SC_DMA_MASK);
+  }
+  if (src == DMA_SRC_UART0_TX) {
+    return _uart_is_dma_requesting();
+  }
+  if (src == DMA_SRC_SPI0_TX) {
+    return _spi_is_dma_requesting();
+  }
+  return false;
+}
+
+// serve the requests in channel priority order (channel 0 first)
+static void _dma_service() {
+
+  bool is_served = true;
+
+  // the DMA is not clocked in VLPS
+  if (is_stopped) return;
+
+  while (is_served) {
+    is_served = false;
+    for (int ch=0; ch<DMA_CHANNELS; ch++) {
+      if (_dma_is_requesting(ch)) {
+        _dma_transfer(ch, sim_dmamux0.CHCFG[ch] & DMAMUX_CHCFG_SOURCE_MASK);
+        is_served = true;
+        break;
+      }
+    }
+  }
+}
+
+static void _dma_writes() {
+
+  for (int ch=0; ch<DMA_CHANNELS; ch++) {
+
+    uint32_t dsr_bcr = sim_dma0.DMA[ch].DSR_BCR;
+    uint32_t old = dma_shadow.DMA[ch].DSR_BCR;
+
+    if ((sim_dma0.DMA[ch].SAR != dma_shadow.DMA[ch].SAR ||
+         sim_dma0.DMA[ch].DAR != dma_shadow.DMA[ch].DAR ||
+         (dsr_bcr & DMA_DSR_BCR_BCR_MASK) != (old & DMA_DSR_BCR_BCR_MASK)) &&
+        _dma_is_active(ch)) {
+      stats.dma_busy_writes++;
+      _warn("DMA%d reprogrammed while a transfer is in progress", ch);
+    }
+
+    if (dsr_bcr != old) {
+      // writing DONE clears all status bits, the rest is the byte count
+      uint32_t status = (dsr_bcr & DMA_DSR_BCR_DONE_MASK) ? 0 :
+                        (old & DSR_STATUS_MASK);
+      sim_dma0.DMA[ch].DSR_BCR = status | (dsr_bcr & DMA_DSR_BCR_BCR_MASK);
+    }
+
+    if (sim_dma0.DMA[ch].DCR & DMA_DCR_START_MASK) {
+      sim_dma0.DMA[ch].DCR &= ~DMA_DCR_START_MASK;
+      memcpy(&dma_shadow.DMA[ch], &sim_dma0.DMA[ch],
+             sizeof(sim_dma0.DMA[ch]));
+      _dma_link(ch);
+    }
+  }
+  memcpy(&dma_shadow, &sim_dma0, sizeof(DMA_Type));
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ *    UART0
+ * -----------------------------------------------------------------------------
+ */
+
+static uint64_t _uart_frame_cycles() {
+  // UART0 runs from the 48 MHz PLLFLLSEL clock, the same as the core
+  uint32_t sbr = ((sim_uart0.BDH & UART0_BDH_SBR_MASK) << 8) | sim_uart0.BDL;
+  uint32_t osr = (sim_uart0.C4 & UART0_C4_OSR_MASK) >> UART0_C4_OSR_SHIFT;
+  return (uint64_t)UART_FRAME_BITS*(osr+1)*(sbr ? sbr : 1);
+}
+
+static void _uart_shift(uint8_t data) {
+  if (cfg->uart_out != NULL) {
+    fputc(data, cfg->uart_out);
+  }
+  stats.uart_tx_bytes++;
+  uart.t_shifted = now + _uart_frame_cycles();
+}
+
+// a byte written to D by DMA or the core
+static void _uart_tx(uint8_t data) {
+
+  // D reads back the receive buffer
+  sim_uart0.D = uart.rx_data;
+
+  if (!(sim_uart0.C2 & UART0_C2_TE_MASK) || uart.is_tx_full) {
+    stats.uart_tx_lost++;
+    _warn("UART0 byte written with the transmitter off or full", 0);
+    return;
+  }
+  if (uart.t_shifted == NEVER) {
+    _uart_shift(data);
+  } else {
+    uart.tx_data = data;
+    uart.is_tx_full = true;
+  }
+}
+
+// the shifter finished a frame
+static void _uart_shifted() {
+  uart.t_shifted = NEVER;
+  if (uart.is_tx_full) {
+    uart.is_tx_full = false;
+    _uart_shift(uart.tx_data);
+  }
+}
+
+static bool _uart_is_dma_requesting() {
+  return !uart.is_tx_full && (sim_uart0.C5 & UART0_C5_TDMAE_MASK) &&
+         (sim_uart0.C2 & UART0_C2_TIE_MASK) &&
+         (sim_uart0.C2 & UART0_C2_TE_MASK);
+}
+
+// the next key can arrive: it is not taken while a handler runs, so the one
+// that reads it is entered after it arrived
+static bool _uart_can_receive() {
+  return !uart.is_presented && uart.next_key < cfg->nkeys &&
+         (sim_uart0.C2 & UART0_C2_RE_MASK) &&
+         (sim_uart0.C2 & UART0_C2_RIE_MASK) &&
+         nvic.active_priority == THREAD_PRIORITY;
+}
+
+static void _uart_receive() {
+  uart.rx_data = cfg->keys[uart.next_key++].key;
+  sim_uart0.D = uart.rx_data;
+  sim_uart0.S1 |= UART0_S1_RDRF_MASK;
+  uart.is_presented = true;
+}
+
+static void _uart_publish() {
+  sim_uart0.S1 = (sim_uart0.S1 & ~(UART0_S1_TDRE_MASK | UART0_S1_TC_MASK)) |
+                 (uart.is_tx_full ? 0 : UART0_S1_TDRE_MASK) |
+                 (uart.t_shifted == NEVER ? UART0_S1_TC_MASK : 0);
+
+  if ((sim_uart0.S1 & UART0_S1_RDRF_MASK) &&
+      (sim_uart0.C2 & UART0_C2_RIE_MASK)) {
+    _pend(UART0_IRQn);
+  }
+  // TDRE interrupts when it does not request DMA instead
+  if (!uart.is_tx_full && (sim_uart0.C2 & UART0_C2_TIE_MASK) &&
+      (sim_uart0.C2 & UART0_C2_TE_MASK) &&
+      !(sim_uart0.C5 & UART0_C5_TDMAE_MASK)) {
+    _pend(UART0_IRQn);
+  }
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ *    SPI0
+ * -----------------------------------------------------------------------------
+ */
+
+// a MOSI bit, SPI0 runs from the bus clock
+static uint32_t _spi_bit_cycles() {
+  uint32_t sppr = (sim_spi0.BR & SPI_BR_SPPR_MASK) >> SPI_BR_SPPR_SHIFT;
+  uint32_t spr = (sim_spi0.BR & SPI_BR_SPR_MASK) >> SPI_BR_SPR_SHIFT;
+  return ((sppr + 1) << (spr + 1))*(SIM_CORE_HZ/BUS_HZ);
+}
+
+// the WS2812 bit on MOSI so far is over
+static void _spi_led_bit() {
+  if (spi.high_cycles) {
+    _led_period(0, spi.high_cycles, spi.high_cycles + spi.low_cycles);
+  }
+  spi.high_cycles = 0;
+  spi.low_cycles = 0;
+}
+
+// MOSI has been low since t_low for longer than any bit: the line is idle
+// and the strip latches 50 us after it went low
+static void _spi_led_idle(uint64_t t_low) {
+  _spi_led_bit();
+  _led_period(0, 0, 0);
+  leds[0].t_latch = t_low + LED_RESET_CYCLES;
+}
+
+// MOSI drives the strip of the SPI backend: a WS2812 bit is a run of high
+// MOSI bits and the low ones after it, up to the next rising edge
+static void _spi_shift(uint8_t data) {
+
+  uint32_t bit_cycles = _spi_bit_cycles();
+  uint64_t t = now;
+
+  for (int i=7; i>=0; i--, t+=bit_cycles) {
+    if (data & (1U << i)) {
+      if (spi.low_cycles) _spi_led_bit();
+      spi.high_cycles += bit_cycles;
+    } else if (spi.high_cycles) {
+      spi.low_cycles += bit_cycles;
+      if (spi.low_cycles >= LED_IDLE_CYCLES) {
+        _spi_led_idle(t + bit_cycles - spi.low_cycles);
+      }
+    }
+  }
+  spi.t_shifted = t;
+}
+
+// a byte written to D by DMA
+static void _spi_tx(uint8_t data) {
+
+  if (!(sim_spi0.C1 & SPI_C1_SPE_MASK) || !(sim_spi0.C1 & SPI_C1_MSTR_MASK) ||
+      spi.is_tx_full) {
+    _warn("SPI0 byte written with the master off or the buffer full", 0);
+    return;
+  }
+  if (spi.t_shifted == NEVER) {
+    _spi_shift(data);
+  } else {
+    spi.tx_data = data;
+    spi.is_tx_full = true;
+  }
+}
+
+// the shifter finished a byte: the next goes straight on, or MOSI holds
+// the last bit, which the firmware always leaves low
+static void _spi_shifted() {
+  spi.t_shifted = NEVER;
+  if (spi.is_tx_full) {
+    spi.is_tx_full = false;
+    _spi_shift(spi.tx_data);
+  } else if (spi.high_cycles) {
+    _spi_led_idle(now - spi.low_cycles);
+  }
+}
+
+static bool _spi_is_dma_requesting() {
+  return !spi.is_tx_full && (sim_spi0.C2 & SPI_C2_TXDMAE_MASK) &&
+         (sim_spi0.C1 & SPI_C1_SPE_MASK);
+}
+
+static void _spi_publish() {
+  sim_spi0.S = spi.is_tx_full ? 0 : SPI_S_SPTEF_MASK;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ *    LED STRIP
+ * -----------------------------------------------------------------------------
+ */
+
+// the WS2812 strips on TPM1 channels 0 and 1, fed one PWM period at a time.
+// Pulses outside the widths the WS2812 tells apart reliably are counted as
+// bad bits
+static void _led_period(int strip, uint32_t high_cycles,
+                        uint32_t period_cycles) {
+
+  led_strip_t* led = &leds[strip];
+
+  if (high_cycles == 0) {
+    if (!led->is_low) {
+      led->is_low = true;
+      led->t_latch = now + LED_RESET_CYCLES;
+    }
+    return;
+  }
+
+  led->is_low = false;
+  led->t_latch = NEVER;
+
+  bool is_zero = high_cycles >= LED_T0H_MIN && high_cycles <= LED_T0H_MAX;
+  bool is_one = high_cycles >= LED_ONE_CYCLES;
+  if ((!is_zero && !is_one) || period_cycles < high_cycles + LED_TL_MIN) {
+    stats.led_bad_bits++;
+    _warn("LED bit high for %d cycles", (int)high_cycles);
+  }
+
+  // bits past the last pixel are passed on to nothing
+  if (led->nbits < led_npixels[strip]*24) {
+    led->bits = (led->bits << 1) | (high_cycles >= LED_ONE_CYCLES);
+    led->nbits++;
+    if (led->nbits % 24 == 0) {
+      uint32_t grb = led->bits & 0xFFFFFF;
+      led->colors[led->nbits/24 - 1] = ((grb & 0x00FF00) << 8) |
+                                       ((grb & 0xFF0000) >> 8) |
+                                       (grb & 0x0000FF);
+    }
+  }
+}
+
+// a strip latches its colors. A frame counts, and is printed with the
+// colors of all strips, once the last strip it was sent to has latched
+static void _led_latch(int strip) {
+
+  led_strip_t* led = &leds[strip];
+
+  led->t_latch = NEVER;
+  if (led->nbits == 0) return;
+
+  // the pixels past the last one sent keep their colors
+  bool is_whole = led->nbits % 24 == 0;
+  if (!is_whole) {
+    stats.led_bad_frames++;
+    _warn("LED strip latched after %d bits, not whole pixels", led->nbits);
+  }
+  led->nbits = 0;
+  for (int i=0; i<LED_STRIPS; i++) {
+    if (leds[i].nbits) return;
+  }
+
+  if (is_whole) {
+    stats.led_frames++;
+    if (cfg->is_printing_leds) {
+      fprintf(cfg->out, "led %9.6f", (double)now/SIM_CORE_HZ);
+      for (int i=0; i<NUM_PIXELS; i++) {
+        if (led_colors[i]) {
+          fprintf(cfg->out, " %06x", led_colors[i]);
+        } else {
+          fprintf(cfg->out, " ......");
+        }
+      }
+      fprintf(cfg->out, "\n");
+    }
+  }
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ *    VIRTUAL TIME
+ * -----------------------------------------------------------------------------
+ */
+
+// the button pulls its pin low while pressed, the pull-ups hold the others
+// high
+static void _button_publish() {
+  uint32_t pdir = 0xFFFFFFFFU;
+  for (uint32_t i=0; i<cfg->npresses; i++) {
+    if (now >= cfg->presses[i] && now < cfg->presses[i] + SIM_PRESS_CYCLES) {
+      pdir &= ~(1UL << SIM_BUTTON_PIN);
+    }
+  }
+  *(volatile uint32_t*)&sim_gpioa.PDIR = pdir;
+}
+
+static void _publish() {
+  _adc_publish();
+  _button_publish();
+  for (int i=0; i<3; i++) {
+    _tpm_catch_up(&tpms[i]);
+    _tpm_publish(&tpms[i]);
+  }
+  memcpy(&dma_shadow, &sim_dma0, sizeof(DMA_Type));
+  _uart_publish();
+  _spi_publish();
+  sim_mcg.S = (t_pll_lock <= now ? MCG_S_LOCK0_MASK | MCG_S_PLLST_MASK : 0) |
+              (mcg_mode == kMCG_ModePEE ? MCG_S_CLKST(3) :
+               mcg_mode == kMCG_ModePBE ? MCG_S_CLKST(2) : MCG_S_CLKST(0));
+}
+
+// apply the firmware's register writes since the last call
+static void _sync_writes() {
+  for (int i=0; i<3; i++) {
+    _tpm_catch_up(&tpms[i]);
+    _tpm_writes(&tpms[i]);
+  }
+  _adc_writes();
+  _dma_writes();
+  _dma_service();
+  _publish();
+}
+
+static uint64_t _next_event() {
+
+  uint64_t t = NEVER;
+
+  for (int i=0; i<3; i++) {
+    if (_tpm_is_observed(&tpms[i]) && tpms[i].next_ovf < t) {
+      t = tpms[i].next_ovf;
+    }
+  }
+  if (adc.is_converting && adc.t_done < t) t = adc.t_done;
+  if (t_pll_lock > now && t_pll_lock < t) t = t_pll_lock;
+  for (int i=0; i<LED_STRIPS; i++) {
+    if (leds[i].t_latch < t) t = leds[i].t_latch;
+  }
+  if (uart.t_shifted < t) t = uart.t_shifted;
+  if (spi.t_shifted < t) t = spi.t_shifted;
+  if (_uart_can_receive() && cfg->keys[uart.next_key].cycle < t) {
+    t = cfg->keys[uart.next_key].cycle;
+  }
+
+  return t;
+}
+
+// run the hardware up to the time until, taking interrupts on the way
+static void _advance(uint64_t until) {
+
+  while (1) {
+    if (cfg->max_cycles && now >= cfg->max_cycles) {
+      sim_finish("time limit", false);
+    }
+
+    uint64_t t = _next_event();
+    if (t > until) break;
+    if (t > now) now = t;
+
+    for (int i=0; i<3; i++) {
+      if (_tpm_is_observed(&tpms[i]) && tpms[i].next_ovf <= now) {
+        _tpm_overflow(&tpms[i]);
+      }
+    }
+    if (adc.is_converting && adc.t_done <= now) {
+      _adc_complete();
+    }
+    for (int i=0; i<LED_STRIPS; i++) {
+      if (leds[i].t_latch <= now) {
+        _led_latch(i);
+      }
+    }
+    if (uart.t_shifted <= now) {
+      _uart_shifted();
+    }
+    if (spi.t_shifted <= now) {
+      _spi_shifted();
+    }
+    if (_uart_can_receive() && cfg->keys[uart.next_key].cycle <= now) {
+      _uart_receive();
+    }
+    _dma_service();
+    _publish();
+    _dispatch();
+  }
+
+  if (until > now) now = until;
+}
+
+static bool _is_wakeup_pending() {
+  for (int irq=0; irq<NUM_IRQS; irq++) {
+    if (nvic.is_pending[irq] && nvic.is_enabled[irq]) return true;
+  }
+  return false;
+}
+
+// let time run until an interrupt is pending (the core is asleep)
+static void _sleep(uint64_t* asleep_cycles) {
+
+  uint64_t t_start = now;
+  uint32_t ntaken = nvic.ntaken;
+
+  while (!_is_wakeup_pending() && nvic.ntaken == ntaken) {
+    uint64_t t = _next_event();
+    if (t == NEVER) {
+      sim_finish("deadlock, the core sleeps with nothing left to wake it",
+                 true);
+    }
+    _advance(t);
+  }
+  *asleep_cycles += now - t_start;
+
+  // WFI wakes on the pending interrupt even when masked, which then waits
+  // only from here
+  nvic.t_masked = now;
+}
+
+// see MKL25Z4.h shim for more details
+void sim_access() {
+  _sync_writes();
+  _advance(now + ACCESS_CYCLES + _cpu_charge());
+  _dispatch();
+  _cpu_mark();
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ *    FLASH DRIVER STAND-INS
+ * -----------------------------------------------------------------------------
+ */
+
+static bool _flash_is_mapped(uint32_t start, uint32_t len) {
+  return flash != NULL && start >= FLASH_SIM_BASE &&
+         start + len <= FLASH_SIM_BASE + FLASH_SIM_SIZE && start + len > start;
+}
+
+// the core stalls while the command runs, interrupts stay pending
+static void _flash_command(uint64_t cycles) {
+  if (!nvic.primask) {
+    stats.flash_errors++;
+    _warn("flash command with interrupts enabled", 0);
+  }
+  stats.flash_cycles += cycles;
+  _advance(now + cycles);
+}
+
+status_t FLASH_Init(flash_config_t *config) {
+  sim_access();
+  if (flash == NULL) {
+    return kStatus_FLASH_AccessError;
+  }
+  config->PFlashBlockBase = 0;
+  config->PFlashTotalSize = FLASH_TOTAL_SIZE;
+  config->PFlashBlockCount = 1;
+  config->PFlashSectorSize = FLASH_SECTOR_SIZE;
+  return kStatus_FLASH_Success;
+}
+
+status_t FLASH_Erase(flash_config_t *config, uint32_t start,
+                     uint32_t lengthInBytes, uint32_t key) {
+  sim_access();
+  if (key != kFLASH_ApiEraseKey) {
+    return kStatus_FLASH_EraseKeyError;
+  }
+  if (start % FLASH_SECTOR_SIZE || lengthInBytes % FLASH_SECTOR_SIZE) {
+    return kStatus_FLASH_AlignmentError;
+  }
+  if (!_flash_is_mapped(start, lengthInBytes)) {
+    stats.flash_errors++;
+    _warn("flash erase at 0x%x outside the simulated region", start);
+    return kStatus_FLASH_ProtectionViolation;
+  }
+  for (uint32_t addr = start; addr < start + lengthInBytes;
+       addr += FLASH_SECTOR_SIZE) {
+    _flash_command(FLASH_ERASE_CYCLES);
+    memset(&flash[addr - FLASH_SIM_BASE], 0xFF, FLASH_SECTOR_SIZE);
+  }
+  _cpu_mark();
+  return kStatus_FLASH_Success;
+}
+
+status_t FLASH_Program(flash_config_t *config, uint32_t start, uint32_t *src,
+                       uint32_t lengthInBytes) {
+  sim_access();
+  if (src == NULL) {
+    return kStatus_FLASH_InvalidArgument;
+  }
+  if (start % 4 || lengthInBytes % 4) {
+    return kStatus_FLASH_AlignmentError;
+  }
+  if (!_flash_is_mapped(start, lengthInBytes)) {
+    stats.flash_errors++;
+    _warn("flash program at 0x%x outside the simulated region", start);
+    return kStatus_FLASH_ProtectionViolation;
+  }
+  for (uint32_t i = 0; i < lengthInBytes/4; i++) {
+    uint32_t* word = (uint32_t*)&flash[start + i*4 - FLASH_SIM_BASE];
+    _flash_command(FLASH_PROGRAM_CYCLES);
+    // programming only clears bits, a second program of a word is an error
+    if (*word != UINT32_MAX) {
+      stats.flash_errors++;
+      _warn("flash word at 0x%x programmed twice", start + i*4);
+    }
+    *word &= src[i];
+  }
+  _cpu_mark();
+  return kStatus_FLASH_Success;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ *    CORE, SMC, MCG AND BOARD STAND-INS
+ * -----------------------------------------------------------------------------
+ */
+
+// a strip is part way through the bits of a frame, not in its reset
+static bool _led_is_sending() {
+  for (int i=0; i<LED_STRIPS; i++) {
+    if (leds[i].nbits && !leds[i].is_low) return true;
+  }
+  return false;
+}
+
+static void _mask() {
+  if (!nvic.primask) {
+    nvic.t_masked = now;
+    nvic.is_masked_sending = _led_is_sending();
+  }
+  nvic.primask = 1;
+}
+
+// while a strip is mid-frame the LED interrupt has to restart DMA within
+// two bit periods, of which masking may take one (see tpm_pixl.h). Only
+// peripheral accesses take time unless the CPU time is charged (-x), so
+// that shows the longer sections
+static void _unmask() {
+  if (nvic.primask && (nvic.is_masked_sending || _led_is_sending())) {
+    _sync_writes();
+    _advance(now + _cpu_charge());
+    _cpu_mark();
+    uint64_t cycles = now - nvic.t_masked;
+    if (cycles > stats.led_masked_max) stats.led_masked_max = cycles;
+    if (cycles > LED_MASKED_CYCLES) {
+      stats.led_masked_long++;
+      _warn("interrupts masked for %d cycles while LED bits were sending",
+            (int)cycles);
+    }
+  }
+  nvic.primask = 0;
+}
+
+uint32_t __get_PRIMASK() {
+  return nvic.primask;
+}
+
+void __set_PRIMASK(uint32_t primask) {
+  if (primask & 1) {
+    _mask();
+  } else {
+    _unmask();
+  }
+  sim_access();
+}
+
+void __disable_irq() {
+  sim_access();
+  _mask();
+}
+
+void __enable_irq() {
+  _unmask();
+  sim_access();
+}
+
+void NVIC_EnableIRQ(IRQn_Type irq) {
+  sim_access();
+  nvic.is_enabled[irq] = true;
+  sim_access();
+}
+
+void NVIC_DisableIRQ(IRQn_Type irq) {
+  sim_access();
+  nvic.is_enabled[irq] = false;
+}
+
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority) {
+  sim_access();
+  nvic.priority[irq] = priority & 3;
+}
+
+void NVIC_ClearPendingIRQ(IRQn_Type irq) {
+  sim_access();
+  nvic.is_pending[irq] = false;
+}
+
+void NVIC_SetPendingIRQ(IRQn_Type irq) {
+  _pend(irq);
+  sim_access();
+}
+
+uint32_t __get_IPSR() {
+  // the exception number, only whether it is 0 (thread mode) matters
+  return nvic.active_priority == THREAD_PRIORITY ? 0 : 16;
+}
+
+void SMC_SetPowerModeProtection(SMC_Type *base, uint8_t allowedModes) {
+  base->PMPROT = allowedModes;
+}
+
+static uint32_t saved_primask;
+
+void SMC_PreEnterStopModes(void) {
+  sim_access();
+  saved_primask = nvic.primask;
+  _mask();
+}
+
+void SMC_PostExitStopModes(void) {
+  __set_PRIMASK(saved_primask);
+}
+
+status_t SMC_SetPowerModeWait(SMC_Type *base) {
+  _sync_writes();
+  _sleep(&stats.wait_cycles);
+  _cpu_mark();
+  return kStatus_Success;
+}
+
+status_t SMC_SetPowerModeVlps(SMC_Type *base) {
+
+  if (!(base->PMPROT & SMC_PMPROT_AVLP_MASK)) {
+    return kStatus_Fail;
+  }
+
+  // the PLL and with it the TPM and DMA clocks stop, ADACK keeps running
+  _sync_writes();
+  is_stopped = true;
+  _tpm_set_clock(false);
+  t_pll_lock = NEVER;
+  _publish();
+
+  _sleep(&stats.vlps_cycles);
+
+  // the MCG wakes up in PBE with the PLL relocking
+  is_stopped = false;
+  mcg_mode = kMCG_ModePBE;
+  t_pll_lock = now + PLL_LOCK_CYCLES;
+  _publish();
+  _cpu_mark();
+  return kStatus_Success;
+}
+
+uint32_t CLOCK_GetPllFllSelClkFreq(void) {
+  return SIM_CORE_HZ;
+}
+
+// the SDK driver's search for the OSR and SBR closest to the baud rate
+status_t LPSCI_SetBaudRate(UART0_Type *base, uint32_t baudRate_Bps,
+                           uint32_t srcClock_Hz) {
+  uint32_t best_osr = 0, best_sbr = 0, best_diff = baudRate_Bps;
+
+  for (uint32_t osr = 4; osr <= 32; osr++) {
+    uint32_t sbr = srcClock_Hz/(baudRate_Bps*osr);
+    if (sbr == 0) sbr = 1;
+    uint32_t diff = srcClock_Hz/(osr*sbr) - baudRate_Bps;
+    if (diff > baudRate_Bps - srcClock_Hz/(osr*(sbr+1))) {
+      diff = baudRate_Bps - srcClock_Hz/(osr*(sbr+1));
+      sbr++;
+    }
+    if (diff <= best_diff) {
+      best_diff = diff;
+      best_osr = osr;
+      best_sbr = sbr;
+    }
+  }
+  if (best_diff >= (baudRate_Bps/100)*3) {
+    return kStatus_LPSCI_BaudrateNotSupport;
+  }
+
+  uint8_t c2 = base->C2;
+  base->C2 &= ~(UART0_C2_TE_MASK | UART0_C2_RE_MASK);
+  if (best_osr < 8) {
+    base->C5 |= UART0_C5_BOTHEDGE_MASK;
+  }
+  base->C4 = (base->C4 & ~UART0_C4_OSR_MASK) | UART0_C4_OSR(best_osr-1);
+  base->BDH = (base->BDH & ~UART0_BDH_SBR_MASK) |
+              UART0_BDH_SBR(best_sbr >> 8);
+  base->BDL = UART0_BDL_SBR(best_sbr);
+  base->C2 = c2;
+  return kStatus_Success;
+}
+
+mcg_mode_t CLOCK_GetMode(void) {
+  sim_access();
+  return mcg_mode;
+}
+
+status_t CLOCK_SetPeeMode(void) {
+  sim_access();
+  if (t_pll_lock > now) {
+    return kStatus_Fail;
+  }
+  mcg_mode = kMCG_ModePEE;
+  _tpm_set_clock(true);
+  _publish();
+  return kStatus_Success;
+}
+
+void BOARD_InitBootPins(void) {
+}
+
+void BOARD_InitBootClocks(void) {
+  mcg_mode = kMCG_ModePEE;
+  t_pll_lock = 0;
+  _tpm_set_clock(true);
+  _publish();
+}
+
+void BOARD_InitBootPeripherals(void) {
+}
+
+void LPSCI_WriteByte(UART0_Type *base, uint8_t data) {
+  // seen even when the byte equals the last one, unlike a store to D
+  _sync_writes();
+  _uart_tx(data);
+  _publish();
+}
+
+void BOARD_InitDebugConsole(void) {
+  // printf reaches UART0 only through the firmware's console, if it has one
+  LPSCI_SetBaudRate(&sim_uart0, 115200, SIM_CORE_HZ);
+  sim_uart0.C2 |= UART0_C2_TE_MASK | UART0_C2_RE_MASK;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+// see .h for more details
+void sim_init(const sim_config_t* config) {
+
+  // the firmware stores pointers to its buffers in 32-bit DMA registers
+  if ((uintptr_t)&sim_adc0 > UINT32_MAX || (uintptr_t)&now > UINT32_MAX) {
+    fprintf(stderr, "sim: static data above 4 GB, link with -no-pie\n");
+    exit(2);
+  }
+
+  cfg = config;
+  memset(&stats, 0, sizeof(stats));
+  now = 0;
+  warnings = 0;
+  clock_gettime(CLOCK_MONOTONIC, &t_host_start);
+  _cpu_mark();
+
+  // reset values
+  memset(&sim_adc0, 0, sizeof(sim_adc0));
+  sim_adc0.SC1[0] = ADC_SC1_ADCH(ADC_CH_DISABLED);
+  sim_adc0.SC1[1] = ADC_SC1_ADCH(ADC_CH_DISABLED);
+  memset(&sim_dma0, 0, sizeof(sim_dma0));
+  memset(&sim_dmamux0, 0, sizeof(sim_dmamux0));
+  memset(&sim_sim, 0, sizeof(sim_sim));
+  memset(&sim_porta, 0, sizeof(sim_porta));
+  memset(&sim_portd, 0, sizeof(sim_portd));
+  memset(&sim_gpioa, 0, sizeof(sim_gpioa));
+  memset(&sim_spi0, 0, sizeof(sim_spi0));
+  memset(&spi, 0, sizeof(spi));
+  spi.t_shifted = NEVER;
+  memset(&sim_mcg, 0, sizeof(sim_mcg));
+  memset(&sim_smc, 0, sizeof(sim_smc));
+  memset(&adc, 0, sizeof(adc));
+  memset(&nvic, 0, sizeof(nvic));
+  memset(&audio, 0, sizeof(audio));
+  memset(&leds, 0, sizeof(leds));
+  memset(&led_colors, 0, sizeof(led_colors));
+  memset(&sim_uart0, 0, sizeof(sim_uart0));
+  sim_uart0.S1 = UART0_S1_TDRE_MASK | UART0_S1_TC_MASK;
+  memset(&uart, 0, sizeof(uart));
+  uart.t_shifted = NEVER;
+  nvic.active_priority = THREAD_PRIORITY;
+  uint32_t first = 0;
+  for (int i=0; i<LED_STRIPS; i++) {
+    leds[i].colors = &led_colors[first];
+    leds[i].is_low = true;
+    leds[i].t_latch = NEVER;
+    first += led_npixels[i];
+  }
+  is_stopped = false;
+  mcg_mode = kMCG_ModeFEI;
+  t_pll_lock = NEVER;
+
+  TPM_Type* regs[3] = { &sim_tpm0, &sim_tpm1, &sim_tpm2 };
+  for (int i=0; i<3; i++) {
+    memset(regs[i], 0, sizeof(TPM_Type));
+    regs[i]->MOD = TPM_MOD_MOD_MASK;
+    memset(&tpms[i], 0, sizeof(tpm_t));
+    tpms[i].regs = regs[i];
+    tpms[i].idx = i;
+  }
+  _tpm_set_clock(false);
+
+  // the firmware reads flash through pointers at its target addresses, an
+  // erased (all ones) part of flash is mapped there; FLASH_Init() fails
+  // if the address is taken on this host
+  if (flash == NULL) {
+    void* p = mmap((void*)(uintptr_t)FLASH_SIM_BASE, FLASH_SIM_SIZE,
+                   PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    flash = (p == (void*)(uintptr_t)FLASH_SIM_BASE) ? p : NULL;
+  }
+  if (flash != NULL) {
+    memset(flash, 0xFF, FLASH_SIM_SIZE);
+  }
+  _publish();
+}
+
+// see .h for more details
+void sim_finish(const char* reason, bool is_error) {
+
+  double sec = (double)now/SIM_CORE_HZ;
+  double host_sec = _elapsed_sec(&t_host_start, CLOCK_MONOTONIC);
+
+  stats.cycles = now;
+  fflush(stdout);
+
+  fprintf(stderr, "sim: %s after %.3f s (%.3f s on the host, %.1fx realtime)"
+          "\n", reason, sec, host_sec, host_sec > 0 ? sec/host_sec : 0.0);
+  fprintf(stderr, "sim: %u ADC frames (%.1f/s), %u LED frames (%.1f/s)\n",
+          stats.adc_frames, sec > 0 ? stats.adc_frames/sec : 0.0,
+          stats.led_frames, sec > 0 ? stats.led_frames/sec : 0.0);
+  fprintf(stderr, "sim: core asleep %.1f%% in WAIT, %.1f%% in VLPS\n",
+          now ? 100.0*stats.wait_cycles/now : 0.0,
+          now ? 100.0*stats.vlps_cycles/now : 0.0);
+  fprintf(stderr, "sim: core stalled %.1f%% on flash commands\n",
+          now ? 100.0*stats.flash_cycles/now : 0.0);
+  fprintf(stderr, "sim: UART0 sent %u bytes (%.0f/s)\n", stats.uart_tx_bytes,
+          sec > 0 ? stats.uart_tx_bytes/sec : 0.0);
+  fprintf(stderr, "sim: interrupts masked at most %.2f us while LED bits "
+          "were sending\n", (double)stats.led_masked_max*1e6/SIM_CORE_HZ);
+  fprintf(stderr, "sim: %u ADC overruns, %u ignored ADC triggers, "
+          "%u DMA busy writes, %u DMA errors, %u bad LED frames, "
+          "%u bad LED bits, %u long masked LED sections, %u flash errors, "
+          "%u lost UART0 bytes\n",
+          stats.adc_overruns, stats.adc_ignored, stats.dma_busy_writes,
+          stats.dma_errors, stats.led_bad_frames, stats.led_bad_bits,
+          stats.led_masked_long, stats.flash_errors, stats.uart_tx_lost);
+
+  if (cfg->is_strict &&
+      (is_error || stats.adc_overruns || stats.adc_ignored ||
+       stats.dma_busy_writes || stats.dma_errors || stats.led_bad_frames ||
+       stats.led_bad_bits || stats.led_masked_long ||
+       stats.flash_errors || stats.uart_tx_lost || stats.led_frames == 0)) {
+    exit(1);
+  }
+  exit(is_error ? 1 : 0);
+}
+
+// see .h for more details
+const sim_stats_t* sim_get_stats() {
+  stats.cycles = now;
+  return &stats;
+}
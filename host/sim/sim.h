@@ -0,0 +1,115 @@
+/* -----------------------------------------------------------------------------
+ * sim.h - Register-level simulation of the KL25Z peripherals used on target
+ *
+ * Simulates ADC0, DMA0 (channels 0-3), DMAMUX0, TPM0-2, the NVIC, the
+ * WAIT/VLPS power modes, the PLL lock, the program flash commands and
+ * UART0, so the firmware's main() runs on Linux. Time is a virtual 48 MHz
+ * core clock: it advances by a fixed cost on every peripheral access, jumps
+ * ahead while the core sleeps and can optionally be charged with the host
+ * CPU time spent between accesses, scaled to the target. The ADC inputs are
+ * fed from a sample_source_t and the TPM1 channel 0 output is decoded as a
+ * WS2812 bitstream, and so is channel 1 when the firmware is built for two
+ * strips (PIXL_NUM_STRIPS), or the SPI0 MOSI output when it is built for
+ * the SPI backend (PIXL_SPI). A push button on PTA5 (see button.h) can be
+ * pressed at given times.
+ *
+ * The firmware is expected to be built with the shim headers in host/sim
+ * ahead of CMSIS/ and linked without PIE, so the 32-bit DMA addresses it
+ * computes from pointers to static buffers are valid host addresses.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _SIM_H_
+#define _SIM_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "sample_source.h"
+
+#define SIM_CORE_HZ  (48000000UL)   // virtual core (and TPM source) clock
+#define SIM_BUTTON_PIN    (5)       // PTA5, the pin button.c reads
+#define SIM_PRESS_CYCLES  (SIM_CORE_HZ/10)   // a press holds it low 100 ms
+
+// a key typed on the debug console
+typedef struct {
+  uint64_t cycle;         // when it arrives
+  char key;
+} sim_key_t;
+
+// how the simulation is run
+typedef struct {
+  sample_source_t* src;   // audio on the ADC inputs, ends the run when empty
+  uint64_t max_cycles;    // end the run after this long, 0 for no limit
+  double cpu_scale;       // charge host CPU time x cpu_scale as virtual time,
+                          // 0 for a deterministic run (peripheral cost only)
+  bool is_printing_leds;  // print every latched LED frame
+  bool is_strict;         // exit with status 1 if any error was counted
+  const sim_key_t* keys;  // received on UART0, in order of arrival
+  uint32_t nkeys;
+  const uint64_t* presses;  // when the button is pressed, any order
+  uint32_t npresses;
+  FILE* uart_out;         // bytes transmitted on UART0, NULL to discard
+  FILE* out;              // where the LED frames are printed
+} sim_config_t;
+
+// what was observed during the run
+typedef struct {
+  uint64_t cycles;          // virtual time simulated
+  uint64_t wait_cycles;     // time spent in WAIT
+  uint64_t vlps_cycles;     // time spent in VLPS
+  uint32_t adc_frames;      // DMA0 transfers completed
+  uint32_t led_frames;      // LED frames latched by the strips
+  uint32_t adc_overruns;    // ADC results overwritten before DMA read them
+  uint32_t adc_ignored;     // hardware triggers while a conversion was busy
+  uint32_t dma_busy_writes; // SAR/DAR/BCR written while a channel was active
+  uint32_t dma_errors;      // transfers with a bad configuration
+  uint32_t led_bad_frames;  // latched frames that were not whole pixels
+  uint32_t led_bad_bits;    // pulses too short or long for a 0 or 1 bit
+  uint32_t led_masked_long; // interrupts masked over a bit period mid-frame
+  uint64_t led_masked_max;  // the longest such masked section, in cycles
+  uint64_t flash_cycles;    // core stalled on flash commands
+  uint32_t flash_errors;    // flash commands the hardware would not allow
+  uint32_t uart_tx_bytes;   // bytes transmitted on UART0
+  uint32_t uart_tx_lost;    // bytes written to UART0 that could not be sent
+} sim_stats_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+/*
+ * @brief   Puts the simulated hardware into its reset state
+ *
+ * @param   cfg, how to run the simulation, must outlive the run
+ * @return  none (exits if the host build cannot support the simulation)
+ */
+void sim_init(const sim_config_t* cfg);
+
+/*
+ * @brief   Ends the run: prints the statistics and exits the process
+ *
+ * Called by the simulator itself when the audio source is exhausted, the time
+ * limit is reached or the firmware can never wake up again.
+ *
+ * @param   reason, why the run ended
+ *          is_error, whether the run ended because of an error
+ * @return  does not return
+ */
+void sim_finish(const char* reason, bool is_error);
+
+/*
+ * @brief   Returns the statistics collected so far
+ *
+ * @param   none
+ * @return  const sim_stats_t*, the statistics
+ */
+const sim_stats_t* sim_get_stats();
+
+#endif // _SIM_H_
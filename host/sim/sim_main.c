@@ -0,0 +1,152 @@
+/* -----------------------------------------------------------------------------
+ * sim_main.c - Runs the unmodified firmware on the simulated hardware
+ *
+ * The firmware's main() is compiled as fw_main() (see the Makefile) and runs
+ * against the peripheral simulation in sim.c, with the audio source on the
+ * ADC inputs. The run ends when the audio runs out, the time limit is hit or
+ * the firmware deadlocks, and prints throughput and error statistics.
+ *
+ * The firmware's stdout is its debug console: printf() text goes through
+ * the console's ring buffer and out on the simulated UART0 at the baud rate
+ * set, so text written faster than that is dropped as it would be on
+ * target. What UART0 sends appears on stdout, unless -u sends it to a file.
+ *
+ *   usage: fw_sim [-t seconds] [-x cpu_scale] [-l] [-s] [-k sec:keys]
+ *                 [-b sec] [-u file] SOURCE
+ *     SOURCE  a 16-bit 48 kHz WAV file, or synth:F[,F...] for sine tones at
+ *             the given frequencies in Hz
+ *     -t      stop after this much virtual time (default none, synth: 10)
+ *     -x      charge host CPU time x cpu_scale as target time (default 0,
+ *             deterministic: only peripheral accesses take time)
+ *     -l      print every LED frame latched by the strip
+ *     -s      strict, exit with status 1 if any error was counted
+ *     -k      type keys on the debug console at this virtual time, e.g.
+ *             -k 0.5:r to start recording (repeatable)
+ *     -b      press the button on PTA5 at this virtual time, for 100 ms
+ *             (repeatable)
+ *     -u      write the bytes transmitted on UART0 (the console and the
+ *             stream) to file instead of stdout
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include "sample_source.h"
+#include "src_host.h"
+#include "sim.h"
+
+#define SYNTH_DEFAULT_SEC  (10)
+#define MAX_KEYS           (256)
+#define MAX_PRESSES        (16)
+
+// the firmware's main() and debug console (see log_console.h)
+int fw_main(void);
+int log_write(const char* data, uint32_t nbytes);
+
+// the firmware's stdout, one write per printf()
+static ssize_t _console_write(void* cookie, const char* data, size_t size) {
+  log_write(data, size);
+  return size;
+}
+
+static void _usage() {
+  fprintf(stderr, "usage: fw_sim [-t seconds] [-x cpu_scale] [-l] [-s] "
+          "[-k sec:keys] [-b sec] [-u file] (FILE.wav | synth:F[,F...])\n");
+  exit(2);
+}
+
+// adds the keys of a sec:keys option, returns 0 on success or -1
+static int _parse_keys(const char* spec, sim_key_t* keys, uint32_t* nkeys) {
+  char* end;
+  double sec = strtod(spec, &end);
+  if (end == spec || *end != ':' || sec < 0) return -1;
+  for (const char* p = end+1; *p; p++) {
+    if (*nkeys == MAX_KEYS) return -1;
+    // keep the keys in order of arrival
+    if (*nkeys && keys[*nkeys-1].cycle > (uint64_t)(sec*SIM_CORE_HZ)) {
+      return -1;
+    }
+    keys[*nkeys].cycle = (uint64_t)(sec*SIM_CORE_HZ);
+    keys[*nkeys].key = *p;
+    (*nkeys)++;
+  }
+  return 0;
+}
+
+int main(int argc, char** argv) {
+
+  static sample_source_t src;
+  static src_host_ctx_t ctx;
+  static sim_config_t cfg;
+  static sim_key_t keys[MAX_KEYS];
+  static uint64_t presses[MAX_PRESSES];
+  double max_sec = 0;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "t:x:lsk:b:u:")) != -1) {
+    switch (opt) {
+      case 't': max_sec = atof(optarg); break;
+      case 'x': cfg.cpu_scale = atof(optarg); break;
+      case 'l': cfg.is_printing_leds = true; break;
+      case 's': cfg.is_strict = true; break;
+      case 'u':
+        cfg.uart_out = fopen(optarg, "wb");
+        if (cfg.uart_out == NULL) {
+          perror(optarg);
+          return 1;
+        }
+        break;
+      case 'k':
+        if (_parse_keys(optarg, keys, &cfg.nkeys)) _usage();
+        break;
+      case 'b':
+        if (cfg.npresses == MAX_PRESSES || atof(optarg) < 0) _usage();
+        presses[cfg.npresses++] = (uint64_t)(atof(optarg)*SIM_CORE_HZ);
+        break;
+      default: _usage();
+    }
+  }
+  if (optind != argc-1 || max_sec < 0 || cfg.cpu_scale < 0) {
+    _usage();
+  }
+
+  const char* spec = argv[optind];
+  if (max_sec == 0 && !strncmp(spec, "synth:", 6)) {
+    max_sec = SYNTH_DEFAULT_SEC;
+  }
+  if (src_host_open(&src, &ctx, spec, AIN_NUM_CHANNELS, 0)) {
+    return 1;
+  }
+
+  // keep the host's stdout for the simulator, give the firmware its own
+  cfg.out = fdopen(dup(STDOUT_FILENO), "w");
+  if (cfg.out == NULL) {
+    perror("stdout");
+    return 1;
+  }
+  setvbuf(cfg.out, NULL, _IOLBF, 0);
+  if (cfg.uart_out == NULL) cfg.uart_out = cfg.out;
+  cookie_io_functions_t console = { .write = _console_write };
+  stdout = fopencookie(NULL, "w", console);
+  setvbuf(stdout, NULL, _IONBF, 0);
+
+  cfg.src = &src;
+  cfg.keys = keys;
+  cfg.presses = presses;
+  cfg.max_cycles = (uint64_t)(max_sec*SIM_CORE_HZ);
+  sim_init(&cfg);
+
+  fw_main();
+  sim_finish("firmware returned from main()", true);
+  return 1;
+}
@@ -0,0 +1,67 @@
+/* -----------------------------------------------------------------------------
+ * src_host.c - Opens a host sample source from its description (host only)
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "src_host.h"
+
+// parses F[,F...] into tones, returns the number of tones or -1
+static int _parse_synth(const char* spec, src_tone_t* tones) {
+  int ntones = 0;
+  const char* p = spec;
+  while (*p && ntones < SRC_MAX_TONES) {
+    char* end;
+    long freq = strtol(p, &end, 10);
+    if (end == p || freq <= 0 || freq >= SRC_SAMPLE_RATE/2) return -1;
+    tones[ntones].freq_hz = freq;
+    tones[ntones].amplitude = SRC_SYNTH_AMPLITUDE;
+    ntones++;
+    p = (*end == ',') ? end+1 : end;
+    if (*end && *end != ',') return -1;
+  }
+  return (*p || ntones == 0) ? -1 : ntones;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+// see .h for more details
+int src_host_open(sample_source_t* src, src_host_ctx_t* ctx, const char* spec,
+                  uint32_t nchannels, uint32_t nframes) {
+
+  ctx->is_wav = false;
+
+  if (!strncmp(spec, "synth:", 6)) {
+    src_tone_t tones[SRC_MAX_TONES];
+    int ntones = _parse_synth(spec+6, tones);
+    if (ntones < 0) {
+      fprintf(stderr, "%s: bad synth spec, expected synth:F[,F...]\n", spec);
+      return -1;
+    }
+    return src_synth_init(src, &ctx->synth, tones, ntones, nchannels, nframes);
+  }
+
+  if (src_wav_init(src, &ctx->wav, spec, nchannels)) return -1;
+  ctx->is_wav = true;
+  return 0;
+}
+
+// see .h for more details
+void src_host_close(src_host_ctx_t* ctx) {
+  if (ctx->is_wav) {
+    src_wav_close(&ctx->wav);
+    ctx->is_wav = false;
+  }
+}
@@ -0,0 +1,149 @@
+/* -----------------------------------------------------------------------------
+ * src_host.h - Sample source backends only available in host builds
+ *
+ * A WAV file backend and a synthetic signal backend for the sample_source_t
+ * interface (see source/sample_source.h), used to run the analysis pipeline
+ * on Linux. Both produce 48 kHz frames in the same unsigned 16-bit format
+ * analog_input captures, i.e. silence is 0x8000.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _SRC_HOST_H_
+#define _SRC_HOST_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "sample_source.h"
+
+#define SRC_SAMPLE_RATE   (48000)  // the only sample rate accepted
+#define SRC_MAX_CHANNELS  (4)      // the most channels analog_input captures
+#define SRC_MAX_TONES     (8)      // the most tones in a synthetic signal
+#define SRC_SYNTH_AMPLITUDE (8000) // amplitude of the tones of a synth: spec
+
+// state of the WAV file backend
+typedef struct {
+  FILE* file;             // the open WAV file, positioned in the data chunk
+  uint32_t file_channels; // channels stored in the file
+  uint32_t nchannels;     // channels in the returned frames
+  uint32_t frames_left;   // whole frames left in the data chunk
+  uint32_t seq;           // sequence number of the last frame returned
+  uint16_t samples[AIN_FRAME_SAMPLES*SRC_MAX_CHANNELS];
+} src_wav_ctx_t;
+
+// a tone in a synthetic signal
+typedef struct {
+  uint32_t freq_hz;       // frequency of the tone
+  uint16_t amplitude;     // peak amplitude, in ADC counts
+} src_tone_t;
+
+// state of the synthetic backend
+typedef struct {
+  src_tone_t tones[SRC_MAX_TONES][SRC_MAX_CHANNELS];  // per channel tones
+  uint32_t ntones;        // number of tones per channel
+  uint32_t nchannels;     // channels in the returned frames
+  uint32_t noise;         // peak amplitude of uniform noise, in ADC counts
+  uint32_t noise_state;   // state of the noise generator
+  uint32_t frames_left;   // frames left to return, UINT32_MAX is endless
+  uint32_t seq;           // sequence number of the last frame returned
+  uint16_t samples[AIN_FRAME_SAMPLES*SRC_MAX_CHANNELS];
+} src_synth_ctx_t;
+
+// state of a source opened by name, either backend
+typedef struct {
+  src_wav_ctx_t wav;
+  src_synth_ctx_t synth;
+  bool is_wav;            // whether the WAV backend is in use
+} src_host_ctx_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+/*
+ * @brief   Sets up a source that streams frames from a WAV file
+ *
+ * Only 16-bit PCM at 48 kHz is accepted. Frame channel ch is taken from
+ * file channel (ch % file channels), so a mono file can feed a stereo
+ * pipeline and extra file channels are dropped. A trailing partial frame is
+ * not returned.
+ *
+ * @param   src, the sample source to initialize
+ *          ctx, storage for the backend state, must outlive src
+ *          path, the WAV file to open
+ *          nchannels, the number of channels in the returned frames
+ * @return  0 on success, -1 on error (message printed to stderr)
+ */
+int src_wav_init(sample_source_t* src, src_wav_ctx_t* ctx, const char* path,
+                 uint32_t nchannels);
+
+/*
+ * @brief   Closes the file of a WAV source
+ *
+ * @param   ctx, the backend state given to src_wav_init()
+ * @return  none
+ */
+void src_wav_close(src_wav_ctx_t* ctx);
+
+/*
+ * @brief   Writes interleaved samples to a 16-bit PCM 48 kHz WAV file
+ *
+ * @param   path, the WAV file to create
+ *          samples, the interleaved samples in analog_input format
+ *          nsamples, the number of samples per channel
+ *          nchannels, the number of interleaved channels
+ * @return  0 on success, -1 on error
+ */
+int src_wav_write(const char* path, const uint16_t* samples, uint32_t nsamples,
+                  uint32_t nchannels);
+
+/*
+ * @brief   Sets up a source that generates a sum of sine tones plus noise
+ *
+ * Every channel gets the same tones; they can be changed per channel in
+ * ctx->tones afterwards (e.g. to pan a tone). Phase is continuous across
+ * frames.
+ *
+ * @param   src, the sample source to initialize
+ *          ctx, storage for the backend state, must outlive src
+ *          tones, the tones to generate
+ *          ntones, the number of tones (up to SRC_MAX_TONES)
+ *          nchannels, the number of channels in the returned frames
+ *          nframes, the number of frames to return, 0 for endless
+ * @return  0 on success, -1 on error
+ */
+int src_synth_init(sample_source_t* src, src_synth_ctx_t* ctx,
+                   const src_tone_t* tones, uint32_t ntones,
+                   uint32_t nchannels, uint32_t nframes);
+
+/*
+ * @brief   Sets up a source from a command line style description
+ *
+ * The spec is either the path of a WAV file or synth:F[,F...] for sine
+ * tones of SRC_SYNTH_AMPLITUDE at the given frequencies in Hz.
+ *
+ * @param   src, the sample source to initialize
+ *          ctx, storage for the backend state, must outlive src
+ *          spec, the description of the source
+ *          nchannels, the number of channels in the returned frames
+ *          nframes, the number of synth frames to return, 0 for endless
+ * @return  0 on success, -1 on error (message printed to stderr)
+ */
+int src_host_open(sample_source_t* src, src_host_ctx_t* ctx, const char* spec,
+                  uint32_t nchannels, uint32_t nframes);
+
+/*
+ * @brief   Releases a source set up by src_host_open()
+ *
+ * @param   ctx, the backend state given to src_host_open()
+ * @return  none
+ */
+void src_host_close(src_host_ctx_t* ctx);
+
+#endif // _SRC_HOST_H_
@@ -0,0 +1,101 @@
+/* -----------------------------------------------------------------------------
+ * src_synth.c - Synthetic signal sample source backend (host only)
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include "src_host.h"
+
+#define ADC_CENTER  (0x8000)
+
+static bool _synth_is_avail(sample_source_t* src) {
+  src_synth_ctx_t* ctx = src->ctx;
+  return ctx->frames_left > 0;
+}
+
+// xorshift32, deterministic so runs are repeatable
+static uint32_t _noise_next(uint32_t* state) {
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return *state = x;
+}
+
+static int _synth_get_frame(sample_source_t* src, ain_frame_t* frame) {
+
+  src_synth_ctx_t* ctx = src->ctx;
+
+  if (ctx->frames_left == 0) return -1;
+  if (ctx->frames_left != UINT32_MAX) {
+    ctx->frames_left--;
+  }
+
+  uint32_t sample_idx = ctx->seq*AIN_FRAME_SAMPLES;
+
+  for (int i=0; i<AIN_FRAME_SAMPLES; i++) {
+    // time in seconds, from the sample index so the phase never drifts
+    double t = (double)(sample_idx + i)/SRC_SAMPLE_RATE;
+    for (int ch=0; ch<ctx->nchannels; ch++) {
+      double v = ADC_CENTER;
+      for (int k=0; k<ctx->ntones; k++) {
+        src_tone_t* tone = &ctx->tones[k][ch];
+        v += tone->amplitude*sin(2*M_PI*tone->freq_hz*t);
+      }
+      if (ctx->noise) {
+        v += (int32_t)(_noise_next(&ctx->noise_state) % (2*ctx->noise+1)) -
+             (int32_t)ctx->noise;
+      }
+      // clip like the ADC would
+      if (v < 0) v = 0;
+      if (v > UINT16_MAX) v = UINT16_MAX;
+      ctx->samples[i*ctx->nchannels+ch] = (uint16_t)lround(v);
+    }
+  }
+
+  frame->samples = ctx->samples;
+  frame->nchannels = ctx->nchannels;
+  frame->seq = ++ctx->seq;
+  frame->sample_idx = sample_idx;
+  frame->samples_missed = 0;
+  frame->t_capture = src_sample_time(sample_idx + AIN_FRAME_SAMPLES - 1);
+
+  return 0;
+}
+
+// see .h for more details
+int src_synth_init(sample_source_t* src, src_synth_ctx_t* ctx,
+                   const src_tone_t* tones, uint32_t ntones,
+                   uint32_t nchannels, uint32_t nframes) {
+
+  // error case
+  if (src == NULL || ctx == NULL || (tones == NULL && ntones > 0) ||
+      ntones > SRC_MAX_TONES || nchannels == 0 ||
+      nchannels > SRC_MAX_CHANNELS) {
+    return -1;
+  }
+
+  memset(ctx, 0, sizeof(*ctx));
+  for (int k=0; k<ntones; k++) {
+    for (int ch=0; ch<nchannels; ch++) {
+      ctx->tones[k][ch] = tones[k];
+    }
+  }
+  ctx->ntones = ntones;
+  ctx->nchannels = nchannels;
+  ctx->noise_state = 0x12345678;
+  ctx->frames_left = nframes ? nframes : UINT32_MAX;
+
+  src->is_avail = _synth_is_avail;
+  src->get_frame = _synth_get_frame;
+  src->ctx = ctx;
+
+  return 0;
+}
@@ -0,0 +1,186 @@
+/* -----------------------------------------------------------------------------
+ * src_wav.c - WAV file sample source backend (host only)
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "src_host.h"
+
+#define WAV_FMT_PCM  (1)
+
+static uint32_t _le32(const uint8_t* p) {
+  return p[0] | (p[1]<<8) | (p[2]<<16) | ((uint32_t)p[3]<<24);
+}
+
+static uint16_t _le16(const uint8_t* p) {
+  return p[0] | (p[1]<<8);
+}
+
+static void _put_le32(uint8_t* p, uint32_t v) {
+  p[0] = v; p[1] = v>>8; p[2] = v>>16; p[3] = v>>24;
+}
+
+static void _put_le16(uint8_t* p, uint16_t v) {
+  p[0] = v; p[1] = v>>8;
+}
+
+static bool _wav_is_avail(sample_source_t* src) {
+  src_wav_ctx_t* ctx = src->ctx;
+  return ctx->frames_left > 0;
+}
+
+static int _wav_get_frame(sample_source_t* src, ain_frame_t* frame) {
+
+  src_wav_ctx_t* ctx = src->ctx;
+  int16_t pcm[AIN_FRAME_SAMPLES*SRC_MAX_CHANNELS];
+
+  if (ctx->frames_left == 0) return -1;
+  if (fread(pcm, sizeof(int16_t)*ctx->file_channels, AIN_FRAME_SAMPLES,
+            ctx->file) != AIN_FRAME_SAMPLES) {
+    ctx->frames_left = 0;
+    return -1;
+  }
+  ctx->frames_left--;
+
+  // signed little endian PCM to the unsigned ADC format
+  for (int i=0; i<AIN_FRAME_SAMPLES; i++) {
+    for (int ch=0; ch<ctx->nchannels; ch++) {
+      const uint8_t* p = (const uint8_t*)
+                         &pcm[i*ctx->file_channels + ch%ctx->file_channels];
+      ctx->samples[i*ctx->nchannels+ch] = _le16(p) ^ 0x8000;
+    }
+  }
+
+  uint32_t sample_idx = ctx->seq*AIN_FRAME_SAMPLES;
+  frame->samples = ctx->samples;
+  frame->nchannels = ctx->nchannels;
+  frame->seq = ++ctx->seq;
+  frame->sample_idx = sample_idx;
+  frame->samples_missed = 0;
+  frame->t_capture = src_sample_time(sample_idx + AIN_FRAME_SAMPLES - 1);
+
+  return 0;
+}
+
+// see .h for more details
+int src_wav_init(sample_source_t* src, src_wav_ctx_t* ctx, const char* path,
+                 uint32_t nchannels) {
+
+  uint8_t hdr[16];
+  bool is_fmt_ok = false;
+
+  // error case
+  if (src == NULL || ctx == NULL || path == NULL || nchannels == 0 ||
+      nchannels > SRC_MAX_CHANNELS) {
+    return -1;
+  }
+
+  memset(ctx, 0, sizeof(*ctx));
+  ctx->nchannels = nchannels;
+  ctx->file = fopen(path, "rb");
+  if (ctx->file == NULL) {
+    perror(path);
+    return -1;
+  }
+
+  // RIFF header
+  if (fread(hdr, 1, 12, ctx->file) != 12 || memcmp(hdr, "RIFF", 4) ||
+      memcmp(hdr+8, "WAVE", 4)) {
+    fprintf(stderr, "%s: not a WAV file\n", path);
+    goto error;
+  }
+
+  // walk the chunks up to the data chunk
+  while (fread(hdr, 1, 8, ctx->file) == 8) {
+    uint32_t size = _le32(hdr+4);
+
+    if (!memcmp(hdr, "fmt ", 4)) {
+      if (size < 16 || fread(hdr, 1, 16, ctx->file) != 16) break;
+      uint16_t format = _le16(hdr);
+      ctx->file_channels = _le16(hdr+2);
+      uint32_t rate = _le32(hdr+4);
+      uint16_t bits = _le16(hdr+14);
+      if (format != WAV_FMT_PCM || bits != 16 || rate != SRC_SAMPLE_RATE ||
+          ctx->file_channels == 0 || ctx->file_channels > SRC_MAX_CHANNELS) {
+        fprintf(stderr, "%s: need 16-bit PCM at %d Hz with 1 to %d channels "
+                "(got format %u, %u bits, %u Hz, %u channels)\n", path,
+                SRC_SAMPLE_RATE, SRC_MAX_CHANNELS, format, bits, rate,
+                ctx->file_channels);
+        goto error;
+      }
+      is_fmt_ok = true;
+      size -= 16;
+
+    } else if (!memcmp(hdr, "data", 4)) {
+      if (!is_fmt_ok) break;
+      ctx->frames_left = size/(2*ctx->file_channels*AIN_FRAME_SAMPLES);
+      src->is_avail = _wav_is_avail;
+      src->get_frame = _wav_get_frame;
+      src->ctx = ctx;
+      return 0;
+    }
+
+    // skip the rest of the chunk, chunks are padded to even sizes
+    if (fseek(ctx->file, size + (size & 1), SEEK_CUR)) break;
+  }
+
+  fprintf(stderr, "%s: no PCM data found\n", path);
+error:
+  fclose(ctx->file);
+  ctx->file = NULL;
+  return -1;
+}
+
+// see .h for more details
+void src_wav_close(src_wav_ctx_t* ctx) {
+  if (ctx != NULL && ctx->file != NULL) {
+    fclose(ctx->file);
+    ctx->file = NULL;
+  }
+}
+
+// see .h for more details
+int src_wav_write(const char* path, const uint16_t* samples, uint32_t nsamples,
+                  uint32_t nchannels) {
+
+  uint8_t hdr[44];
+  uint32_t data_size = nsamples*nchannels*2;
+
+  // error case
+  if (path == NULL || samples == NULL || nchannels == 0) return -1;
+
+  FILE* file = fopen(path, "wb");
+  if (file == NULL) {
+    perror(path);
+    return -1;
+  }
+
+  memcpy(hdr, "RIFF", 4);
+  _put_le32(hdr+4, 36 + data_size);
+  memcpy(hdr+8, "WAVEfmt ", 8);
+  _put_le32(hdr+16, 16);
+  _put_le16(hdr+20, WAV_FMT_PCM);
+  _put_le16(hdr+22, nchannels);
+  _put_le32(hdr+24, SRC_SAMPLE_RATE);
+  _put_le32(hdr+28, SRC_SAMPLE_RATE*nchannels*2);
+  _put_le16(hdr+32, nchannels*2);
+  _put_le16(hdr+34, 16);
+  memcpy(hdr+36, "data", 4);
+  _put_le32(hdr+40, data_size);
+  fwrite(hdr, 1, sizeof(hdr), file);
+
+  for (uint32_t i=0; i<nsamples*nchannels; i++) {
+    uint8_t pcm[2];
+    _put_le16(pcm, samples[i] ^ 0x8000);
+    fwrite(pcm, 1, 2, file);
+  }
+
+  return fclose(file) ? -1 : 0;
+}
@@ -0,0 +1,114 @@
+/* -----------------------------------------------------------------------------
+ * stream2wav.c - Turns a captured sample stream back into a WAV file
+ *
+ * Reads what the firmware sent while streaming STREAM_SAMPLES or STREAM_ADPCM
+ * (see uart_stream.h), as captured from the serial port or written by
+ * fw_sim -u, and writes channel 0 as a 16-bit 48 kHz WAV file that viz_host
+ * or fw_sim can replay. Other message types, and messages that console text
+ * mixed into, are skipped. Frames lost on the way show up as gaps in the
+ * sequence numbers and are counted on stderr.
+ *
+ *   usage: stream2wav CAPTURE OUT.wav
+ *     CAPTURE the captured bytes, - for stdin
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include "analog_input.h"
+#include "adpcm.h"
+#include "uart_stream.h"
+#include "telem_host.h"
+#include "src_host.h"
+
+#define BLOCK_BYTES  ADPCM_BLOCK_BYTES(AIN_FRAME_SAMPLES)
+#define RAW_BYTES    (AIN_FRAME_SAMPLES*sizeof(uint16_t))
+
+// the frames received so far
+typedef struct {
+  uint16_t* samples;
+  uint32_t nframes;
+  uint32_t capacity;      // frames
+  uint32_t nmissed;       // frames lost between the ones received
+  uint32_t last_seq;
+} frames_t;
+
+static void _usage() {
+  fprintf(stderr, "usage: stream2wav (CAPTURE | -) OUT.wav\n");
+  exit(2);
+}
+
+// takes in one message, keeping the samples
+static void _handle(const telem_header_t* msg, void* arg) {
+
+  frames_t* frames = arg;
+  const uint8_t* payload = (const uint8_t*)(msg + 1);
+
+  if (!((msg->type == STREAM_SAMPLES && msg->length == RAW_BYTES) ||
+        (msg->type == STREAM_ADPCM && msg->length == BLOCK_BYTES))) {
+    return;
+  }
+
+  if (frames->nframes == frames->capacity) {
+    frames->capacity = frames->capacity ? 2*frames->capacity : 256;
+    frames->samples = realloc(frames->samples, frames->capacity*RAW_BYTES);
+    if (frames->samples == NULL) {
+      fprintf(stderr, "stream2wav: out of memory\n");
+      exit(1);
+    }
+  }
+
+  uint16_t* dest = frames->samples + frames->nframes*AIN_FRAME_SAMPLES;
+  if (msg->type == STREAM_SAMPLES) {
+    memcpy(dest, payload, RAW_BYTES);
+  } else if (adpcm_decode(payload, AIN_FRAME_SAMPLES, dest, 1)) {
+    return;
+  }
+
+  if (frames->nframes && msg->seq > frames->last_seq) {
+    frames->nmissed += msg->seq - frames->last_seq - 1;
+  }
+  frames->last_seq = msg->seq;
+  frames->nframes++;
+}
+
+int main(int argc, char** argv) {
+
+  frames_t frames = { 0 };
+  telem_rx_t rx;
+  uint8_t data[4096];
+  ssize_t n;
+
+  if (argc != 3) _usage();
+
+  int fd = telem_open(argv[1], STREAM_BAUD);
+  if (fd < 0) return 1;
+
+  telem_rx_init(&rx, _handle, &frames);
+  while ((n = read(fd, data, sizeof(data))) > 0) {
+    telem_rx_feed(&rx, data, n);
+  }
+  close(fd);
+
+  if (frames.nframes == 0) {
+    fprintf(stderr, "stream2wav: no samples found\n");
+    return 1;
+  }
+  if (src_wav_write(argv[2], frames.samples,
+                    frames.nframes*AIN_FRAME_SAMPLES, 1)) {
+    return 1;
+  }
+  fprintf(stderr, "stream2wav: %" PRIu32 " frames, %" PRIu32 " lost "
+          "between them, %" PRIu32 " corrupt messages\n", frames.nframes,
+          frames.nmissed, rx.nerrors);
+  free(frames.samples);
+  return 0;
+}
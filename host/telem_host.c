@@ -0,0 +1,115 @@
+/* -----------------------------------------------------------------------------
+ * telem_host.c - Receives the firmware's telemetry messages on the host
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include "telem_host.h"
+
+// the termios speed constant for a baud rate, 0 if there is none
+static speed_t _speed(uint32_t baud) {
+  switch (baud) {
+    case 9600:    return B9600;
+    case 19200:   return B19200;
+    case 38400:   return B38400;
+    case 57600:   return B57600;
+    case 115200:  return B115200;
+    case 230400:  return B230400;
+    case 460800:  return B460800;
+    case 500000:  return B500000;
+    case 921600:  return B921600;
+    case 1000000: return B1000000;
+    case 2000000: return B2000000;
+    default:      return 0;
+  }
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+// see .h for more details
+void telem_rx_init(telem_rx_t* rx, telem_handler_t handler, void* arg) {
+  memset(rx, 0, sizeof(telem_rx_t));
+  rx->handler = handler;
+  rx->arg = arg;
+}
+
+// see .h for more details
+void telem_rx_feed(telem_rx_t* rx, const uint8_t* data, size_t nbytes) {
+
+  for (size_t i=0; i<nbytes; i++) {
+
+    if (data[i] != TELEM_DELIMITER) {
+      if (!rx->is_synced) continue;
+      if (rx->nbytes == sizeof(rx->buf.bytes)) {
+        // too long for any message, wait for the next delimiter
+        rx->nerrors++;
+        rx->is_synced = false;
+        continue;
+      }
+      rx->buf.bytes[rx->nbytes++] = data[i];
+      continue;
+    }
+
+    if (rx->is_synced && rx->nbytes > 0) {
+      const telem_header_t* msg = telem_decode(rx->buf.bytes, rx->nbytes);
+      if (msg == NULL) {
+        rx->nerrors++;
+      } else {
+        rx->nmessages++;
+        if (rx->handler != NULL) rx->handler(msg, rx->arg);
+      }
+    }
+    rx->nbytes = 0;
+    rx->is_synced = true;
+  }
+}
+
+// see .h for more details
+int telem_open(const char* path, uint32_t baud) {
+
+  int fd = strcmp(path, "-") ? open(path, O_RDONLY | O_NOCTTY) : 0;
+  if (fd < 0) {
+    perror(path);
+    return -1;
+  }
+  if (!isatty(fd)) return fd;
+
+  struct termios tio;
+  speed_t speed = _speed(baud);
+  if (speed == 0) {
+    fprintf(stderr, "%s: unsupported baud rate %u\n", path, baud);
+    close(fd);
+    return -1;
+  }
+  if (tcgetattr(fd, &tio)) {
+    perror(path);
+    close(fd);
+    return -1;
+  }
+  cfmakeraw(&tio);
+  tio.c_cflag |= CLOCAL | CREAD;
+  tio.c_cc[VMIN] = 1;
+  tio.c_cc[VTIME] = 0;
+  cfsetispeed(&tio, speed);
+  cfsetospeed(&tio, speed);
+  if (tcsetattr(fd, TCSANOW, &tio)) {
+    perror(path);
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
@@ -0,0 +1,82 @@
+/* -----------------------------------------------------------------------------
+ * telem_host.h - Receives the firmware's telemetry messages on the host
+ *
+ * Splits a byte stream from the serial port (or a capture of one) at the
+ * telemetry.h delimiters and hands every message that decodes with a good
+ * CRC to a handler. Anything else between delimiters, such as console text
+ * printed while streaming, is counted and skipped.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _TELEM_HOST_H_
+#define _TELEM_HOST_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "telemetry.h"
+
+// receives each valid message; the payload follows the header
+typedef void (*telem_handler_t)(const telem_header_t* msg, void* arg);
+
+// state of a receiver
+typedef struct {
+  union {
+    uint8_t bytes[TELEM_WIRE_BYTES(TELEM_MAX_PAYLOAD)];
+    telem_header_t align;
+  } buf;                  // the bytes since the last delimiter
+  uint32_t nbytes;
+  bool is_synced;         // false until the first delimiter, or after junk
+                          // too long to be a message
+  uint32_t nmessages;     // messages handed to the handler
+  uint32_t nerrors;       // runs of bytes that were not a valid message
+  telem_handler_t handler;
+  void* arg;
+} telem_rx_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+/*
+ * @brief   Initializes a receiver
+ *
+ * The bytes before the first delimiter are discarded without counting an
+ * error, the receiver may have started listening mid-message.
+ *
+ * @param   rx, the receiver
+ *          handler, called for each message
+ *          arg, passed to the handler
+ * @return  none
+ */
+void telem_rx_init(telem_rx_t* rx, telem_handler_t handler, void* arg);
+
+/*
+ * @brief   Feeds received bytes to a receiver
+ *
+ * @param   rx, the receiver
+ *          data, the bytes
+ *          nbytes, the number of bytes
+ * @return  none
+ */
+void telem_rx_feed(telem_rx_t* rx, const uint8_t* data, size_t nbytes);
+
+/*
+ * @brief   Opens a serial port, capture file or stdin for reading
+ *
+ * A terminal device is put in raw mode (no echo, no line or CR/LF
+ * processing) at the given baud rate.
+ *
+ * @param   path, the device or file, - for stdin
+ *          baud, the baud rate for a terminal device
+ * @return  int, the file descriptor, -1 on error
+ */
+int telem_open(const char* path, uint32_t baud);
+
+#endif // _TELEM_HOST_H_
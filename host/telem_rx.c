@@ -0,0 +1,255 @@
+/* -----------------------------------------------------------------------------
+ * telem_rx.c - Live view of the firmware's telemetry stream
+ *
+ * Reads the messages sent while streaming (see uart_stream.h) from the
+ * serial port, a capture of it, or fw_sim -u, and either draws the spectrum,
+ * bucket peaks, beats and timing in the terminal as they arrive or writes
+ * every message as a CSV line. The counts of messages, corrupt messages and
+ * frames lost are printed on stderr at the end.
+ *
+ *   usage: telem_rx [-c] [-b BAUD] SOURCE
+ *     -c      write CSV to stdout instead of drawing
+ *     -b      the baud rate of a serial port (default STREAM_BAUD)
+ *     SOURCE  the serial port, a capture file, or - for stdin
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+#include <unistd.h>
+#include "analog_input.h"
+#include "adpcm.h"
+#include "uart_stream.h"
+#include "telem_host.h"
+
+#define NUM_BINS      (AIN_FRAME_SAMPLES/2)
+#define COLUMNS       (64)                  // spectrum bars drawn
+#define ROWS          (16)
+#define DRAW_NS       (33000000L)           // redraw at most ~30 times/s
+#define BEAT_SHOWN    (10)                  // frames a beat stays on screen
+#define MAX_TYPE      (STREAM_BEAT)
+
+// everything the live view shows
+typedef struct {
+  bool is_csv;
+  uint32_t last_seq[MAX_TYPE+1];  // of each per-frame message type
+  uint32_t nlost;                 // frames missing from the sequence
+  int16_t bins[NUM_BINS];
+  uint32_t nbins;                 // of the last spectrum, up to NUM_BINS
+  int32_t full_scale;             // of the bars, follows the loudest bin
+  fft_peaks peaks[AIN_NUM_CHANNELS];
+  uint32_t npeak_channels;
+  uint32_t seq;
+  uint32_t nbeats;
+  uint32_t beat_seq;
+  stream_timing_t timing;
+  stream_stats_t stats;
+  struct timespec t_draw;
+} view_t;
+
+static void _usage() {
+  fprintf(stderr, "usage: telem_rx [-c] [-b BAUD] (SOURCE | -)\n");
+  exit(2);
+}
+
+// counts the frames skipped since the last message of the same type
+static void _track_seq(view_t* view, const telem_header_t* msg) {
+  if (msg->type > MAX_TYPE) return;
+  uint32_t last = view->last_seq[msg->type];
+  if (last && msg->seq > last + 1) {
+    view->nlost += msg->seq - last - 1;
+  }
+  view->last_seq[msg->type] = msg->seq;
+}
+
+// one CSV line: type, seq, t_capture, then the values
+static void _write_csv(const telem_header_t* msg) {
+
+  const void* payload = msg + 1;
+  printf("%u,%" PRIu32 ",%" PRIu32, msg->type, msg->seq, msg->t_capture);
+
+  if (msg->type == STREAM_SAMPLES || msg->type == STREAM_SPECTRUM ||
+      msg->type == STREAM_PEAKS) {
+    const int16_t* values = payload;
+    for (int i=0; i<msg->length/sizeof(int16_t); i++) {
+      // samples are unsigned, everything else signed
+      printf(",%d", msg->type == STREAM_SAMPLES ? (uint16_t)values[i] :
+                                                  values[i]);
+    }
+  } else if (msg->type == STREAM_ADPCM) {
+    uint16_t samples[AIN_FRAME_SAMPLES];
+    if (msg->length == ADPCM_BLOCK_BYTES(AIN_FRAME_SAMPLES) &&
+        adpcm_decode(payload, AIN_FRAME_SAMPLES, samples, 1) == 0) {
+      for (int i=0; i<AIN_FRAME_SAMPLES; i++) {
+        printf(",%u", samples[i]);
+      }
+    }
+  } else {
+    // statistics, beats and timing are all uint32_t
+    const uint32_t* values = payload;
+    for (int i=0; i<msg->length/sizeof(uint32_t); i++) {
+      printf(",%" PRIu32, values[i]);
+    }
+  }
+  printf("\n");
+}
+
+// redraws the terminal
+static void _draw(view_t* view) {
+
+  // a column covers the same band whatever the FFT length
+  int32_t cols[COLUMNS];
+  int32_t loudest = 0;
+  for (int c=0; c<COLUMNS; c++) {
+    cols[c] = 0;
+    int first = c*view->nbins/COLUMNS;
+    int last = (c+1)*view->nbins/COLUMNS;
+    if (last == first) last = first+1;   // fewer bins than columns
+    for (int i=first; i<last; i++) {
+      if (view->bins[i] > cols[c]) cols[c] = view->bins[i];
+    }
+    if (cols[c] > loudest) loudest = cols[c];
+  }
+  // jump up to a louder bin, fall back slowly
+  if (loudest > view->full_scale) {
+    view->full_scale = loudest;
+  } else if (view->full_scale > ROWS) {
+    view->full_scale -= view->full_scale/32 + 1;
+  }
+  int32_t scale = view->full_scale > ROWS ? view->full_scale : ROWS;
+
+  printf("\033[H\033[2J");
+  printf("spectrum, frame %" PRIu32 ", %d Hz per column, full scale %"
+         PRId32 "\n", view->seq, 48000/2/COLUMNS, scale);
+  for (int r=ROWS; r>0; r--) {
+    for (int c=0; c<COLUMNS; c++) {
+      putchar(cols[c]*ROWS >= r*scale ? '#' : ' ');
+    }
+    putchar('\n');
+  }
+  for (int c=0; c<COLUMNS; c++) putchar('-');
+  putchar('\n');
+
+  for (int ch=0; ch<view->npeak_channels; ch++) {
+    printf("peaks ch%d:", ch);
+    for (int i=0; i<NBUCKETS; i++) {
+      printf(" %4d@%-3u", view->peaks[ch].mags[i],
+             view->peaks[ch].indices[i]);
+    }
+    putchar('\n');
+  }
+  printf("beats: %" PRIu32 " %s\n", view->nbeats,
+         view->nbeats && view->seq - view->beat_seq < BEAT_SHOWN ?
+         "*** BEAT ***" : "");
+  printf("idle %" PRIu32 ".%" PRIu32 "%%, latency us p50 %" PRIu32 " p99 %"
+         PRIu32 " max %" PRIu32 ", missed samples %" PRIu32 "\n",
+         view->timing.idle_permille/10, view->timing.idle_permille%10,
+         view->timing.latency.p50_us, view->timing.latency.p99_us,
+         view->timing.latency.max_us, view->timing.samples_missed);
+  printf("stream %" PRIu32 " B/s, %" PRIu32 " sent, %" PRIu32 " dropped, %"
+         PRIu32 " frames lost\n", view->stats.bytes_per_sec,
+         view->stats.nsent, view->stats.ndropped, view->nlost);
+  fflush(stdout);
+}
+
+// takes in one message
+static void _handle(const telem_header_t* msg, void* arg) {
+
+  view_t* view = arg;
+  const void* payload = msg + 1;
+
+  if (msg->type != STREAM_STATS && msg->type != STREAM_BEAT) {
+    _track_seq(view, msg);
+  }
+  if (view->is_csv) {
+    _write_csv(msg);
+    return;
+  }
+
+  if (msg->type == STREAM_SPECTRUM && msg->length <= sizeof(view->bins) &&
+      msg->length >= sizeof(int16_t)) {
+    view->nbins = msg->length/sizeof(int16_t);
+    memcpy(view->bins, payload, view->nbins*sizeof(int16_t));
+    view->seq = msg->seq;
+  } else if (msg->type == STREAM_PEAKS && msg->nchannels >= 1 &&
+             msg->nchannels <= AIN_NUM_CHANNELS &&
+             msg->length == msg->nchannels*NBUCKETS*2*sizeof(uint16_t)) {
+    const uint16_t* p = payload;
+    for (int ch=0; ch<msg->nchannels; ch++) {
+      for (int i=0; i<NBUCKETS; i++) {
+        view->peaks[ch].indices[i] = *p++;
+        view->peaks[ch].mags[i] = (int16_t)*p++;
+      }
+    }
+    view->npeak_channels = msg->nchannels;
+    view->seq = msg->seq;
+  } else if (msg->type == STREAM_BEAT) {
+    view->nbeats++;
+    view->beat_seq = msg->seq;
+  } else if (msg->type == STREAM_STATS &&
+             msg->length == sizeof(stream_stats_t) +
+                            sizeof(stream_timing_t)) {
+    memcpy(&view->stats, payload, sizeof(stream_stats_t));
+    memcpy(&view->timing, (const uint8_t*)payload + sizeof(stream_stats_t),
+           sizeof(stream_timing_t));
+  }
+
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  long elapsed = (now.tv_sec - view->t_draw.tv_sec)*1000000000L +
+                 now.tv_nsec - view->t_draw.tv_nsec;
+  if (elapsed >= DRAW_NS) {
+    _draw(view);
+    view->t_draw = now;
+  }
+}
+
+int main(int argc, char** argv) {
+
+  static view_t view;
+  telem_rx_t rx;
+  uint32_t baud = STREAM_BAUD;
+  uint8_t data[4096];
+  ssize_t n;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "cb:")) != -1) {
+    switch (opt) {
+      case 'c':
+        view.is_csv = true;
+        break;
+      case 'b':
+        baud = strtoul(optarg, NULL, 10);
+        break;
+      default:
+        _usage();
+    }
+  }
+  if (optind != argc-1) _usage();
+
+  int fd = telem_open(argv[optind], baud);
+  if (fd < 0) return 1;
+
+  if (view.is_csv) {
+    printf("type,seq,t_capture,values\n");
+  }
+  telem_rx_init(&rx, _handle, &view);
+  while ((n = read(fd, data, sizeof(data))) > 0) {
+    telem_rx_feed(&rx, data, n);
+  }
+  if (!view.is_csv) _draw(&view);
+  close(fd);
+
+  fprintf(stderr, "telem_rx: %" PRIu32 " messages, %" PRIu32 " corrupt, %"
+          PRIu32 " frames lost\n", rx.nmessages, rx.nerrors, view.nlost);
+  return 0;
+}
@@ -0,0 +1,783 @@
+/* -----------------------------------------------------------------------------
+ * test_host.c - Host regression tests for the analysis pipeline
+ *
+ * Runs the on-target dsp test plus checks of the sample sources, the ADPCM
+ * coder, the telemetry framing and receiver (through a pty standing in for
+ * the serial port), the full source -> visualizer chain, the parameter
+ * store (on an array standing in for flash) and the LED encoder. Built and
+ * run by "make test" in host/.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#define _GNU_SOURCE   // posix_openpt() and friends
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include "test_dsp_analysis.h"
+#include "timestamp.h"
+#include "sample_source.h"
+#include "visualizer.h"
+#include "adpcm.h"
+#include "crc16.h"
+#include "telemetry.h"
+#include "telem_host.h"
+#include "src_host.h"
+#include "config.h"
+#include "config_store.h"
+#include "pixl_encode.h"
+#include "effects.h"
+#include "viz_modes.h"
+
+#define BIN_HZ(bin)  ((bin)*SRC_SAMPLE_RATE/AIN_FRAME_SAMPLES)
+#define TEST_FRAMES  (4)
+#define TEST_WAV     "build/test_host.wav"
+#define STORE_NSECTORS  (STORE_FLASH_SIZE/STORE_SECTOR_SIZE)
+
+// flash for the parameter store: an erase sets a sector to ones, a program
+// can only clear bits, and a power loss can cut programming short
+typedef struct {
+  uint32_t words[STORE_FLASH_SIZE/4];
+  uint32_t nerases[STORE_NSECTORS];
+  int32_t words_to_loss;    // programs until the power fails, -1 for never
+  uint32_t nreprograms;     // words programmed without an erase in between
+} test_flash_t;
+
+static void test_memory_source() {
+
+  static uint16_t samples[TEST_FRAMES*AIN_FRAME_SAMPLES+100];
+  sample_source_t src;
+  src_memory_ctx_t ctx;
+  ain_frame_t frame;
+
+  // less than a frame is an error
+  assert(src_memory_init(&src, &ctx, samples, AIN_FRAME_SAMPLES-1, 1,
+                         false) == -1);
+
+  // a partial trailing frame is dropped
+  assert(src_memory_init(&src, &ctx, samples,
+                         sizeof(samples)/sizeof(samples[0]), 1, false) == 0);
+  for (int i=0; i<TEST_FRAMES; i++) {
+    assert(src_is_avail(&src));
+    assert(src_get_frame(&src, &frame) == 0);
+    assert(frame.samples == samples + i*AIN_FRAME_SAMPLES);
+    assert(frame.seq == i+1);
+    assert(frame.sample_idx == i*AIN_FRAME_SAMPLES);
+    assert(frame.t_capture == src_sample_time((i+1)*AIN_FRAME_SAMPLES-1));
+  }
+  assert(!src_is_avail(&src));
+  assert(src_get_frame(&src, &frame) == -1);
+
+  // looping keeps the sequence going
+  src_memory_init(&src, &ctx, samples, 2*AIN_FRAME_SAMPLES, 2, true);
+  src_get_frame(&src, &frame);
+  assert(src_get_frame(&src, &frame) == 0);
+  assert(frame.samples == samples && frame.seq == 2);
+  assert(frame.sample_idx == AIN_FRAME_SAMPLES);
+
+  // 48 kHz samples at 3 MHz ticks
+  assert(src_sample_time(48) == TS_TICKS_PER_SEC/1000);
+}
+
+static void test_wav_round_trip() {
+
+  static uint16_t samples[TEST_FRAMES*AIN_FRAME_SAMPLES*2];
+  sample_source_t src;
+  src_synth_ctx_t synth;
+  src_wav_ctx_t wav;
+  ain_frame_t frame;
+  src_tone_t tone = { BIN_HZ(7), 12000 };
+
+  // record a noisy stereo signal with a different tone on each channel
+  src_synth_init(&src, &synth, &tone, 1, 2, TEST_FRAMES);
+  synth.noise = 500;
+  synth.tones[0][1].freq_hz = BIN_HZ(40);
+  for (int i=0; i<TEST_FRAMES; i++) {
+    assert(src_get_frame(&src, &frame) == 0);
+    memcpy(samples + i*AIN_FRAME_SAMPLES*2, frame.samples,
+           AIN_FRAME_SAMPLES*2*sizeof(uint16_t));
+  }
+  assert(!src_is_avail(&src));
+  assert(src_wav_write(TEST_WAV, samples, TEST_FRAMES*AIN_FRAME_SAMPLES,
+                       2) == 0);
+
+  // reading it back gives the same samples
+  assert(src_wav_init(&src, &wav, TEST_WAV, 2) == 0);
+  for (int i=0; i<TEST_FRAMES; i++) {
+    assert(src_get_frame(&src, &frame) == 0);
+    assert(frame.nchannels == 2 && frame.seq == i+1);
+    assert(!memcmp(frame.samples, samples + i*AIN_FRAME_SAMPLES*2,
+                   AIN_FRAME_SAMPLES*2*sizeof(uint16_t)));
+  }
+  assert(!src_is_avail(&src));
+  src_wav_close(&wav);
+
+  // fewer channels than the file takes the first ones
+  assert(src_wav_init(&src, &wav, TEST_WAV, 1) == 0);
+  assert(src_get_frame(&src, &frame) == 0);
+  for (int i=0; i<AIN_FRAME_SAMPLES; i++) {
+    assert(frame.samples[i] == samples[2*i]);
+  }
+  src_wav_close(&wav);
+
+  assert(src_wav_init(&src, &wav, "build/does_not_exist.wav", 1) == -1);
+}
+
+static void test_adpcm() {
+
+  static uint16_t decoded[TEST_FRAMES*AIN_FRAME_SAMPLES*2];
+  static uint8_t blocks[TEST_FRAMES][2][ADPCM_BLOCK_BYTES(AIN_FRAME_SAMPLES)];
+  sample_source_t src;
+  src_synth_ctx_t synth;
+  ain_frame_t frame;
+  adpcm_state_t coders[2];
+  src_tone_t tone = { 440, 12000 };
+  double signal = 0, error = 0;
+
+  // code a noisy stereo signal, one block per channel and frame
+  src_synth_init(&src, &synth, &tone, 1, 2, TEST_FRAMES);
+  synth.noise = 200;
+  synth.tones[0][1].freq_hz = 2500;
+  adpcm_init(&coders[0]);
+  adpcm_init(&coders[1]);
+  for (int i=0; i<TEST_FRAMES; i++) {
+    assert(src_get_frame(&src, &frame) == 0);
+    for (int ch=0; ch<2; ch++) {
+      assert(adpcm_encode(&coders[ch], frame.samples + ch, AIN_FRAME_SAMPLES,
+                          2, blocks[i][ch]) ==
+             ADPCM_BLOCK_BYTES(AIN_FRAME_SAMPLES));
+    }
+  }
+
+  // every block decodes on its own, close to the original
+  src_synth_init(&src, &synth, &tone, 1, 2, TEST_FRAMES);
+  synth.noise = 200;
+  synth.tones[0][1].freq_hz = 2500;
+  for (int i=TEST_FRAMES-1; i>=0; i--) {
+    for (int ch=0; ch<2; ch++) {
+      assert(adpcm_decode(blocks[i][ch], AIN_FRAME_SAMPLES,
+                          decoded + i*AIN_FRAME_SAMPLES*2 + ch, 2) == 0);
+    }
+  }
+  for (int i=0; i<TEST_FRAMES; i++) {
+    assert(src_get_frame(&src, &frame) == 0);
+    // skip the first frame while the step size adapts
+    for (int j=(i ? 0 : AIN_FRAME_SAMPLES*2); j<AIN_FRAME_SAMPLES*2; j++) {
+      double s = (double)frame.samples[j] - 0x8000;
+      double e = (double)decoded[i*AIN_FRAME_SAMPLES*2 + j] -
+                 frame.samples[j];
+      signal += s*s;
+      error += e*e;
+    }
+  }
+  assert(10*log10(signal/error) > 20);
+
+  // odd lengths and corrupt states are errors
+  assert(adpcm_encode(&coders[0], frame.samples, 3, 1, blocks[0][0]) == 0);
+  assert(adpcm_encode(&coders[0], frame.samples, 2, 0, blocks[0][0]) == 0);
+  blocks[0][0][2] = 89;
+  assert(adpcm_decode(blocks[0][0], AIN_FRAME_SAMPLES, decoded, 1) == -1);
+}
+
+// collects the messages a receiver hands over
+typedef struct {
+  uint32_t n;
+  uint32_t seqs[8];
+  uint32_t lengths[8];
+  uint8_t payload[TELEM_MAX_PAYLOAD];  // of the last message
+} telem_log_t;
+
+static void _log_msg(const telem_header_t* msg, void* arg) {
+  telem_log_t* log = arg;
+  assert(log->n < 8);
+  log->seqs[log->n] = msg->seq;
+  log->lengths[log->n] = msg->length;
+  memcpy(log->payload, msg + 1, msg->length);
+  log->n++;
+}
+
+// builds a message with a payload of zeros and long non-zero runs
+static uint32_t _build_msg(telem_buf_t* buf, uint32_t seq, uint32_t length) {
+  buf->header.type = 1;
+  buf->header.nchannels = 1;
+  buf->header.length = length;
+  buf->header.seq = seq;
+  buf->header.t_capture = 0x00ABCD00;
+  for (int i=0; i<length; i++) {
+    buf->payload[i] = (i % 300 == 299) ? 0 : (i & 0x7F) + 1;
+  }
+  return telem_encode(buf);
+}
+
+static void test_telemetry() {
+
+  static telem_buf_t buf;
+  static uint8_t wire[3*sizeof(telem_buf_t)];
+  static telem_log_t log;
+  telem_rx_t rx;
+
+  // the standard check value
+  assert(crc16("123456789", 9) == 0x29B1);
+
+  // the wire holds no zeros but the delimiter, and decodes back, for
+  // lengths around the 254 byte COBS runs
+  uint32_t lengths[] = { 0, 1, 240, 241, 242, 494, 495, TELEM_MAX_PAYLOAD };
+  for (int k=0; k<sizeof(lengths)/sizeof(lengths[0]); k++) {
+    uint32_t nbytes = _build_msg(&buf, k, lengths[k]);
+    assert(nbytes > 0 && nbytes <= TELEM_WIRE_BYTES(lengths[k]));
+    const uint8_t* p = (const uint8_t*)&buf;
+    assert(memchr(p, 0, nbytes) == p + nbytes - 1);
+
+    memset(&log, 0, sizeof(log));
+    telem_rx_init(&rx, _log_msg, &log);
+    telem_rx_feed(&rx, (const uint8_t*)"\0", 1);
+    telem_rx_feed(&rx, p, nbytes);
+    assert(log.n == 1 && log.seqs[0] == k && log.lengths[0] == lengths[k]);
+    for (int i=0; i<lengths[k]; i++) {
+      assert(log.payload[i] == ((i % 300 == 299) ? 0 : (i & 0x7F) + 1));
+    }
+  }
+  buf.header.length = TELEM_MAX_PAYLOAD + 1;
+  assert(telem_encode(&buf) == 0);
+
+  // through a pty: console text, a good message, a corrupted one and another
+  // good one. The text before the first delimiter is not an error, the
+  // carriage return in it would be mangled without raw mode
+  int master = posix_openpt(O_RDWR | O_NOCTTY);
+  assert(master >= 0 && grantpt(master) == 0 && unlockpt(master) == 0);
+  int fd = telem_open(ptsname(master), 1000000);
+  assert(fd >= 0);
+
+  uint32_t nwire = 0;
+  memcpy(wire, "idle: 99.0%\r\n", 14);
+  nwire += 14;
+  for (int k=1; k<=3; k++) {
+    uint32_t nbytes = _build_msg(&buf, k, 100*k + 13);
+    if (k == 2) ((uint8_t*)&buf)[50] ^= 0x10;
+    memcpy(wire + nwire, &buf, nbytes);
+    nwire += nbytes;
+  }
+  assert(write(master, wire, nwire) == nwire);
+
+  memset(&log, 0, sizeof(log));
+  telem_rx_init(&rx, _log_msg, &log);
+  uint32_t nread = 0;
+  struct pollfd pfd = { fd, POLLIN, 0 };
+  while (nread < nwire && poll(&pfd, 1, 1000) == 1) {
+    uint8_t data[256];
+    ssize_t n = read(fd, data, sizeof(data));
+    assert(n > 0);
+    telem_rx_feed(&rx, data, n);
+    nread += n;
+  }
+  assert(nread == nwire);
+  assert(rx.nmessages == 2 && rx.nerrors == 1);
+  assert(log.n == 2 && log.seqs[0] == 1 && log.seqs[1] == 3);
+  assert(log.lengths[1] == 313);
+
+  close(fd);
+  close(master);
+}
+
+static void test_pipeline() {
+
+  sample_source_t src;
+  src_synth_ctx_t synth;
+  ain_frame_t frame;
+  viz_frame_t viz;
+  const uint32_t* palette = viz_get_palette();
+
+  // a tone in the middle of bucket 4 (bins 10 to 14) lights only pixel 4
+  src_tone_t tone = { BIN_HZ(12), 8000 };
+  src_synth_init(&src, &synth, &tone, 1, 1, 1);
+  assert(src_get_frame(&src, &frame) == 0);
+  assert(viz_process(&frame, &viz) == 0);
+  assert(viz.peaks[0].indices[4] == 12);
+  int16_t tone_mag = viz.peaks[0].mags[4];
+  assert(viz.peaks[0].seq == 1 && viz.peaks[0].t_capture == frame.t_capture);
+  for (int i=0; i<NUM_PIXELS; i++) {
+    assert(viz.colors[i] == (i == 4 ? palette[4] : 0x0));
+  }
+
+  // silence lights nothing
+  src_synth_init(&src, &synth, NULL, 0, 1, 1);
+  src_get_frame(&src, &frame);
+  viz_process(&frame, &viz);
+  for (int i=0; i<NUM_PIXELS; i++) {
+    assert(viz.colors[i] == 0x0);
+  }
+
+  // a bass tone after a run of silence is one beat, it does not repeat
+  // while the tone holds
+  for (int i=0; i<30; i++) {
+    src_synth_init(&src, &synth, NULL, 0, 1, 1);
+    src_get_frame(&src, &frame);
+    viz_process(&frame, &viz);
+    assert(!viz.beat.is_beat);
+  }
+  src_tone_t bass = { BIN_HZ(3), 12000 };
+  for (int i=0; i<5; i++) {
+    src_synth_init(&src, &synth, &bass, 1, 1, 1);
+    src_get_frame(&src, &frame);
+    viz_process(&frame, &viz);
+    assert(viz.beat.is_beat == (i == 0));
+  }
+
+  // tuning: a threshold above the tone's peak puts pixel 4 out, a gain
+  // lights it again in its new color
+  viz_config_t config;
+  int16_t mag = tone_mag;
+  viz_get_default_config(&config);
+  assert(mag > 0 && mag < INT16_MAX/2);
+  config.thresh[4] = 2*mag;
+  config.palette[4] = 0x123456;
+  assert(viz_set_config(&config) == 0);
+  src_synth_init(&src, &synth, &tone, 1, 1, 1);
+  src_get_frame(&src, &frame);
+  viz_process(&frame, &viz);
+  assert(viz.colors[4] == 0x0);
+  config.gain_pct = 300;
+  assert(viz_set_config(&config) == 0);
+  viz_process(&frame, &viz);
+  assert(viz.colors[4] == 0x123456);
+
+  // a 256 point FFT has half the bins, the tone stays in bucket 4
+  viz_get_default_config(&config);
+  config.fft_size = 256;
+  assert(viz_set_config(&config) == 0);
+  viz_process(&frame, &viz);
+  assert(viz.peaks[0].indices[4] == 6);
+  assert(viz.colors[4] == palette[4]);
+
+  // invalid parameters change nothing
+  config.fft_size = 100;
+  assert(viz_set_config(&config) == -1);
+  viz_get_default_config(&config);
+  config.bucket_hz[3] = config.bucket_hz[2];
+  assert(viz_set_config(&config) == -1);
+  viz_get_default_config(&config);
+  config.beat_ratio_x4 = VIZ_BEAT_RATIO_X4_MAX+1;
+  assert(viz_set_config(&config) == -1);
+  config.beat_ratio_x4 = 4000000000U;
+  assert(viz_set_config(&config) == -1);
+  viz_get_default_config(&config);
+  assert(viz_set_config(&config) == 0);
+
+  // too many channels is an error
+  frame.nchannels = AIN_NUM_CHANNELS+1;
+  assert(viz_process(&frame, &viz) == -1);
+}
+
+static int _flash_erase(store_flash_t* flash, uint32_t offset) {
+  test_flash_t* t = flash->ctx;
+  assert(offset % STORE_SECTOR_SIZE == 0 && offset < STORE_FLASH_SIZE);
+  memset(&t->words[offset/4], 0xFF, STORE_SECTOR_SIZE);
+  t->nerases[offset/STORE_SECTOR_SIZE]++;
+  return 0;
+}
+
+static int _flash_program(store_flash_t* flash, uint32_t offset,
+                          uint32_t word) {
+  test_flash_t* t = flash->ctx;
+  assert(offset % 4 == 0 && offset < STORE_FLASH_SIZE);
+  if (t->words_to_loss == 0) return -1;
+  if (t->words_to_loss > 0) t->words_to_loss--;
+  if (t->words[offset/4] != 0xFFFFFFFFU) t->nreprograms++;
+  t->words[offset/4] &= word;
+  return 0;
+}
+
+// saves as the main loop would, returns 0 once the record is written
+static int _save(const config_t* config) {
+  store_status_t before, after;
+  store_get_status(&before);
+  if (store_save(config)) return -1;
+  if (store_is_erase_due() && store_erase()) return -1;
+  while (store_service(5)) {
+  }
+  store_get_status(&after);
+  return after.nsaves == before.nsaves + 1 ? 0 : -1;
+}
+
+static void test_config_store() {
+
+  static test_flash_t t;
+  store_flash_t flash = { (const uint8_t*)t.words, _flash_erase,
+                          _flash_program, &t };
+  config_t config, loaded;
+  store_status_t status;
+
+  memset(t.words, 0xFF, sizeof(t.words));
+  t.words_to_loss = -1;
+
+  // nothing saved yet: the parameters are left alone
+  cfg_init();
+  config = *cfg_get();
+  loaded = config;
+  assert(store_init(&flash, &loaded) == -1);
+  assert(!memcmp(&loaded, &config, sizeof(config)));
+
+  // a save survives a restart, with no erase of blank flash
+  config.viz.gain_pct = 300;
+  config.viz.palette[2] = 0x123456;
+  assert(_save(&config) == 0);
+  assert(store_init(&flash, &loaded) == 0);
+  assert(!memcmp(&loaded, &config, sizeof(config)));
+  store_get_status(&status);
+  assert(status.seq == 1 && t.nerases[0] == 0);
+
+  // many saves go around the ring, erasing every sector about equally, and
+  // the last one is loaded
+  for (uint32_t i=0; i<100; i++) {
+    config.viz.gain_pct = 100 + i;
+    assert(_save(&config) == 0);
+  }
+  assert(store_init(&flash, &loaded) == 0);
+  assert(loaded.viz.gain_pct == 199);
+  store_get_status(&status);
+  assert(status.seq == 101);
+  uint32_t min_erases = UINT32_MAX, max_erases = 0;
+  for (int i=0; i<STORE_NSECTORS; i++) {
+    if (t.nerases[i] < min_erases) min_erases = t.nerases[i];
+    if (t.nerases[i] > max_erases) max_erases = t.nerases[i];
+  }
+  assert(min_erases >= 2 && max_erases - min_erases <= 1);
+  assert(t.nreprograms == 0);
+
+  // a save cut short by a power loss is not loaded, the one before is, and
+  // the next save still goes through
+  for (int32_t nwords=0; nwords<33; nwords+=8) {
+    config.viz.gain_pct = 500;
+    t.words_to_loss = nwords;
+    assert(_save(&config) == -1);
+    t.words_to_loss = -1;
+    assert(store_init(&flash, &loaded) == 0);
+    assert(loaded.viz.gain_pct == 199);
+  }
+  config.viz.gain_pct = 600;
+  assert(_save(&config) == 0);
+  assert(store_init(&flash, &loaded) == 0);
+  assert(loaded.viz.gain_pct == 600);
+  assert(t.nreprograms == 0);
+
+  // a corrupted record is passed over for the one before it
+  store_get_status(&status);
+  uint32_t newest_seq = status.seq;
+  for (uint32_t i=0; i<STORE_FLASH_SIZE/4; i++) {
+    const store_header_t* header = (const store_header_t*)&t.words[i];
+    if (header->magic == STORE_MAGIC && header->seq == newest_seq) {
+      t.words[i + 4] = 0;   // clears bits, as flash can
+    }
+  }
+  assert(store_init(&flash, &loaded) == 0);
+  assert(loaded.viz.gain_pct == 199);
+
+  // and a save after it is newer than both
+  config.viz.gain_pct = 700;
+  assert(_save(&config) == 0);
+  assert(store_init(&flash, &loaded) == 0);
+  assert(loaded.viz.gain_pct == 700);
+  store_get_status(&status);
+  assert(status.seq == newest_seq + 1);
+
+  // no programming while an erase is due, or beyond the words allowed
+  while (store_save(&config) == 0 && !store_is_erase_due()) {
+    while (store_service(100)) {
+    }
+  }
+  assert(store_is_erase_due());
+  assert(store_service(100) > 0);
+  assert(store_save(&config) == -1);
+  assert(store_erase() == 0);
+  assert(store_service(1) > 0);
+  assert(store_service(100) == 0);
+}
+
+static void test_pixl_encode() {
+
+  static uint32_t colors[300];
+  static uint32_t lut[300*PIXL_WORDS_PER_PIXEL];
+  static uint32_t bitwise[300*PIXL_WORDS_PER_PIXEL];
+
+  // green goes out first, most significant bit first
+  uint32_t green = 0x00C000;
+  pixl_encode(&green, 1, NULL, lut);
+  const uint8_t* bytes = (const uint8_t*)lut;
+  for (int i=0; i<24; i++) {
+    assert(bytes[i] == (i < 2 ? PIXL_1 : PIXL_0));
+  }
+
+  // the table matches the bit by bit encoder, as they are and through the
+  // output stage
+  srand(1);
+  for (int i=0; i<300; i++) {
+    colors[i] = ((uint32_t)rand() ^ ((uint32_t)rand() << 12)) & 0xFFFFFF;
+  }
+  pixl_output_t output = { pixl_gamma, 200, pixl_dither(3) };
+  for (int is_output=0; is_output<2; is_output++) {
+    memset(lut, 0, sizeof(lut));
+    memset(bitwise, 0, sizeof(bitwise));
+    uint32_t ndither = pixl_encode(colors, 300, is_output ? &output : NULL,
+                                   lut);
+    assert(pixl_encode_bitwise(colors, 300, is_output ? &output : NULL,
+                               bitwise) == ndither);
+    assert(memcmp(lut, bitwise, sizeof(lut)) == 0);
+    assert(is_output ? ndither > 290 : ndither == 0);
+  }
+  assert(pixl_gamma[0] == 0 && pixl_gamma[255] == 0xFF00 &&
+         pixl_gamma[128] < 0x4000);
+
+  // over the dither steps a level averages out to within 1/8 of a byte
+  output.gamma = NULL;
+  output.brightness = PIXL_FULL_BRIGHTNESS/2;
+  for (uint32_t byte=0; byte<256; byte+=7) {
+    uint32_t color = byte, sum = 0;
+    for (uint32_t frame=0; frame<PIXL_DITHER_STEPS; frame++) {
+      output.dither = pixl_dither(frame);
+      assert(pixl_encode(&color, 1, &output, lut) == (byte & 1));
+      // blue is the last byte out
+      const uint8_t* out = (const uint8_t*)lut;
+      uint32_t sent = 0;
+      for (int i=16; i<24; i++) {
+        sent = (sent << 1) | (out[i] == PIXL_1);
+      }
+      sum += sent;
+    }
+    double mean = (double)sum/PIXL_DITHER_STEPS;
+    assert(fabs(mean - byte/2.0) <= 1.0/8);
+  }
+
+  // full brightness without gamma sends the bytes as they are
+  output.brightness = PIXL_FULL_BRIGHTNESS;
+  pixl_encode(colors, 300, &output, lut);
+  pixl_encode(colors, 300, NULL, bitwise);
+  assert(memcmp(lut, bitwise, sizeof(lut)) == 0);
+
+  // the SPI backend sends the same bits, two to a MOSI byte, first in the
+  // high nibble
+  output = (pixl_output_t){ pixl_gamma, 200, pixl_dither(3) };
+  for (int is_output=0; is_output<2; is_output++) {
+    uint32_t ndither = pixl_encode_bitwise(colors, 300,
+                                           is_output ? &output : NULL,
+                                           bitwise);
+    assert(pixl_encode_spi(colors, 300, is_output ? &output : NULL,
+                           lut) == ndither);
+    const uint8_t* duties = (const uint8_t*)bitwise;
+    const uint8_t* mosi = (const uint8_t*)lut;
+    for (int i=0; i<300*24; i++) {
+      uint32_t bits = i & 1 ? mosi[i/2] & 0xF : mosi[i/2] >> 4;
+      assert(bits == (duties[i] == PIXL_1 ? PIXL_SPI_1 : PIXL_SPI_0));
+    }
+  }
+}
+
+static void test_effects() {
+
+  // the corners of the hue circle, grey without saturation, black without
+  // value
+  assert(fx_hsv(0, 255, 255) == 0xFF0000);
+  assert(fx_hsv(256, 255, 255) == 0xFF0000);
+  uint32_t green = fx_hsv(85, 255, 255), blue = fx_hsv(170, 255, 255);
+  assert((green & 0xFF00FF) <= 0x020002 && (green & 0xFF00) == 0xFF00);
+  assert((blue & 0xFFFF00) <= 0x020200 && (blue & 0xFF) == 0xFF);
+  assert(fx_hsv(123, 0, 200) == 0xC8C8C8);
+  assert(fx_hsv(123, 255, 0) == 0x0);
+  for (uint32_t hue=0; hue<256; hue++) {
+    uint32_t c = fx_hsv(hue, 255, 255);
+    // one channel full, one empty
+    assert(((c >> 16) == 0xFF || ((c >> 8) & 0xFF) == 0xFF ||
+            (c & 0xFF) == 0xFF) &&
+           ((c >> 16) == 0 || ((c >> 8) & 0xFF) == 0 || (c & 0xFF) == 0));
+  }
+
+  // the entries of a gradient, the blend half way, the wrap around
+  const fx_palette_t* heat = &fx_palettes[FX_PALETTE_HEAT];
+  assert(fx_palette_color(heat, 0) == heat->colors[0]);
+  assert(fx_palette_color(heat, 5*16) == heat->colors[5]);
+  assert(fx_palette_color(heat, 256 + 16) == heat->colors[1]);
+  assert(fx_palette_color(heat, 8) == fx_blend(heat->colors[0],
+                                               heat->colors[1], 128));
+  assert(fx_blend(0x102030, 0x302010, 128) == 0x202020);
+  assert(fx_blend(0x102030, 0x302010, 0) == 0x102030);
+  assert(fx_blend(0x102030, 0x302010, FX_FULL) == 0x302010);
+  assert(fx_scale(0x80FF40, FX_FULL) == 0x80FF40);
+  assert(fx_scale(0x80FF40, FX_FULL/2) == 0x407F20);
+
+  // the brightness doubles its step with the excess
+  assert(fx_intensity(-3) == 0 && fx_intensity(0) == 0);
+  assert(fx_intensity(1) == 32 && fx_intensity(3) == 64);
+  assert(fx_intensity(127) == 224 && fx_intensity(128) == 255);
+  assert(fx_intensity(INT32_MAX) == 255);
+
+  // a cross-fade reaches the new colors exactly, a loud pixel in one frame
+  uint32_t shown[2] = { 0xFFFFFF, 0x000000 };
+  const uint32_t target[2] = { 0x000000, 0xFF8001 };
+  const uint8_t energy[2] = { 0, 255 };
+  fx_crossfade(shown, target, energy, 2, 16);
+  assert(shown[0] != 0 && shown[1] == target[1]);
+  for (int n=0; n<100 && shown[0] != 0; n++) {
+    fx_crossfade(shown, target, energy, 2, 16);
+  }
+  assert(shown[0] == 0);
+
+  // a gradient in the pipeline shades the tone's bucket by its level
+  sample_source_t src;
+  src_synth_ctx_t synth;
+  ain_frame_t frame;
+  viz_frame_t viz;
+  viz_config_t config;
+  src_tone_t tone = { BIN_HZ(12), 8000 };
+  viz_get_default_config(&config);
+  config.gradient = FX_PALETTE_OCEAN + 1;
+  assert(viz_set_config(&config) == 0);
+  src_synth_init(&src, &synth, &tone, 1, 1, 1);
+  src_get_frame(&src, &frame);
+  viz_process(&frame, &viz);
+  int32_t excess = viz.peaks[0].mags[4] - config.thresh[4];
+  uint32_t level = fx_intensity(excess) + 1;
+  for (int i=0; i<NUM_PIXELS; i++) {
+    assert(viz.colors[i] == (i == 4 ?
+        fx_scale(fx_palette_color(&fx_palettes[FX_PALETTE_OCEAN],
+                                  4*((256 - 16)/(NBUCKETS-1))), level) : 0));
+  }
+
+  // with a slow fade the pixel dims over a few frames once the tone stops
+  config.fade_rate = 32;
+  assert(viz_set_config(&config) == 0);
+  uint32_t lit = viz.colors[4];
+  src_synth_init(&src, &synth, NULL, 0, 1, 1);
+  src_get_frame(&src, &frame);
+  viz_process(&frame, &viz);
+  assert(viz.colors[4] != 0 && (viz.colors[4] & 0xFF) < (lit & 0xFF));
+
+  config.fade_rate = 0;
+  assert(viz_set_config(&config) == -1);
+  config.fade_rate = FX_FULL;
+  config.gradient = FX_NPALETTES + 1;
+  assert(viz_set_config(&config) == -1);
+  viz_get_default_config(&config);
+  assert(viz_set_config(&config) == 0);
+}
+
+// analyzes one mono frame of a tone, or of silence without one
+static void _viz_frame(const src_tone_t* tone, viz_frame_t* viz) {
+  sample_source_t src;
+  src_synth_ctx_t synth;
+  ain_frame_t frame;
+  src_synth_init(&src, &synth, tone, tone != NULL, 1, 1);
+  src_get_frame(&src, &frame);
+  assert(viz_process(&frame, viz) == 0);
+}
+
+static void test_viz_modes() {
+
+  viz_frame_t viz;
+  viz_config_t config;
+  const src_tone_t bass = { BIN_HZ(3), 12000 };
+  const src_tone_t tone = { BIN_HZ(12), 8000 };
+
+  for (int i=0; i<VIZ_NMODES; i++) {
+    assert(viz_find_mode(viz_modes[i].name) == i);
+  }
+  assert(viz_find_mode("disco") == -1);
+
+  // a beat flashes the whole strip in the bass bucket's color, which dies
+  // away
+  viz_get_default_config(&config);
+  config.mode = VIZ_MODE_PULSE;
+  assert(viz_set_config(&config) == 0);
+  for (int i=0; i<30; i++) {
+    _viz_frame(NULL, &viz);
+  }
+  _viz_frame(&bass, &viz);
+  assert(viz.beat.is_beat);
+  for (int i=0; i<NUM_PIXELS; i++) {
+    assert(viz.colors[i] == config.palette[1]);
+  }
+  _viz_frame(&bass, &viz);
+  assert(viz.colors[0] != 0 && viz.colors[0] != config.palette[1] &&
+         viz.colors[NUM_PIXELS-1] == viz.colors[0]);
+
+  // a beat starts a ring at the bass bucket's pixel, which then spreads
+  config.mode = VIZ_MODE_RIPPLE;
+  assert(viz_set_config(&config) == 0);
+  for (int i=0; i<30; i++) {
+    _viz_frame(NULL, &viz);
+  }
+  _viz_frame(&bass, &viz);
+  assert(viz.beat.is_beat);
+  for (int i=0; i<NUM_PIXELS; i++) {
+    assert((viz.colors[i] != 0) == (i == 1));
+  }
+  _viz_frame(&bass, &viz);
+  for (int i=0; i<NUM_PIXELS; i++) {
+    assert((viz.colors[i] != 0) == (i == 0 || i == 2));
+  }
+
+  // the meter starts green and fills further for a louder sound, then holds
+  // its peak after the sound stops
+  config.mode = VIZ_MODE_VU;
+  assert(viz_set_config(&config) == 0);
+  _viz_frame(&tone, &viz);
+  assert(viz.colors[0] >> 8 == 0x02FF && viz.colors[NUM_PIXELS-1] == 0);
+  uint32_t nlit = 0;
+  while (nlit < NUM_PIXELS && viz.colors[nlit] != 0) nlit++;
+  assert(nlit > 2);
+  _viz_frame(NULL, &viz);
+  for (uint32_t i=0; i<NUM_PIXELS; i++) {
+    assert((viz.colors[i] != 0) == (i == nlit-1));
+  }
+
+  // silence leaves the fire and the wheel dark, a sound lights them
+  config.mode = VIZ_MODE_FIRE;
+  assert(viz_set_config(&config) == 0);
+  for (int i=0; i<NUM_PIXELS*4; i++) {
+    _viz_frame(NULL, &viz);
+  }
+  for (int i=0; i<NUM_PIXELS; i++) {
+    assert(viz.colors[i] == 0);
+  }
+  _viz_frame(&bass, &viz);
+  assert(viz.colors[0] != 0 || viz.colors[1] != 0);
+  config.mode = VIZ_MODE_WHEEL;
+  assert(viz_set_config(&config) == 0);
+  _viz_frame(NULL, &viz);
+  assert(viz.colors[0] == 0);
+  _viz_frame(&tone, &viz);
+  assert(viz.colors[0] != 0 && viz.colors[0] != viz.colors[NUM_PIXELS-1]);
+
+  // each mode counts the frames it drew
+  viz_mode_stats_t stats;
+  assert(viz_get_mode_stats(VIZ_MODE_WHEEL, &stats) == 0 && stats.count == 2);
+  assert(viz_get_mode_stats(VIZ_NMODES, &stats) == -1);
+
+  config.mode = VIZ_NMODES;
+  assert(viz_set_config(&config) == -1);
+  viz_get_default_config(&config);
+  assert(viz_set_config(&config) == 0);
+}
+
+int main() {
+  test_dsp(true);
+  test_memory_source();
+  test_wav_round_trip();
+  test_adpcm();
+  test_telemetry();
+  test_pipeline();
+  test_config_store();
+  test_pixl_encode();
+  test_effects();
+  test_viz_modes();
+  printf("all tests passed\n");
+  return 0;
+}
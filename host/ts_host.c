@@ -0,0 +1,30 @@
+/* -----------------------------------------------------------------------------
+ * ts_host.c - The timestamp counter of timestamp.h on Linux (host only)
+ *
+ * Counts TS_TICKS_PER_SEC ticks from CLOCK_MONOTONIC, so the profiled
+ * stages (see profile.h) of the host build are timed in the same units as
+ * on target. Not linked into fw_sim, which runs the firmware's own TPM2
+ * counter.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <time.h>
+#include "timestamp.h"
+
+// see timestamp.h for more details
+uint32_t ts_now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)((uint64_t)ts.tv_sec*TS_TICKS_PER_SEC +
+                    (uint64_t)ts.tv_nsec*TS_TICKS_PER_US/1000);
+}
+
+// see timestamp.h for more details
+uint32_t ts_elapsed(uint32_t since) {
+  return ts_now() - since;
+}
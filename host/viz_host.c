@@ -0,0 +1,194 @@
+/* -----------------------------------------------------------------------------
+ * viz_host.c - Runs the visualizer pipeline on Linux
+ *
+ * Feeds frames from a WAV file or a synthetic signal through the same
+ * analysis and LED mapping code as the target and prints the pixel colors
+ * of every frame, followed by how many times faster than realtime the
+ * pipeline ran and, with -p, the time taken by the mode and by each stage
+ * (see profile.h).
+ * With -i the frames are also drawn into a PPM image, one row per frame and
+ * a block of IMAGE_SCALE columns per pixel, to look at the effects.
+ *
+ *   usage: viz_host [-c channels] [-n frames] [-b] [-q] [-p] [-m mode]
+ *                   [-g gradient] [-f rate] [-i image.ppm] SOURCE
+ *     SOURCE  a 16-bit 48 kHz WAV file, or synth:F[,F...] for sine tones at
+ *             the given frequencies in Hz
+ *     -c      channels fed to the pipeline (default AIN_NUM_CHANNELS)
+ *     -n      stop after this many frames (default all, synth: 1000)
+ *     -b      use the balance view for multi-channel frames
+ *     -q      only print the summary
+ *     -p      print the stage timings (builds with PROFILE, the default)
+ *     -m      draw the frames in this mode (see viz_modes.h), by name
+ *     -g      color the pixels from a gradient, 1 to FX_NPALETTES (see
+ *             viz_config_t.gradient)
+ *     -f      cross-fade the colors at this rate, 1 to 256 (see
+ *             viz_config_t.fade_rate)
+ *     -i      write the frames to this PPM image
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "timestamp.h"
+#include "sample_source.h"
+#include "visualizer.h"
+#include "viz_modes.h"
+#include "src_host.h"
+#include "profile.h"
+
+#define SYNTH_DEFAULT_FRAMES (1000)
+#define IMAGE_SCALE          (8)   // image columns per pixel
+
+static double _now_sec() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+static void _usage() {
+  fprintf(stderr, "usage: viz_host [-c channels] [-n frames] [-b] [-q] "
+          "[-p] [-m mode] [-g gradient] [-f rate] [-i image.ppm] "
+          "(FILE.wav | synth:F[,F...])\n");
+  exit(2);
+}
+
+// the header of a PPM image of nrows frames, padded so that it can be
+// rewritten in place once the number of frames is known
+static void _write_image_header(FILE* image, uint32_t nrows) {
+  fprintf(image, "P6\n%u %-10u\n255\n", NUM_PIXELS*IMAGE_SCALE, nrows);
+}
+
+// appends a frame to the image as one row
+static void _write_image_row(FILE* image, const uint32_t* colors) {
+  for (int i=0; i<NUM_PIXELS; i++) {
+    uint8_t rgb[3] = { colors[i] >> 16, colors[i] >> 8, colors[i] };
+    for (int j=0; j<IMAGE_SCALE; j++) {
+      fwrite(rgb, 1, sizeof(rgb), image);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+
+  uint32_t nchannels = AIN_NUM_CHANNELS;
+  uint32_t max_frames = 0;
+  bool is_quiet = false;
+  bool is_profiling = false;
+  const char* image_path = NULL;
+  viz_config_t config;
+  int opt;
+
+  viz_get_default_config(&config);
+  while ((opt = getopt(argc, argv, "c:n:bqpm:g:f:i:")) != -1) {
+    switch (opt) {
+      case 'c': nchannels = atoi(optarg); break;
+      case 'n': max_frames = atoi(optarg); break;
+      case 'b': config.stereo_view = VIZ_STEREO_BALANCE; break;
+      case 'q': is_quiet = true; break;
+      case 'p': is_profiling = true; break;
+      case 'm':
+        if (viz_find_mode(optarg) < 0) _usage();
+        config.mode = viz_find_mode(optarg);
+        break;
+      case 'g': config.gradient = atoi(optarg); break;
+      case 'f': config.fade_rate = atoi(optarg); break;
+      case 'i': image_path = optarg; break;
+      default: _usage();
+    }
+  }
+  if (optind != argc-1 || nchannels < 1 || nchannels > AIN_NUM_CHANNELS ||
+      viz_set_config(&config)) {
+    _usage();
+  }
+
+  FILE* image = NULL;
+  if (image_path != NULL) {
+    image = fopen(image_path, "wb");
+    if (image == NULL) {
+      perror(image_path);
+      return 1;
+    }
+    _write_image_header(image, 0);
+  }
+
+  sample_source_t src;
+  src_host_ctx_t ctx;
+  const char* spec = argv[optind];
+
+  if (max_frames == 0 && !strncmp(spec, "synth:", 6)) {
+    max_frames = SYNTH_DEFAULT_FRAMES;
+  }
+  if (src_host_open(&src, &ctx, spec, nchannels, max_frames)) {
+    return 1;
+  }
+
+  ain_frame_t frame;
+  viz_frame_t viz;
+  uint32_t nframes = 0;
+  double t_start = _now_sec();
+
+  while (src_is_avail(&src) && (max_frames == 0 || nframes < max_frames)) {
+    PROF_START(t_handoff);
+    if (src_get_frame(&src, &frame)) break;
+    PROF_LAP(t_handoff, PROF_HANDOFF);
+    if (viz_process(&frame, &viz)) break;
+    nframes++;
+    if (image != NULL) _write_image_row(image, viz.colors);
+
+    if (!is_quiet) {
+      printf("%6u %9.3f", frame.seq,
+             (double)frame.t_capture/TS_TICKS_PER_SEC);
+      for (int i=0; i<NUM_PIXELS; i++) {
+        if (viz.colors[i]) {
+          printf(" %06x", viz.colors[i]);
+        } else {
+          printf(" ......");
+        }
+      }
+      printf("\n");
+    }
+  }
+
+  double t_wall = _now_sec() - t_start;
+  double t_audio = (double)nframes*AIN_FRAME_SAMPLES/SRC_SAMPLE_RATE;
+
+  src_host_close(&ctx);
+
+  if (image != NULL) {
+    rewind(image);
+    _write_image_header(image, nframes);
+    fclose(image);
+  }
+
+  fprintf(stderr, "%u frames, %.2f s of audio in %.3f s: %.0fx realtime, "
+          "%.1f us per frame\n", nframes, t_audio, t_wall,
+          t_wall > 0 ? t_audio/t_wall : 0.0,
+          nframes ? t_wall*1e6/nframes : 0.0);
+
+  if (is_profiling) {
+    viz_mode_stats_t stats;
+    viz_get_mode_stats(config.mode, &stats);
+    fprintf(stderr, "viz: %s, %.2f us per frame mean, %.2f max, %u bytes\n",
+            viz_modes[config.mode].name,
+            stats.count ? (double)stats.sum_ticks/stats.count/TS_TICKS_PER_US
+                        : 0.0,
+            (double)stats.max_ticks/TS_TICKS_PER_US,
+            viz_modes[config.mode].ram_bytes);
+#ifdef PROFILE
+    prof_report();
+#else
+    fprintf(stderr, "viz_host: built without PROFILE\n");
+#endif
+  }
+
+  return 0;
+}
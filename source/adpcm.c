@@ -0,0 +1,144 @@
+/* -----------------------------------------------------------------------------
+ * adpcm.c - IMA ADPCM compression of captured samples (4 bits per sample)
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "adpcm.h"
+
+#define MAX_INDEX    (88)
+#define SIGN_BIT     (0x8)
+#define SAMPLE_BIAS  (0x8000)   // unsigned samples are centered here
+
+// the IMA ADPCM step sizes
+static const int16_t step_table[MAX_INDEX+1] = {
+      7,     8,     9,    10,    11,    12,    13,    14,    16,    17,
+     19,    21,    23,    25,    28,    31,    34,    37,    41,    45,
+     50,    55,    60,    66,    73,    80,    88,    97,   107,   118,
+    130,   143,   157,   173,   190,   209,   230,   253,   279,   307,
+    337,   371,   408,   449,   494,   544,   598,   658,   724,   796,
+    876,   963,  1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+   2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,
+   5894,  6484,  7132,  7845,  8630,  9493, 10442, 11487, 12635, 13899,
+  15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+// how each code moves the step size
+static const int8_t index_table[8] = { -1, -1, -1, -1, 2, 4, 6, 8 };
+
+// applies a code to the state exactly as the decoder will
+static inline void _update(adpcm_state_t* state, uint32_t code) {
+
+  int32_t step = step_table[state->index];
+  int32_t delta = step >> 3;
+  if (code & 4) delta += step;
+  if (code & 2) delta += step >> 1;
+  if (code & 1) delta += step >> 2;
+
+  int32_t predicted = state->predicted + ((code & SIGN_BIT) ? -delta : delta);
+  if (predicted > INT16_MAX) predicted = INT16_MAX;
+  if (predicted < INT16_MIN) predicted = INT16_MIN;
+  state->predicted = predicted;
+
+  int32_t index = state->index + index_table[code & 7];
+  if (index < 0) index = 0;
+  if (index > MAX_INDEX) index = MAX_INDEX;
+  state->index = index;
+}
+
+// the code that brings the prediction closest to sample
+static inline uint32_t _encode(adpcm_state_t* state, uint16_t sample) {
+
+  int32_t diff = (int32_t)sample - SAMPLE_BIAS - state->predicted;
+  int32_t step = step_table[state->index];
+  uint32_t code = 0;
+
+  if (diff < 0) {
+    code = SIGN_BIT;
+    diff = -diff;
+  }
+  if (diff >= step) {
+    code |= 4;
+    diff -= step;
+  }
+  step >>= 1;
+  if (diff >= step) {
+    code |= 2;
+    diff -= step;
+  }
+  step >>= 1;
+  if (diff >= step) {
+    code |= 1;
+  }
+
+  _update(state, code);
+  return code;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+// see .h for more details
+void adpcm_init(adpcm_state_t* state) {
+  if (state == NULL) return;
+  state->predicted = 0;
+  state->index = 0;
+  state->reserved = 0;
+}
+
+// see .h for more details
+uint32_t adpcm_encode(adpcm_state_t* state, const uint16_t* samples,
+                      uint32_t nsamples, uint32_t stride, uint8_t* dest) {
+
+  // error case
+  if (state == NULL || samples == NULL || dest == NULL || nsamples & 1 ||
+      stride < 1) {
+    return 0;
+  }
+
+  memcpy(dest, state, sizeof(adpcm_state_t));
+  uint8_t* out = dest + sizeof(adpcm_state_t);
+
+  for (uint32_t i=0; i<nsamples; i+=2) {
+    uint32_t lo = _encode(state, *samples);
+    samples += stride;
+    uint32_t hi = _encode(state, *samples);
+    samples += stride;
+    *out++ = lo | (hi << 4);
+  }
+
+  return ADPCM_BLOCK_BYTES(nsamples);
+}
+
+// see .h for more details
+int adpcm_decode(const uint8_t* block, uint32_t nsamples, uint16_t* dest,
+                 uint32_t stride) {
+
+  adpcm_state_t state;
+
+  // error case
+  if (block == NULL || dest == NULL || nsamples & 1 || stride < 1) {
+    return -1;
+  }
+  memcpy(&state, block, sizeof(adpcm_state_t));
+  if (state.index > MAX_INDEX) return -1;
+
+  const uint8_t* in = block + sizeof(adpcm_state_t);
+  for (uint32_t i=0; i<nsamples; i++) {
+    uint32_t code = (i & 1) ? (*in++ >> 4) : (*in & 0xF);
+    _update(&state, code);
+    *dest = (uint16_t)(state.predicted + SAMPLE_BIAS);
+    dest += stride;
+  }
+
+  return 0;
+}
@@ -0,0 +1,75 @@
+/* -----------------------------------------------------------------------------
+ * adpcm.h - IMA ADPCM compression of captured samples (4 bits per sample)
+ *
+ * The standard IMA ADPCM coder in integer arithmetic: each sample becomes a
+ * 4-bit code for the difference to a prediction, scaled by an adaptive step
+ * size, so 16-bit samples shrink 4:1. A frame is coded as a block that starts
+ * with the coder state, so every block decodes on its own even when the
+ * blocks before it were lost. Samples are in the analog_input format
+ * (unsigned, centered on 0x8000).
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _ADPCM_H_
+#define _ADPCM_H_
+
+#include <stdint.h>
+
+// the coder state, stored (little endian) at the start of every block
+typedef struct {
+  int16_t predicted;  // the last reconstructed sample, signed
+  uint8_t index;      // index into the step size table, 0 to 88
+  uint8_t reserved;
+} adpcm_state_t;
+
+// bytes of a block coding nsamples samples (nsamples must be even)
+#define ADPCM_BLOCK_BYTES(nsamples)  (sizeof(adpcm_state_t) + (nsamples)/2)
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+/*
+ * @brief   Puts a coder in its initial state (silence, smallest step)
+ *
+ * @param   state, the coder state
+ * @return  none
+ */
+void adpcm_init(adpcm_state_t* state);
+
+/*
+ * @brief   Codes one channel of interleaved samples as a block
+ *
+ * The block starts with the state on entry, followed by two codes per byte
+ * (the first sample in the low nibble). The state carries over to the next
+ * block.
+ *
+ * @param   state, the encoder state
+ *          samples, the first sample of the channel
+ *          nsamples, the number of samples to code, must be even
+ *          stride, the distance between two samples of the channel
+ *          dest, ADPCM_BLOCK_BYTES(nsamples) bytes for the block
+ * @return  uint32_t, the number of bytes written, 0 on error
+ */
+uint32_t adpcm_encode(adpcm_state_t* state, const uint16_t* samples,
+                      uint32_t nsamples, uint32_t stride, uint8_t* dest);
+
+/*
+ * @brief   Decodes a block made by adpcm_encode()
+ *
+ * @param   block, the block, starting with its coder state
+ *          nsamples, the number of samples in the block, must be even
+ *          dest, the first sample of the channel to write
+ *          stride, the distance between two samples of the channel
+ * @return  0 on success, -1 if the block's state is invalid
+ */
+int adpcm_decode(const uint8_t* block, uint32_t nsamples, uint16_t* dest,
+                 uint32_t stride);
+
+#endif // _ADPCM_H_
@@ -13,8 +13,13 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <inttypes.h>
 #include "MKL25Z4.h"
 #include "analog_input.h"
+#include "events.h"
+#include "timestamp.h"
+#include "sample_source.h"
+#include "log_console.h"
 
 #define START_CRITICAL_SECTION \
           uint32_t masking_state = __get_PRIMASK(); \
@@ -24,15 +29,45 @@
           __set_PRIMASK(masking_state)
 
 #define ADC_SAMPLING_FREQ  (48000U) // in Hz
-#define ADC_MAX_SAMPLES    (512)  
+#define ADC_MAX_SAMPLES    (AIN_FRAME_SAMPLES)
+#define ADC_BUF_SAMPLES    (ADC_MAX_SAMPLES*AIN_NUM_CHANNELS)
+// timestamp ticks per ADC sample is 3 MHz / 48 kHz = 62.5, kept as a ratio
+#define TICKS_PER_SAMPLE_NUM  (TS_TICKS_PER_SEC/1000)
+#define TICKS_PER_SAMPLE_DEN  (ADC_SAMPLING_FREQ/1000)
 
 
 // use a ping-pong buffer approach
-static uint16_t adc_samplesA[ADC_MAX_SAMPLES];
-static uint16_t adc_samplesB[ADC_MAX_SAMPLES];
+static uint16_t adc_samplesA[ADC_BUF_SAMPLES];
+static uint16_t adc_samplesB[ADC_BUF_SAMPLES];
 // the status flags
 static volatile bool is_adc_samplesA_recording;
 static volatile bool is_adc_samples_avail;
+#if AIN_NUM_CHANNELS != 1 && AIN_NUM_CHANNELS != 2 && AIN_NUM_CHANNELS != 4
+#error "AIN_NUM_CHANNELS must be 1, 2 or 4"
+#endif
+
+// the ADC0 single ended inputs, in capture order
+static const uint8_t adc_channels[4] = {
+    14, // PTC0
+    15, // PTC1
+    11, // PTC2
+    12  // PTB2
+};
+
+#if AIN_NUM_CHANNELS > 1
+// the SC1A value for the conversion following each DMA0 transfer. DMA2 reads
+// this as a 16 byte circular buffer (SMOD), which must be 16 byte aligned.
+#define MUX_SEQ_LEN  (4)
+static uint32_t adc_mux_seq[MUX_SEQ_LEN] __attribute__((aligned(16)));
+#endif
+
+// frame metadata, written by DMA0_IRQHandler
+static volatile uint32_t adc_frame_seq;
+static volatile uint32_t adc_t_capture;
+// sample clock bookkeeping for ain_get_frame()
+static uint32_t adc_t_origin;
+static uint64_t adc_elapsed_ticks;
+static uint32_t adc_next_sample_idx;
 
 // see .h for more details
 void ain_init() {
@@ -45,8 +80,12 @@ void ain_init() {
   // samplesA is recording first according to DMA config
   is_adc_samplesA_recording = true;
   is_adc_samples_avail = false;
+  adc_frame_seq = 0;
+  adc_elapsed_ticks = 0;
+  adc_next_sample_idx = 0;
   
   // turn on the TPM0 timer - to kick DMA0
+  adc_t_origin = ts_now();
   TPM0->SC |= TPM_SC_CMOD(1);
 }
 
@@ -57,6 +96,42 @@ bool ain_is_adc_samples_avail() {
 }
 
 
+// see .h for more details
+int ain_get_frame(ain_frame_t* frame) {
+
+  // error case
+  if (frame == NULL || !is_adc_samples_avail) {
+    return -1;
+  }
+
+  // latch the metadata before the buffer is handed back (which re-arms DMA0)
+  uint32_t t_capture = adc_t_capture;
+  frame->nchannels = AIN_NUM_CHANNELS;
+  frame->seq = adc_frame_seq;
+  frame->t_capture = t_capture;
+  frame->samples = ain_get_samples();
+
+  // TPM0 triggers the ADC continuously, so the index of the last sample
+  // follows from the time elapsed since the trigger was started. The 64-bit
+  // accumulator keeps this monotonic across wraps of the 32-bit timestamp.
+  adc_elapsed_ticks += (uint32_t)(t_capture - adc_t_origin);
+  adc_t_origin = t_capture;
+  uint32_t last_idx = (uint32_t)((adc_elapsed_ticks*TICKS_PER_SAMPLE_DEN)/
+                                  TICKS_PER_SAMPLE_NUM);
+  uint32_t first_idx = last_idx - (ADC_MAX_SAMPLES-1);
+
+  // the very first frame sets the reference; afterwards any samples between
+  // the end of the previous frame and the start of this one were missed
+  frame->samples_missed = 0;
+  if (frame->seq > 1 && first_idx > adc_next_sample_idx) {
+    frame->samples_missed = first_idx - adc_next_sample_idx;
+  }
+  frame->sample_idx = first_idx;
+  adc_next_sample_idx = last_idx + 1;
+
+  return 0;
+}
+
 // see .h for more details
 uint16_t* ain_get_samples() {
 
@@ -90,7 +165,13 @@ uint16_t* ain_get_samples() {
   is_adc_samples_avail = false;
 
   // re-start DMA0
-  DMA0->DMA[0].DSR_BCR |= DMA_DSR_BCR_BCR(2*ADC_MAX_SAMPLES);
+  DMA0->DMA[0].DSR_BCR |= DMA_DSR_BCR_BCR(2*ADC_BUF_SAMPLES);
+#if AIN_NUM_CHANNELS > 1
+  // reload the channel sequencer, its source address carries on circularly
+  // so the next transfer still lands on channel 0
+  DMA0->DMA[2].DSR_BCR |= DMA_DSR_BCR_DONE_MASK;
+  DMA0->DMA[2].DSR_BCR = DMA_DSR_BCR_BCR(4*ADC_BUF_SAMPLES);
+#endif
   DMA0->DMA[0].DCR |= DMA_DCR_ERQ_MASK;
 
   END_CRITICAL_SECTION;
@@ -99,12 +180,147 @@ uint16_t* ain_get_samples() {
   return process_buffer_return;
 }
 
+// the ADC backend of sample_source.h
+static bool _src_adc_is_avail(sample_source_t* src) {
+  return ain_is_adc_samples_avail();
+}
+
+static int _src_adc_get_frame(sample_source_t* src, ain_frame_t* frame) {
+  return ain_get_frame(frame);
+}
+
+// see sample_source.h for more details
+void src_adc_init(sample_source_t* src) {
+  if (src == NULL) return;
+  src->is_avail = _src_adc_is_avail;
+  src->get_frame = _src_adc_get_frame;
+  src->ctx = NULL;
+}
+
+// see .h for more details
+void ain_pause_capture() {
+
+  START_CRITICAL_SECTION;
+
+  // stop the sample trigger and the DMA transfer in progress
+  TPM0->SC &= ~TPM_SC_CMOD_MASK;
+  DMAMUX0->CHCFG[0] &= ~DMAMUX_CHCFG_ENBL_MASK;
+  DMA0->DMA[0].DCR &= ~DMA_DCR_ERQ_MASK;
+  DMA0->DMA[0].DSR_BCR |= DMA_DSR_BCR_DONE_MASK;
+  is_adc_samples_avail = false;
+
+  END_CRITICAL_SECTION;
+}
+
+// see .h for more details
+void ain_arm_sound_wake(uint16_t center, uint16_t threshold) {
+
+  START_CRITICAL_SECTION;
+
+  ain_pause_capture();
+
+  // the compare values are in 12-bit scale, clamp the window to the range
+  int32_t hi = ((int32_t)center + threshold) >> 4;
+  int32_t lo = ((int32_t)center - threshold) >> 4;
+  if (hi > 0xFFF) hi = 0xFFF;
+  if (lo < 0) lo = 0;
+
+  // pg. 466 datasheet
+  // use the asynchronous clock (ADACK ~2.4 MHz in low power) divided by 2
+  // sets to 12-bit single ended conversion with long sample time
+  ADC0->CFG1 = ADC_CFG1_ADICLK(3) | ADC_CFG1_ADIV(1) |
+               ADC_CFG1_MODE(1)   | ADC_CFG1_ADLPC(1) |
+               ADC_CFG1_ADLSMP(1);
+  ADC0->CFG2 = ADC_CFG2_ADACKEN(1);
+
+  // software trigger, compare outside of range inclusive (CV1 > CV2):
+  // a conversion only completes when result >= CV1 or result <= CV2
+  ADC0->CV1 = hi;
+  ADC0->CV2 = lo;
+  ADC0->SC2 = ADC_SC2_REFSEL(0) | ADC_SC2_ADTRG(0) |
+              ADC_SC2_ACFE(1)   | ADC_SC2_ACFGT(1) | ADC_SC2_ACREN(1) |
+              ADC_SC2_DMAEN(0);
+
+  // continuous conversions averaged over 4 samples give ~6 kHz compares
+  ADC0->SC3 = ADC_SC3_ADCO(1) | ADC_SC3_AVGE(1) | ADC_SC3_AVGS(0);
+
+  // configure the interrupt upon compare match, priority
+  NVIC_SetPriority(ADC0_IRQn, 2);
+  NVIC_ClearPendingIRQ(ADC0_IRQn);
+  NVIC_EnableIRQ(ADC0_IRQn);
+
+  // writing SC1A starts the conversions on SE14
+  ADC0->SC1[0] = ADC_SC1_ADCH(adc_channels[0]) | ADC_SC1_AIEN(1) |
+                 ADC_SC1_DIFF(0);
+
+  END_CRITICAL_SECTION;
+}
+
+// see .h for more details
+void ain_resume_capture() {
+
+  START_CRITICAL_SECTION;
+
+  NVIC_DisableIRQ(ADC0_IRQn);
+  _config_adc0_capture();
+
+  // record into samplesA from scratch
+  DMA0->DMA[0].DAR = DMA_DAR_DAR((uint32_t)&(adc_samplesA[0]));
+  DMA0->DMA[0].DSR_BCR = DMA_DSR_BCR_BCR(2*ADC_BUF_SAMPLES);
+#if AIN_NUM_CHANNELS > 1
+  // the sequence restarts at channel 0, see _config_adc0_capture()
+  DMA0->DMA[2].SAR = DMA_SAR_SAR((uint32_t)&(adc_mux_seq[0]));
+  DMA0->DMA[2].DSR_BCR |= DMA_DSR_BCR_DONE_MASK;
+  DMA0->DMA[2].DSR_BCR = DMA_DSR_BCR_BCR(4*ADC_BUF_SAMPLES);
+#endif
+  DMA0->DMA[0].DCR |= DMA_DCR_ERQ_MASK;
+  DMAMUX0->CHCFG[0] |= DMAMUX_CHCFG_ENBL_MASK;
+  is_adc_samplesA_recording = true;
+  is_adc_samples_avail = false;
+
+  // continue the sample index from the last captured frame
+  adc_t_origin = ts_now();
+  adc_elapsed_ticks = ((uint64_t)adc_next_sample_idx*TICKS_PER_SAMPLE_NUM)/
+                      TICKS_PER_SAMPLE_DEN;
+
+  // restart the sample trigger
+  TPM0->CNT = 0;
+  TPM0->SC |= TPM_SC_CMOD(1);
+
+  END_CRITICAL_SECTION;
+}
+
+// see .h for more details
+void ADC0_IRQHandler() {
+  // reading the result clears COCO
+  (void)ADC0->R[0];
+  // one shot: disable the module until capture is resumed
+  ADC0->SC1[0] = ADC_SC1_ADCH(31);
+  // wake the main loop
+  evt_post(EVT_SOUND_WAKE);
+}
+
 // see .h for more details 
 void DMA0_IRQHandler() {
   // clear done flag
   DMA0->DMA[0].DSR_BCR |= DMA_DSR_BCR_DONE_MASK;
+  // record when the frame completed
+  adc_t_capture = ts_now();
+  adc_frame_seq++;
+  // the main loop did not take the last frame in time, said once per run
+  // of frames missed
+  static bool is_miss_logged = false;
+  if (!is_adc_samples_avail) {
+    is_miss_logged = false;
+  } else if (!is_miss_logged) {
+    log_defer("ain: frames missed from %" PRIu32 "\r\n", adc_frame_seq-1,
+              0, 0);
+    is_miss_logged = true;
+  }
   // samples are now available
   is_adc_samples_avail = true;
+  // wake the main loop
+  evt_post(EVT_ADC_FRAME);
 }
 
 // see .h for more details
@@ -112,8 +328,8 @@ void _init_adc0() {
   // enable clock gating
   SIM->SCGC6 |= SIM_SCGC6_ADC0_MASK;
   // enable alternate trigger pg. 201
-  // select TPM0 as trigger
-  SIM->SOPT7  = SIM_SOPT7_ADC0ALTTRGEN(1) | SIM_SOPT7_ADC0TRGSEL(9);
+  // select TPM0 as trigger (1000 - TPM0 overflow, pg. 200)
+  SIM->SOPT7  = SIM_SOPT7_ADC0ALTTRGEN(1) | SIM_SOPT7_ADC0TRGSEL(8);
 
   // pg. 466 datasheet
   // use bus clock (24 MHz) and divide by 4
@@ -129,9 +345,10 @@ void _init_adc0() {
   ADC0->SC2 = ADC_SC2_REFSEL(0) |  ADC_SC2_ADTRG(0) |
               ADC_SC2_ACFE(0)   |  ADC_SC2_DMAEN(0);
 
-  // set adc0 input to SE14
+  // set adc0 input to the first channel (SE14)
   // AIEN and DIFF
-  ADC0->SC1[0] = ADC_SC1_ADCH(14) | ADC_SC1_AIEN(0) | ADC_SC1_DIFF(0);
+  ADC0->SC1[0] = ADC_SC1_ADCH(adc_channels[0]) | ADC_SC1_AIEN(0) |
+                 ADC_SC1_DIFF(0);
 
   // run calibration datasheet sec 28.4.6:
   // turn on averaging (32) temporarily for calibration sequence
@@ -160,6 +377,24 @@ void _init_adc0() {
   ADC0->SC2 |= ADC_SC2_ADTRG(1) | ADC_SC2_DMAEN(1);
 }
 
+// see .h for more details
+void _config_adc0_capture() {
+  // same clocking and 16-bit mode used during calibration in _init_adc0()
+  ADC0->CFG1  = ADC_CFG1_ADICLK(0) | ADC_CFG1_ADIV(2)  |
+                ADC_CFG1_MODE(3)   | ADC_CFG1_ADLPC(0) |
+                ADC_CFG1_ADLSMP(0);
+  ADC0->CFG2 = 0;
+  // no averaging or continuous conversions
+  ADC0->SC3 = 0;
+  // hardware triggering with dma request, compare disabled
+  ADC0->SC2 = ADC_SC2_REFSEL(0) |  ADC_SC2_ADTRG(1) |
+              ADC_SC2_ACFE(0)   |  ADC_SC2_DMAEN(1);
+  // set adc0 input to the first channel, no conversion starts in hardware
+  // trigger mode
+  ADC0->SC1[0] = ADC_SC1_ADCH(adc_channels[0]) | ADC_SC1_AIEN(0) |
+                 ADC_SC1_DIFF(0);
+}
+
 #define DMA_ADC0_COCO_TRIG  (40)
 // see .h for more details
 void _init_dma0() {
@@ -185,12 +420,18 @@ void _init_dma0() {
                        DMA_DCR_DSIZE(2)   |
                        DMA_DCR_D_REQ_MASK |
                        DMA_DCR_CS_MASK    );
+#if AIN_NUM_CHANNELS > 1
+  // LINKCC - link to LCH1 after each cycle steal transfer
+  // LCH1   - DMA2 selects the next ADC0 input channel
+  DMA0->DMA[0].DCR |= DMA_DCR_LINKCC(2) | DMA_DCR_LCH1(2);
+  _init_dma2();
+#endif
 
   // setup source from adc0, dest to adc_samples
   DMA0->DMA[0].SAR = DMA_SAR_SAR((uint32_t)&(ADC0->R[0]));
   DMA0->DMA[0].DAR = DMA_DAR_DAR((uint32_t)&(adc_samplesA[0]));
-  // load BCR with ADC_MAX_SAMPLES*2 bytes (16-bits) per transfer 
-  DMA0->DMA[0].DSR_BCR |= DMA_DSR_BCR_BCR(2*ADC_MAX_SAMPLES);
+  // load BCR with ADC_BUF_SAMPLES*2 bytes (16-bits) per transfer 
+  DMA0->DMA[0].DSR_BCR |= DMA_DSR_BCR_BCR(2*ADC_BUF_SAMPLES);
   
   // configure the interrupt upon transfer complete, priority 
   NVIC_SetPriority(DMA0_IRQn, 2);
@@ -203,6 +444,37 @@ void _init_dma0() {
 }
 
 
+#if AIN_NUM_CHANNELS > 1
+// see .h for more details
+void _init_dma2() {
+
+  // after converting entry i of the sequence, convert entry i+1 next
+  for (int i=0; i<MUX_SEQ_LEN; i++) {
+    adc_mux_seq[i] = ADC_SC1_ADCH(adc_channels[(i+1)%AIN_NUM_CHANNELS]) |
+                     ADC_SC1_AIEN(0) | ADC_SC1_DIFF(0);
+  }
+
+  // no peripheral request, DMA2 is only started through the link from DMA0
+  DMAMUX0->CHCFG[2] = 0;
+
+  // SINC  - Enable source increment after transfer
+  // SSIZE - sets source size to 32 bits
+  // DSIZE - sets destination size to 32 bits (ADC0 SC1A)
+  // SMOD  - wrap the source address on a 16 byte boundary
+  // CS    - force single read/write per request (cycle steal)
+  DMA0->DMA[2].DCR = ( DMA_DCR_SINC_MASK  |
+                       DMA_DCR_SSIZE(0)   |
+                       DMA_DCR_DSIZE(0)   |
+                       DMA_DCR_SMOD(1)    |
+                       DMA_DCR_CS_MASK    );
+
+  DMA0->DMA[2].SAR = DMA_SAR_SAR((uint32_t)&(adc_mux_seq[0]));
+  DMA0->DMA[2].DAR = DMA_DAR_DAR((uint32_t)&(ADC0->SC1[0]));
+  // one 4 byte transfer per ADC sample
+  DMA0->DMA[2].DSR_BCR = DMA_DSR_BCR_BCR(4*ADC_BUF_SAMPLES);
+}
+#endif
+
 #define TPM0_CLK_INPUT_FREQ (48000000UL) // 48 MHz
 // see .h for more details 
 void _init_tpm0() {
@@ -220,7 +492,8 @@ void _init_tpm0() {
   // KL25Z datasheet sec. 31.3.7
   TPM0->CONF |= TPM_CONF_DBGMODE(0b11);
   // set the overflow - KL25Z datasheet sec. 31.3.3
-  TPM0->MOD = TPM0_CLK_INPUT_FREQ/ADC_SAMPLING_FREQ - 1;
+  // each channel is sampled at ADC_SAMPLING_FREQ
+  TPM0->MOD = TPM0_CLK_INPUT_FREQ/(ADC_SAMPLING_FREQ*AIN_NUM_CHANNELS) - 1;
   // clear counter 
   TPM0->CNT = 0;
   // note: TPM0 will be started when reading samples
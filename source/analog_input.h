@@ -13,6 +13,27 @@
 #define _ANALOG_INPUT_H_
 
 #include <stdint.h>
+#include <stdbool.h>
+
+#define AIN_FRAME_SAMPLES  (512)  // samples per channel per captured frame
+
+// number of interleaved ADC channels captured per frame: 1, 2 or 4
+// the channels are SE14 (PTC0), SE15 (PTC1), SE11 (PTC2) and SE12 (PTB2)
+#ifndef AIN_NUM_CHANNELS
+#define AIN_NUM_CHANNELS   (1)
+#endif
+
+// a captured frame of ADC samples and when it was recorded
+typedef struct {
+  uint16_t* samples;        // the interleaved sample buffer, holding
+                            // AIN_FRAME_SAMPLES*nchannels samples with
+                            // sample i of channel ch at [i*nchannels+ch]
+  uint32_t nchannels;       // number of interleaved channels
+  uint32_t seq;             // sequence number, incremented per captured frame
+  uint32_t sample_idx;      // index of samples[0] counted from ain_init()
+  uint32_t samples_missed;  // samples not captured since the previous frame
+  uint32_t t_capture;       // timestamp of the last sample (see timestamp.h)
+} ain_frame_t;
 
 /* 
  * -----------------------------------------------------------------------------
@@ -29,12 +50,29 @@
  * returned is safe to modify or process until the next call to ain_get_samples()
  * at which point it will be overwritten. 
  *
+ * With AIN_NUM_CHANNELS > 1 the buffer holds the channels interleaved, see
+ * ain_frame_t.
+ *
  * @param  none
- * @return uint16_t*, an ADC sample buffer with length 512 samples 
+ * @return uint16_t*, an ADC sample buffer with length 512 samples per channel
  *                    NULL if adc samples are not available 
  */
 uint16_t* ain_get_samples();
 
+/*
+ * @brief  Returns the most recent frame of ADC samples with its metadata
+ *
+ * Behaves exactly like ain_get_samples() but additionally reports the frame
+ * sequence number, the monotonic index of its first sample and the time its
+ * capture completed. Samples arriving while no buffer is armed (i.e. between
+ * a frame completing and the next call) are not recorded; samples_missed
+ * reports how many were lost so gaps in the sample stream can be detected.
+ *
+ * @param  frame, destination for the frame and its metadata
+ * @return 0 on success, -1 if samples are not available or frame is NULL
+ */
+int ain_get_frame(ain_frame_t* frame);
+
 /*
  * @brief   Returns boolean indicating whether samples are available 
  *
@@ -44,6 +82,45 @@ uint16_t* ain_get_samples();
  */
 bool ain_is_adc_samples_avail();
 
+/*
+ * @brief   Stops full rate capture until ain_resume_capture()
+ *
+ * TPM0 and DMA0 are stopped, so nothing is overrun while the core cannot
+ * service the ADC (e.g. during a flash erase).
+ *
+ * @param   none
+ * @return  none
+ */
+void ain_pause_capture();
+
+/*
+ * @brief   Stops full rate capture and arms ADC0 to detect a loud sample
+ *
+ * TPM0 and DMA0 are stopped and ADC0 is switched to low power continuous
+ * conversions on its asynchronous clock (ADACK), which keeps running in the
+ * VLPS/STOP modes. The hardware compare function only completes a conversion
+ * when the sample is outside of center +/- threshold, at which point the
+ * ADC0 interrupt posts EVT_SOUND_WAKE and disarms the compare.
+ *
+ * @param   center, the DC level of the microphone signal (16-bit scale)
+ *          threshold, the amplitude from center that wakes (16-bit scale)
+ * @return  none
+ */
+void ain_arm_sound_wake(uint16_t center, uint16_t threshold);
+
+/*
+ * @brief   Restores full rate capture after ain_pause_capture() or
+ *          ain_arm_sound_wake()
+ *
+ * ADC0 is put back in its hardware triggered 16-bit configuration and a new
+ * frame is recorded from scratch. The sample index carries on from where it
+ * stopped, so the idle period is not reported as missed samples.
+ *
+ * @param   none
+ * @return  none
+ */
+void ain_resume_capture();
+
 /*
  * @brief   Initializes ADC0, DMA0, and TPM0 
  *
@@ -51,6 +128,10 @@ bool ain_is_adc_samples_avail();
  * triggered on ADC0 conversion completion to move the ADC data to one of the
  * two ping pong buffers (A or B) depending on which one was previously written 
  *
+ * With AIN_NUM_CHANNELS > 1, TPM0 overflows AIN_NUM_CHANNELS times faster and
+ * DMA2 is linked to DMA0 to select the next input channel after every
+ * conversion, so each channel is still sampled at ADC_SAMPLING_FREQ.
+ *
  * @param   none
  * @return  none
  */
@@ -74,6 +155,25 @@ void ain_init();
  */
 void _init_adc0();
 
+/*
+ * @brief   Configures ADC0 for full rate sampling via TPM0 overflow
+ *
+ * Restores the configuration set up by _init_adc0() after calibration, used
+ * when returning from the sound wake configuration.
+ *
+ * @param   none
+ * @return  none
+ */
+void _config_adc0_capture();
+
+/*
+ * @brief   The ADC0 IRQ handler, fires on a sound wake compare match
+ *
+ * @param   none
+ * @return  none
+ */
+void ADC0_IRQHandler();
+
 /*
  * @brief  Initializes DMA0 for sampling ADC0 via TPM0 overflow
  *
@@ -82,6 +182,18 @@ void _init_adc0();
  */
 void _init_dma0();
 
+/*
+ * @brief  Initializes DMA2 to step ADC0 through the capture channels
+ *
+ * Only used with AIN_NUM_CHANNELS > 1. DMA2 is started by a channel link
+ * after every DMA0 transfer and writes the next SC1A value from a circular
+ * sequence, so the next TPM0 trigger converts the next channel.
+ *
+ * @param   none
+ * @return  none
+ */
+void _init_dma2();
+
 /*
  * @brief   The DMA0 IRQ handler for automatically sampling ADC0 
  *
@@ -0,0 +1,45 @@
+/* -----------------------------------------------------------------------------
+ * button.c - A push button to step through the visualization modes
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "MKL25Z4.h"
+#include "button.h"
+
+#define BTN_PORT      (PORTA)
+#define BTN_GPIO      (GPIOA)
+#define BTN_PIN       (5)
+#define BTN_MUX_GPIO  (1)
+
+// the last polls, the newest in bit 0, 1 for pressed
+static uint32_t history;
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+// see .h for more details
+void btn_init() {
+  SIM->SCGC5 |= SIM_SCGC5_PORTA_MASK;
+  // GPIO with the pull-up enabled - KL25Z datasheet sec. 11.5.1
+  BTN_PORT->PCR[BTN_PIN] = PORT_PCR_MUX(BTN_MUX_GPIO) | PORT_PCR_PE_MASK |
+                           PORT_PCR_PS_MASK;
+  BTN_GPIO->PDDR &= ~(1UL << BTN_PIN);
+  history = 0;
+}
+
+// see .h for more details
+bool btn_poll() {
+  bool is_down = (BTN_GPIO->PDIR & (1UL << BTN_PIN)) == 0;
+  history = (history << 1) | is_down;
+  // released, then pressed twice
+  return (history & 0x7) == 0x3;
+}
@@ -0,0 +1,46 @@
+/* -----------------------------------------------------------------------------
+ * button.h - A push button to step through the visualization modes
+ *
+ * The FRDM-KL25Z has no user push button (SW1 is reset), so the button is
+ * wired between PTA5 (D5 on the Arduino header) and GND, with the pin's
+ * internal pull-up. The main loop polls it once per frame, about every
+ * 10.7 ms; a press counts once the pin has read low on two polls in a row
+ * after reading high, which rides over contact bounce without a timer or an
+ * interrupt.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _BUTTON_H_
+#define _BUTTON_H_
+
+#include <stdbool.h>
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+/*
+ * @brief   Configures the button pin as an input with a pull-up
+ *
+ * @param   none
+ * @return  none
+ */
+void btn_init();
+
+/*
+ * @brief   Samples the button
+ *
+ * Call once per frame from the main loop.
+ *
+ * @param   none
+ * @return  true once for each press
+ */
+bool btn_poll();
+
+#endif // _BUTTON_H_
@@ -0,0 +1,76 @@
+/* -----------------------------------------------------------------------------
+ * config.c - The tunable parameters of the pipeline, double-buffered
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+static config_t slots[2];
+static uint32_t active;       // the slot the pipeline reads
+static bool is_pending;       // the other slot holds committed parameters
+static config_t edit;         // the change being made
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+// see .h for more details
+void cfg_init() {
+  config_t* config = &slots[0];
+  viz_get_default_config(&config->viz);
+  config->idle_amplitude = 2000;
+  config->idle_enter_frames = 470;  // ~5 s of 512 sample frames at 48 kHz
+  config->wake_amplitude = 3000;
+  // the palette was tuned on a linear strip
+  config->brightness = PIXL_FULL_BRIGHTNESS;
+  config->is_gamma = false;
+  config->is_dithering = true;
+  active = 0;
+  is_pending = false;
+}
+
+// see .h for more details
+const config_t* cfg_begin_frame(bool* is_changed) {
+  if (is_changed != NULL) {
+    *is_changed = is_pending;
+  }
+  if (is_pending) {
+    active ^= 1;
+    is_pending = false;
+  }
+  return &slots[active];
+}
+
+// see .h for more details
+const config_t* cfg_get() {
+  return &slots[is_pending ? active^1 : active];
+}
+
+// see .h for more details
+config_t* cfg_edit() {
+  edit = *cfg_get();
+  return &edit;
+}
+
+// see .h for more details
+int cfg_commit() {
+  if (viz_check_config(&edit.viz) || edit.idle_amplitude == 0 ||
+      edit.idle_enter_frames == 0 ||
+      edit.wake_amplitude <= edit.idle_amplitude ||
+      edit.wake_amplitude > UINT16_MAX ||
+      edit.brightness > PIXL_FULL_BRIGHTNESS) {
+    return -1;
+  }
+  slots[active^1] = edit;
+  is_pending = true;
+  return 0;
+}
@@ -0,0 +1,93 @@
+/* -----------------------------------------------------------------------------
+ * config.h - The tunable parameters of the pipeline, double-buffered
+ *
+ * Everything that used to be a literal worth tuning (bucket edges,
+ * thresholds, gain, colors, FFT size, view and beat parameters, the idle
+ * mode levels and the LED output stage) sits in one config_t. The pipeline
+ * reads the active copy; changes are made to a second copy and only take
+ * effect when the main loop calls cfg_begin_frame() before analyzing the
+ * next frame, so a frame never sees half of an update, and making one never
+ * waits on the frame.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _CONFIG_H_
+#define _CONFIG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "visualizer.h"
+#include "pixl_encode.h"
+
+// all of the parameters
+typedef struct {
+  viz_config_t viz;
+  // sound activated idle mode:
+  uint32_t idle_amplitude;     // frames quieter than this are idle
+  uint32_t idle_enter_frames;  // idle frames in a row before sleeping
+  uint32_t wake_amplitude;     // a single sample this loud wakes up
+  // LED output stage (see tpm_pixl_set_output()):
+  uint32_t brightness;         // 0 to PIXL_FULL_BRIGHTNESS
+  bool is_gamma;               // gamma 2.2 on the colors
+  bool is_dithering;           // temporal dithering of the dim levels
+} config_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+/*
+ * @brief   Makes the defaults the active parameters
+ *
+ * @param   none
+ * @return  none
+ */
+void cfg_init();
+
+/*
+ * @brief   Switches to the last committed parameters, if any, for the frame
+ *          about to be analyzed
+ *
+ * Call from the main loop before each frame. The returned parameters stay
+ * unchanged until the next call.
+ *
+ * @param   is_changed, set true if the parameters changed (may be NULL)
+ * @return  const config_t*, the parameters for this frame
+ */
+const config_t* cfg_begin_frame(bool* is_changed);
+
+/*
+ * @brief   Returns the newest parameters, committed or active
+ *
+ * @param   none
+ * @return  const config_t*, valid until the next cfg_edit()
+ */
+const config_t* cfg_get();
+
+/*
+ * @brief   Starts a change, from a copy of the newest parameters
+ *
+ * Call from the main loop, not from interrupt handlers.
+ *
+ * @param   none
+ * @return  config_t*, the copy to change, then cfg_commit()
+ */
+config_t* cfg_edit();
+
+/*
+ * @brief   Checks the copy from cfg_edit() and has it take effect at the
+ *          next cfg_begin_frame()
+ *
+ * @param   none
+ * @return  0 on success, -1 if the parameters are invalid (the change is
+ *          discarded)
+ */
+int cfg_commit();
+
+#endif // _CONFIG_H_
@@ -0,0 +1,210 @@
+/* -----------------------------------------------------------------------------
+ * config_store.c - Keeps the tuned parameters in flash across power cycles
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "crc16.h"
+#include "config_store.h"
+
+#define NSECTORS          (STORE_FLASH_SIZE/STORE_SECTOR_SIZE)
+#define RECORD_WORDS      ((sizeof(store_header_t) + sizeof(config_t) + 3)/4)
+#define RECORD_BYTES      (RECORD_WORDS*4)
+#define SLOTS_PER_SECTOR  (STORE_SECTOR_SIZE/RECORD_BYTES)
+#define NSLOTS            (NSECTORS*SLOTS_PER_SECTOR)
+
+static store_flash_t* flash;
+
+// the record being programmed, as it will appear in flash
+static union {
+  struct {
+    store_header_t header;
+    config_t config;
+  } rec;
+  uint32_t words[RECORD_WORDS];
+} stage;
+static uint32_t stage_ndone;    // words programmed so far
+
+static uint32_t next_slot;      // where the staged (or next) record goes
+static store_status_t status;
+
+// offset of a slot in the region, records never straddle a sector
+static uint32_t _slot_offset(uint32_t slot) {
+  return (slot/SLOTS_PER_SECTOR)*STORE_SECTOR_SIZE +
+         (slot%SLOTS_PER_SECTOR)*RECORD_BYTES;
+}
+
+// returns the header in a slot if it is one of ours, or NULL
+static const store_header_t* _header_at(uint32_t slot) {
+  const store_header_t* header =
+      (const store_header_t*)(flash->base + _slot_offset(slot));
+  if (header->magic != STORE_MAGIC || header->version != STORE_VERSION ||
+      header->nbytes != sizeof(config_t)) {
+    return NULL;
+  }
+  return header;
+}
+
+// checks whether nbytes at offset are erased
+static bool _is_blank(uint32_t offset, uint32_t nbytes) {
+  const uint32_t* words = (const uint32_t*)(flash->base + offset);
+  for (uint32_t i=0; i<nbytes/4; i++) {
+    if (words[i] != 0xFFFFFFFFU) return false;
+  }
+  return true;
+}
+
+// the CRC of a record, over everything but the first two header words
+static uint16_t _record_crc(uint32_t seq, const config_t* config) {
+  uint16_t crc = crc16_update(CRC16_INIT, &seq, sizeof(seq));
+  return crc16_update(crc, config, sizeof(config_t));
+}
+
+// the first slot from slot on that can be programmed as is, or the first
+// slot of the next sector, which is erased first. Slots spoiled by a reset
+// or a failed save are passed over
+static uint32_t _free_slot(uint32_t slot) {
+  while (slot % SLOTS_PER_SECTOR != 0 &&
+         !_is_blank(_slot_offset(slot), RECORD_BYTES)) {
+    slot = (slot + 1) % NSLOTS;
+  }
+  return slot;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+// see .h for more details
+int store_init(store_flash_t* new_flash, config_t* config) {
+
+  flash = new_flash;
+  memset(&status, 0, sizeof(status));
+  stage_ndone = 0;
+
+  // find the newest record that checks out: only the headers are read,
+  // except when the newest has a bad CRC and an older one is tried
+  const store_header_t* loaded = NULL;
+  uint32_t seq_limit = UINT32_MAX;
+  bool is_first_pass = true;
+  next_slot = 0;
+
+  while (loaded == NULL) {
+    const store_header_t* newest = NULL;
+    uint32_t newest_slot = 0;
+    for (uint32_t slot=0; slot<NSLOTS; slot++) {
+      const store_header_t* header = _header_at(slot);
+      if (header != NULL && header->seq < seq_limit &&
+          (newest == NULL || header->seq > newest->seq)) {
+        newest = header;
+        newest_slot = slot;
+      }
+    }
+    if (newest == NULL) break;
+
+    // append after the newest record (see _free_slot())
+    if (is_first_pass) {
+      next_slot = (newest_slot + 1) % NSLOTS;
+      status.seq = newest->seq;
+      is_first_pass = false;
+    }
+
+    if (newest->crc == _record_crc(newest->seq,
+                                   (const config_t*)(newest + 1))) {
+      loaded = newest;
+    } else {
+      seq_limit = newest->seq;
+    }
+  }
+
+  if (loaded == NULL) return -1;
+  if (config != NULL) {
+    memcpy(config, loaded + 1, sizeof(config_t));
+  }
+  return 0;
+}
+
+// see .h for more details
+int store_save(const config_t* config) {
+
+  if (flash == NULL || config == NULL || status.nwords_left) return -1;
+
+  stage.rec.header.magic = STORE_MAGIC;
+  stage.rec.header.version = STORE_VERSION;
+  stage.rec.header.nbytes = sizeof(config_t);
+  stage.rec.header.seq = status.seq + 1;
+  stage.rec.config = *config;
+  stage.rec.header.crc = _record_crc(stage.rec.header.seq, config);
+
+  stage_ndone = 0;
+  status.nwords_left = RECORD_WORDS;
+  next_slot = _free_slot(next_slot);
+
+  // the first record of a sector erases what the ring left there
+  status.is_erase_due = next_slot % SLOTS_PER_SECTOR == 0 &&
+                        !_is_blank(_slot_offset(next_slot), STORE_SECTOR_SIZE);
+  return 0;
+}
+
+// see .h for more details
+bool store_is_erase_due() {
+  return status.is_erase_due;
+}
+
+// see .h for more details
+int store_erase() {
+
+  if (!status.is_erase_due) return 0;
+
+  status.is_erase_due = false;
+  if (flash->erase(flash, _slot_offset(next_slot))) {
+    status.nwords_left = 0;
+    return -1;
+  }
+  status.nerases++;
+  return 0;
+}
+
+// see .h for more details
+uint32_t store_service(uint32_t max_words) {
+
+  if (status.is_erase_due) return status.nwords_left;
+
+  uint32_t offset = _slot_offset(next_slot);
+
+  for (uint32_t n=0; n<max_words && status.nwords_left; n++) {
+
+    // the header word goes last, so a record is only valid once complete
+    uint32_t idx = (stage_ndone + 1) % RECORD_WORDS;
+    if (flash->program(flash, offset + idx*4, stage.words[idx])) {
+      // the slot is spoiled, the next save goes after it
+      status.nwords_left = 0;
+      next_slot = (next_slot + 1) % NSLOTS;
+      return 0;
+    }
+
+    stage_ndone++;
+    if (--status.nwords_left == 0) {
+      status.seq = stage.rec.header.seq;
+      status.nsaves++;
+      next_slot = (next_slot + 1) % NSLOTS;
+    }
+  }
+
+  return status.nwords_left;
+}
+
+// see .h for more details
+void store_get_status(store_status_t* dest) {
+  if (dest == NULL) return;
+  *dest = status;
+}
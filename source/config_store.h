@@ -0,0 +1,132 @@
+/* -----------------------------------------------------------------------------
+ * config_store.h - Keeps the tuned parameters in flash across power cycles
+ *
+ * The last 4 sectors of program flash hold a log of saved config_t records.
+ * Each save appends a whole record, with a sequence number and a CRC, to the
+ * next free slot; when a sector is full the next one around the ring is
+ * erased and used, so the erases are spread evenly over the sectors (6
+ * records of 152 bytes fit in a sector, a sector is erased once every 24
+ * saves). At boot
+ * the record with the highest sequence number that checks out is loaded:
+ * only the headers are read to find it, then one CRC, well under a
+ * millisecond. A record interrupted by a reset is never loaded, as its
+ * first word is programmed last and the CRC covers the rest; the previous
+ * record is loaded instead.
+ *
+ * A save is only staged by store_save(). The main loop programs it a few
+ * words at a time in the time left before the next frame (store_service()),
+ * after the recording (see flash_rec.h) has had its turn. A sector erase
+ * takes longer than a frame and masks interrupts, so when one is due the
+ * main loop pauses capture around store_erase().
+ *
+ * The flash is reached through a store_flash_t, which flash_rec.c provides
+ * on target and the host tests back with an array.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _CONFIG_STORE_H_
+#define _CONFIG_STORE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+#define STORE_FLASH_START  (0x1F000U)  // must match the linker memory map
+#define STORE_FLASH_SIZE   (0x1000U)   // 4 sectors of 1 KB
+#define STORE_SECTOR_SIZE  (1024U)
+#define STORE_MAGIC        (0xC0F6)
+#define STORE_VERSION      (4)         // bump when config_t changes
+
+typedef struct store_flash store_flash_t;
+
+// access to the flash region, filled in by the backend
+struct store_flash {
+  const uint8_t* base;    // the region, readable through plain pointers
+  int (*erase)(store_flash_t* flash, uint32_t offset);      // one sector
+  int (*program)(store_flash_t* flash, uint32_t offset, uint32_t word);
+  void* ctx;              // backend state
+};
+
+// a record in flash, followed by the config_t
+typedef struct {
+  uint16_t magic;         // STORE_MAGIC, erased (0xFFFF) in a free slot
+  uint16_t version;       // STORE_VERSION, others are ignored
+  uint16_t nbytes;        // sizeof(config_t)
+  uint16_t crc;           // crc16.h of seq and the config_t
+  uint32_t seq;           // one more than the record before
+} store_header_t;
+
+// the state of the store
+typedef struct {
+  uint32_t seq;           // of the newest record, 0 if none
+  uint32_t nsaves;        // records written since store_init()
+  uint32_t nerases;       // sectors erased since store_init()
+  uint32_t nwords_left;   // of the staged record, 0 when idle
+  bool is_erase_due;      // store_erase() is needed before programming
+} store_status_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+/*
+ * @brief   Finds the newest record and where the next one goes
+ *
+ * @param   flash, the backend, must stay valid
+ *          config, destination for the newest parameters (left as is if
+ *              there are none)
+ * @return  0 if parameters were loaded, -1 if none were found
+ */
+int store_init(store_flash_t* flash, config_t* config);
+
+/*
+ * @brief   Stages a copy of the parameters to be written
+ *
+ * @param   config, the parameters, copied
+ * @return  0 on success, -1 if the last save is still being written
+ */
+int store_save(const config_t* config);
+
+/*
+ * @brief   Returns whether the staged record waits for a sector erase
+ *
+ * @param   none
+ * @return  bool, true if store_erase() is to be called
+ */
+bool store_is_erase_due();
+
+/*
+ * @brief   Erases the sector the staged record goes into
+ *
+ * Masks interrupts for the whole erase, 14 ms typical and up to 114 ms.
+ *
+ * @param   none
+ * @return  0 on success, -1 on a flash error (the save is dropped)
+ */
+int store_erase();
+
+/*
+ * @brief   Programs part of the staged record
+ *
+ * Each word masks interrupts for up to 145 us.
+ *
+ * @param   max_words, the most words to program in this call
+ * @return  uint32_t, the words left to program, 0 when done
+ */
+uint32_t store_service(uint32_t max_words);
+
+/*
+ * @brief   Reports the state of the store
+ *
+ * @param   status, destination for the state
+ * @return  none
+ */
+void store_get_status(store_status_t* status);
+
+#endif // _CONFIG_STORE_H_
@@ -0,0 +1,46 @@
+/* -----------------------------------------------------------------------------
+ * crc16.h - CRC-16/CCITT-FALSE checksums of records and messages
+ *
+ * Polynomial 0x1021, initial value 0xFFFF, no reflection and no final XOR
+ * (the check value of "123456789" is 0x29B1). Table driven, about 10 cycles
+ * per byte on the Cortex-M0+.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _CRC16_H_
+#define _CRC16_H_
+
+#include <stdint.h>
+
+#define CRC16_INIT  (0xFFFF)
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+/*
+ * @brief   Continues a CRC over more data
+ *
+ * @param   crc, the CRC so far, CRC16_INIT to start
+ *          data, the bytes to add
+ *          nbytes, the number of bytes
+ * @return  uint16_t, the CRC including data
+ */
+uint16_t crc16_update(uint16_t crc, const void* data, uint32_t nbytes);
+
+/*
+ * @brief   Computes the CRC of a block of data
+ *
+ * @param   data, the bytes to check
+ *          nbytes, the number of bytes
+ * @return  uint16_t, the CRC
+ */
+uint16_t crc16(const void* data, uint32_t nbytes);
+
+#endif // _CRC16_H_
@@ -17,8 +17,10 @@
 #include "arm_const_structs.h"
 #include "arm_math.h"
 #include "dsp_analysis.h"
+#include "profile.h"
 
 #define MAXSAMPLES    (512)
+#define MINSAMPLES    (32)    // the shortest arm_rfft_q15()
 
 // define the internal datatypes:
 static q15_t FFT_mag[MAXSAMPLES];
@@ -54,24 +56,83 @@ int dsp_find_peaks(int16_t* fft_mag, fft_peaks* dest, uint32_t* bucket_indices)
   return 0;
 }
 
+// see .h for more details
+int dsp_balance(fft_peaks* left, fft_peaks* right) {
+
+  // error case
+  if (left == NULL || right == NULL) return -1;
+
+  int32_t sum_left = 0;
+  int32_t sum_right = 0;
+  for (int i=0; i<NBUCKETS; i++) {
+    sum_left += left->mags[i];
+    sum_right += right->mags[i];
+  }
+
+  if (sum_left + sum_right <= 0) return -1;
+
+  return (sum_right*1000)/(sum_left + sum_right);
+}
+
+// see .h for more details
+uint16_t dsp_peak_amplitude(uint16_t* samples, int nsamples, int stride,
+                            uint16_t* center) {
+
+  // error case
+  if (samples == NULL || nsamples <= 0 || stride <= 0) return 0;
+
+  uint32_t sum = 0;
+  uint16_t min = UINT16_MAX;
+  uint16_t max = 0;
+
+  // a single pass for the mean and the extremes
+  for (int i=0; i<nsamples; i++) {
+    uint16_t sample = samples[i*stride];
+    sum += sample;
+    if (sample < min) min = sample;
+    if (sample > max) max = sample;
+  }
+
+  uint16_t mean = sum/nsamples;
+  if (center != NULL) {
+    *center = mean;
+  }
+
+  return (max-mean > mean-min) ? max-mean : mean-min;
+}
+
 // see .h for more details
 int16_t* dsp_fft_mag(uint16_t* samples, int nsamples) {
+  return dsp_fft_mag_strided(samples, nsamples, 1);
+}
+
+// see .h for more details
+int16_t* dsp_fft_mag_strided(uint16_t* samples, int nsamples, int stride) {
 
   // handle error:
-  if (samples==NULL || nsamples != MAXSAMPLES) return NULL;
+  if (samples==NULL || nsamples < MINSAMPLES || nsamples > MAXSAMPLES ||
+      (nsamples & (nsamples-1)) || stride <= 0) {
+    return NULL;
+  }
+
+  // shorter transforms take every step-th point of the window
+  int step = MAXSAMPLES/nsamples;
 
   arm_rfft_instance_q15 fft_q15_ctx = {0};
   q15_t FFT_input[nsamples];
   q15_t FFT_output[2*nsamples];
     
   // normalize samples to q15_t type from uint16_t type
+  PROF_START(t_stage);
   for (int i=0; i<nsamples; i++) {
     // shift down
-    FFT_input[i] = (int16_t)(samples[i]-(1<<15));
+    FFT_input[i] = (int16_t)(samples[i*stride]-(1<<15));
     // apply window
-    FFT_input[i] = ((q31_t)FFT_input[i]*window[i])>>15;
+    FFT_input[i] = ((q31_t)FFT_input[i]*window[i*step])>>15;
   }
   
+  PROF_LAP(t_stage, PROF_WINDOW);
+
   // initialize the real fft
   arm_rfft_init_q15(&fft_q15_ctx, nsamples, 0, 1);
  
@@ -84,8 +145,11 @@ int16_t* dsp_fft_mag(uint16_t* samples, int nsamples) {
     printf("%d, %d\r\n", i/2, FFT_output[i]);
   }*/
 
+  PROF_LAP(t_stage, PROF_FFT);
+
   // take magnitude squared
   arm_cmplx_mag_squared_q15((q15_t*) FFT_output, (q15_t*) FFT_mag, nsamples);
+  PROF_LAP(t_stage, PROF_MAGNITUDE);
 
   return (int16_t*) FFT_mag;
 }
@@ -20,6 +20,8 @@
 typedef struct {
   int indices[NBUCKETS];  // contains the index of each peak
   int16_t mags[NBUCKETS]; // contains the magnitude of each peak
+  uint32_t seq;           // sequence number of the analyzed capture frame
+  uint32_t t_capture;     // capture timestamp of the analyzed frame
 } fft_peaks;
 
 /* @brief   Returns magnitude squared of a 512 sample real FFT  
@@ -36,6 +38,24 @@ typedef struct {
  */
 int16_t* dsp_fft_mag(uint16_t* samples, int nsamples);
 
+/* @brief   Returns magnitude squared of a real FFT of one channel of
+ *          interleaved samples
+ *
+ * Like dsp_fft_mag() but reads every stride-th sample, so a single channel
+ * of an interleaved multi-channel capture is de-interleaved while it is
+ * copied and windowed, without an extra buffer. Pass the address of the
+ * channel's first sample and the number of interleaved channels as stride.
+ * Shorter transforms (a power of 2 from 32) cost less and cover fewer, wider
+ * bins: bin i is at i*48000/nsamples Hz.
+ *
+ * @param   samples,  the first sample of the channel as a uint16_t datatype
+ *          nsamples, the FFT length, a power of 2 from 32 to 512
+ *          stride,   the distance between consecutive samples of the channel
+ * @return  int16_t, see dsp_fft_mag(). The buffer is shared with
+ *          dsp_fft_mag() and overwritten by the next call to either.
+ */
+int16_t* dsp_fft_mag_strided(uint16_t* samples, int nsamples, int stride);
+
 /* @brief  Finds the NBUCKETS peaks between bucket_indices
  *
  * Finds a single maximal peak via linear search between sequential pairs of
@@ -54,4 +74,27 @@ int16_t* dsp_fft_mag(uint16_t* samples, int nsamples);
  */
 int dsp_find_peaks(int16_t* fft_mag, fft_peaks* dest, uint32_t* bucket_indices);
 
+/* @brief  Finds the DC level and peak amplitude of a buffer of samples
+ *
+ * @param  samples, the sampled data as a uint16_t datatype
+ *         nsamples, the number of samples
+ *         stride, the distance between consecutive samples (1 unless the
+ *              samples are one channel of an interleaved capture)
+ *         center, destination for the mean of the samples (may be NULL)
+ * @return uint16_t, the largest absolute deviation of a sample from the mean,
+ *         0 on error
+ */
+uint16_t dsp_peak_amplitude(uint16_t* samples, int nsamples, int stride,
+                            uint16_t* center);
+
+/* @brief  Finds the left/right balance between the peaks of two channels
+ *
+ * @param  left, the peaks found on the left channel
+ *         right, the peaks found on the right channel
+ * @return int, the share of the total peak magnitude on the right channel
+ *         in permille (0 fully left, 1000 fully right), -1 if both channels
+ *         are silent or on error
+ */
+int dsp_balance(fft_peaks* left, fft_peaks* right);
+
 #endif // _DSP_ANALYSIS_H_
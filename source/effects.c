@@ -0,0 +1,124 @@
+/* -----------------------------------------------------------------------------
+ * effects.c - Fixed point color engine: HSV, gradient palettes, cross-fades
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "effects.h"
+
+#define RED(c)          (((c) >> 16) & 0xFF)
+#define GRN(c)          (((c) >> 8) & 0xFF)
+#define BLU(c)          ((c) & 0xFF)
+#define RGB(r, g, b)    ((uint32_t)(r) << 16 | (uint32_t)(g) << 8 | (b))
+
+// see .h for more details
+const fx_palette_t fx_palettes[FX_NPALETTES] = {
+  [FX_PALETTE_RAINBOW] = { {
+    0xff0000, 0xff6000, 0xffc000, 0xe0ff00, 0x80ff00, 0x20ff00, 0x00ff40,
+    0x00ffa0, 0x00ffff, 0x00a0ff, 0x0040ff, 0x2000ff, 0x8000ff, 0xe000ff,
+    0xff00c0, 0xff0060
+  } },
+  [FX_PALETTE_HEAT] = { {
+    0x300000, 0x670000, 0x9e0000, 0xd60000, 0xff0900, 0xff2b00, 0xff4d00,
+    0xff6f00, 0xff9100, 0xffb300, 0xffd500, 0xfff700, 0xffff26, 0xffff5a,
+    0xffff8d, 0xffffc0
+  } },
+  [FX_PALETTE_OCEAN] = { {
+    0x000020, 0x00003a, 0x000053, 0x00006d, 0x000488, 0x0015aa, 0x0026cc,
+    0x0037ee, 0x0051ff, 0x0073ff, 0x0095ff, 0x00b7ff, 0x1acdff, 0x3cddff,
+    0x5eeeff, 0x80ffff
+  } },
+  [FX_PALETTE_SUNSET] = { {
+    0x400080, 0x5a0089, 0x730091, 0x8d009a, 0xa6009c, 0xc0008b, 0xd9007a,
+    0xf20069, 0xff0d53, 0xff263a, 0xff4020, 0xff5a06, 0xff7300, 0xff8d00,
+    0xffa600, 0xffc000
+  } },
+};
+
+// one channel part way from a to b, rounded towards b
+static inline uint32_t _blend_channel(uint32_t a, uint32_t b,
+                                      uint32_t amount) {
+  if (b >= a) {
+    return a + (((b - a)*amount + 0xFF) >> 8);
+  }
+  return a - (((a - b)*amount + 0xFF) >> 8);
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+// see .h for more details
+uint32_t fx_hsv(uint32_t hue, uint32_t sat, uint32_t val) {
+
+  // six sectors of the circle, each with a 0 to 255 position in it
+  uint32_t h6 = (hue & 0xFF)*6;
+  uint32_t pos = h6 & 0xFF;
+
+  // the lowest channel, then the falling and rising ones of the sector
+  uint32_t low = (val*(256 - sat)) >> 8;
+  uint32_t fall = (val*(256 - ((sat*pos) >> 8))) >> 8;
+  uint32_t rise = (val*(256 - ((sat*(256 - pos)) >> 8))) >> 8;
+
+  switch (h6 >> 8) {
+    case 0:  return RGB(val, rise, low);
+    case 1:  return RGB(fall, val, low);
+    case 2:  return RGB(low, val, rise);
+    case 3:  return RGB(low, fall, val);
+    case 4:  return RGB(rise, low, val);
+    default: return RGB(val, low, fall);
+  }
+}
+
+// see .h for more details
+uint32_t fx_palette_color(const fx_palette_t* palette, uint32_t index) {
+  uint32_t entry = (index >> 4) & (FX_PALETTE_SIZE-1);
+  uint32_t from = palette->colors[entry];
+  uint32_t to = palette->colors[(entry + 1) & (FX_PALETTE_SIZE-1)];
+  return fx_blend(from, to, (index & 0xF) << 4);
+}
+
+// see .h for more details
+uint32_t fx_scale(uint32_t color, uint32_t level) {
+  return RGB((RED(color)*level) >> 8, (GRN(color)*level) >> 8,
+             (BLU(color)*level) >> 8);
+}
+
+// see .h for more details
+uint32_t fx_blend(uint32_t from, uint32_t to, uint32_t amount) {
+  return RGB(_blend_channel(RED(from), RED(to), amount),
+             _blend_channel(GRN(from), GRN(to), amount),
+             _blend_channel(BLU(from), BLU(to), amount));
+}
+
+// see .h for more details
+void fx_crossfade(uint32_t* shown, const uint32_t* target,
+                  const uint8_t* energy, uint32_t npixels, uint32_t rate) {
+  for (uint32_t i=0; i<npixels; i++) {
+    uint32_t amount = rate + (energy != NULL ? energy[i] : 0);
+    if (amount > FX_FULL) amount = FX_FULL;
+    shown[i] = fx_blend(shown[i], target[i], amount);
+  }
+}
+
+// see .h for more details
+uint32_t fx_intensity(int32_t excess) {
+
+  if (excess <= 0) return 0;
+
+  // floor(log2(excess)), up to 7
+  uint32_t n = 0;
+  uint32_t e = excess;
+  if (e >= 16) { n = 4; e >>= 4; }
+  if (e >= 4)  { n += 2; e >>= 2; }
+  if (e >= 2)  { n += 1; }
+
+  return n >= 7 ? 255 : 32*(n + 1);
+}
@@ -0,0 +1,127 @@
+/* -----------------------------------------------------------------------------
+ * effects.h - Fixed point color engine: HSV, gradient palettes, cross-fades
+ *
+ * The building blocks of the pixel effects, all in integer arithmetic with
+ * no division and no loop that depends on the data, so each costs the same
+ * number of cycles for every pixel and a frame costs a fixed amount per
+ * pixel, however long the strip:
+ *
+ *   fx_hsv()            hue, saturation, value to a 24-bit color
+ *   fx_palette_color()  a 16 entry gradient, interpolated between entries
+ *   fx_scale()          a color dimmed to a level
+ *   fx_blend()          a color part way to another
+ *   fx_crossfade()      a frame part way to the next, faster where the band
+ *                       under a pixel is loud
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _EFFECTS_H_
+#define _EFFECTS_H_
+
+#include <stdint.h>
+
+#define FX_PALETTE_SIZE  (16)
+#define FX_FULL          (256)  // a level, blend or fade rate of 1.0
+
+// a gradient of FX_PALETTE_SIZE 24-bit colors, evenly spaced over the 256
+// palette indices and wrapping around from the last to the first
+typedef struct {
+  uint32_t colors[FX_PALETTE_SIZE];
+} fx_palette_t;
+
+// the built-in gradients
+typedef enum {
+  FX_PALETTE_RAINBOW,   // the hue circle
+  FX_PALETTE_HEAT,      // dark red, red, orange, yellow, white
+  FX_PALETTE_OCEAN,     // deep blue to aqua
+  FX_PALETTE_SUNSET,    // purple, pink, orange
+  FX_NPALETTES
+} fx_palette_id_t;
+
+extern const fx_palette_t fx_palettes[FX_NPALETTES];
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+/*
+ * @brief   Converts a hue, saturation and value to a color
+ *
+ * @param   hue, 0 to 255 around the circle from red, through green (85)
+ *              and blue (170); higher bits are ignored
+ *          sat, saturation 0 (grey) to 255
+ *          val, value 0 (black) to 255
+ * @return  uint32_t, the 24-bit 0xRRGGBB color
+ */
+uint32_t fx_hsv(uint32_t hue, uint32_t sat, uint32_t val);
+
+/*
+ * @brief   Returns a color along a gradient
+ *
+ * Indices that are a multiple of 16 return an entry as it is, those between
+ * blend linearly to the next entry, which is the first after the last.
+ *
+ * @param   palette, the gradient
+ *          index, 0 to 255; higher bits are ignored
+ * @return  uint32_t, the 24-bit color
+ */
+uint32_t fx_palette_color(const fx_palette_t* palette, uint32_t index);
+
+/*
+ * @brief   Dims a color
+ *
+ * @param   color, the 24-bit color
+ *          level, 0 (black) to FX_FULL (as it is)
+ * @return  uint32_t, the dimmed color
+ */
+uint32_t fx_scale(uint32_t color, uint32_t level);
+
+/*
+ * @brief   Blends one color towards another
+ *
+ * Each channel moves by its share of the difference rounded away from
+ * zero, so a blend of more than 0 always makes progress and repeated blends
+ * reach the target exactly.
+ *
+ * @param   from, the 24-bit color to start from
+ *          to, the 24-bit color to go towards
+ *          amount, 0 (from) to FX_FULL (to)
+ * @return  uint32_t, the blended color
+ */
+uint32_t fx_blend(uint32_t from, uint32_t to, uint32_t amount);
+
+/*
+ * @brief   Moves the colors shown one frame towards the new ones
+ *
+ * Each pixel blends by rate plus its energy, at most FX_FULL, so a pixel
+ * over a loud band changes at once and a quiet one trails off.
+ *
+ * @param   shown, the colors shown, updated in place
+ *          target, the new colors
+ *          energy, 0 to 255 per pixel, NULL for none
+ *          npixels, the number of pixels
+ *          rate, the blend of a pixel with no energy, 1 to FX_FULL
+ * @return  none
+ */
+void fx_crossfade(uint32_t* shown, const uint32_t* target,
+                  const uint8_t* energy, uint32_t npixels, uint32_t rate);
+
+/*
+ * @brief   Maps how far a level is over its threshold to a brightness
+ *
+ * On a log2 scale: 32 for an excess of 1, 32 more for each doubling, 255
+ * from 128 on. The Cortex-M0+ has no CLZ, so the doublings are counted
+ * with three compares rather than a loop over the bits.
+ *
+ * @param   excess, the level minus the threshold
+ * @return  uint32_t, 0 if excess is 0 or less, else 32 to 255
+ */
+uint32_t fx_intensity(int32_t excess);
+
+#endif // _EFFECTS_H_
@@ -0,0 +1,145 @@
+/* -----------------------------------------------------------------------------
+ * events.c - Event flags posted from interrupt handlers, with a sleeping wait
+ *
+ * Interrupt handlers post events (e.g. ADC frame captured, neopixel transmit
+ * done) and the main loop waits for them in the KL25Z WAIT power mode instead
+ * of busy-polling. The time spent asleep is accumulated so the CPU idle
+ * fraction (headroom left for the DSP) can be reported once per second.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "MKL25Z4.h"
+#include "fsl_smc.h"
+#include "fsl_clock.h"
+#include "timestamp.h"
+#include "events.h"
+
+#define START_CRITICAL_SECTION \
+          uint32_t masking_state = __get_PRIMASK(); \
+          __disable_irq()
+
+#define END_CRITICAL_SECTION \
+          __set_PRIMASK(masking_state)
+
+#define IDLE_WINDOW_TICKS  (TS_TICKS_PER_SEC) // report idle once per second
+
+// the pending event flags
+static volatile uint32_t evt_flags;
+
+// idle accounting, only touched from the main loop
+static uint32_t idle_window_start;
+static uint32_t idle_ticks;
+static uint32_t idle_last_permille;
+static bool is_idle_report_ready;
+
+// see .h for more details
+void evt_post(uint32_t flags) {
+  START_CRITICAL_SECTION;
+  evt_flags |= flags;
+  END_CRITICAL_SECTION;
+}
+
+// see .h for more details
+uint32_t evt_wait(uint32_t mask) {
+
+  uint32_t posted;
+  uint32_t t_sleep;
+
+  while (1) {
+
+    // interrupts are masked while checking the flags, so an event posted
+    // between the check and WFI leaves its IRQ pending and WFI returns at once
+    __disable_irq();
+    posted = evt_flags & mask;
+    if (posted) {
+      evt_flags &= ~posted;
+      __enable_irq();
+      break;
+    }
+
+    t_sleep = ts_now();
+    SMC_SetPowerModeWait(SMC);
+    idle_ticks += ts_elapsed(t_sleep);
+
+    // the handler that woke the core runs here
+    __enable_irq();
+  }
+
+  // close the idle window once a second has passed
+  uint32_t window = ts_elapsed(idle_window_start);
+  if (window >= IDLE_WINDOW_TICKS) {
+    idle_last_permille = (uint32_t)(((uint64_t)idle_ticks*1000)/window);
+    idle_window_start += window;
+    idle_ticks = 0;
+    is_idle_report_ready = true;
+  }
+
+  return posted;
+}
+
+// see .h for more details
+uint32_t evt_stop(uint32_t mask) {
+
+  uint32_t posted;
+
+  while (1) {
+
+    // masks interrupts and disables flash speculation for the stop entry
+    SMC_PreEnterStopModes();
+    posted = evt_flags & mask;
+    if (posted) {
+      evt_flags &= ~posted;
+      SMC_PostExitStopModes();
+      break;
+    }
+
+    SMC_SetPowerModeVlps(SMC);
+
+    // the PLL is disabled in VLPS and the MCG wakes up in PBE mode, so wait
+    // for the PLL to lock again and switch back to PEE
+    if (CLOCK_GetMode() == kMCG_ModePBE) {
+      while (!(MCG->S & MCG_S_LOCK0_MASK)) {;}
+      CLOCK_SetPeeMode();
+    }
+
+    // the handler that woke the core runs here
+    SMC_PostExitStopModes();
+  }
+
+  // the timestamp counter was halted, start a fresh idle window
+  idle_window_start = ts_now();
+  idle_ticks = 0;
+
+  return posted;
+}
+
+// see .h for more details
+bool evt_idle_report(uint32_t* idle_permille) {
+
+  if (!is_idle_report_ready || idle_permille == NULL) {
+    return false;
+  }
+
+  *idle_permille = idle_last_permille;
+  is_idle_report_ready = false;
+  return true;
+}
+
+// see .h for more details
+void evt_init() {
+  // VLPS must be allowed once after reset before evt_stop() can enter it
+  SMC_SetPowerModeProtection(SMC, kSMC_AllowPowerModeVlp);
+
+  evt_flags = 0;
+  idle_window_start = ts_now();
+  idle_ticks = 0;
+  idle_last_permille = 0;
+  is_idle_report_ready = false;
+}
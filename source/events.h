@@ -0,0 +1,90 @@
+/* -----------------------------------------------------------------------------
+ * events.h - Event flags posted from interrupt handlers, with a sleeping wait
+ *
+ * Interrupt handlers post events (e.g. ADC frame captured, neopixel transmit
+ * done) and the main loop waits for them in the KL25Z WAIT power mode instead
+ * of busy-polling. The time spent asleep is accumulated so the CPU idle
+ * fraction (headroom left for the DSP) can be reported once per second.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _EVENTS_H_
+#define _EVENTS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// the event flags:
+#define EVT_ADC_FRAME   (1UL<<0)  // a new buffer of ADC samples is available
+#define EVT_PIXL_XMIT   (1UL<<1)  // a neopixel DMA transfer has completed
+#define EVT_SOUND_WAKE  (1UL<<2)  // the ADC compare detected a loud sample
+#define EVT_STREAM_XMIT (1UL<<3)  // a UART0 stream packet has been sent
+#define EVT_LOG_XMIT    (1UL<<4)  // the debug console sent a byte
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+/*
+ * @brief   Posts one or more events, waking the main loop if it is waiting
+ *
+ * Safe to call from interrupt handlers.
+ *
+ * @param   flags, the EVT_* flags to set
+ * @return  none
+ */
+void evt_post(uint32_t flags);
+
+/*
+ * @brief   Sleeps in WAIT mode until any of the requested events is posted
+ *
+ * The matched events are cleared before returning; events outside of mask
+ * remain pending for a later call. Interrupts that do not post a requested
+ * event (e.g. the timestamp overflow) put the core straight back to sleep.
+ *
+ * @param   mask, the EVT_* flags to wait for
+ * @return  uint32_t, the subset of mask which was posted
+ */
+uint32_t evt_wait(uint32_t mask);
+
+/*
+ * @brief   Stops the core in VLPS mode until any of the requested events is
+ *          posted
+ *
+ * Only peripherals clocked asynchronously (e.g. ADC0 on its ADACK clock) can
+ * post events while stopped. On wake the MCG is switched back from PBE to
+ * the PEE run clocks before returning. The timestamp counter is halted while
+ * stopped, so the time spent in VLPS is not counted by the idle accounting.
+ *
+ * @param   mask, the EVT_* flags to wait for
+ * @return  uint32_t, the subset of mask which was posted
+ */
+uint32_t evt_stop(uint32_t mask);
+
+/*
+ * @brief   Returns the CPU idle fraction once per one second window
+ *
+ * @param   idle_permille, destination for the fraction of the last window
+ *              spent asleep in evt_wait(), in units of 0.1%
+ * @return  bool, true  - a new window completed, idle_permille is updated
+ *                false - the current window is still accumulating
+ */
+bool evt_idle_report(uint32_t* idle_permille);
+
+/*
+ * @brief   Initializes the event flags and idle accounting
+ *
+ * Requires the timestamp module to be initialized (see ts_init()).
+ *
+ * @param   none
+ * @return  none
+ */
+void evt_init();
+
+#endif // _EVENTS_H_
@@ -0,0 +1,304 @@
+/* -----------------------------------------------------------------------------
+ * flash_rec.c - Records captured frames into program flash for offline study
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "MKL25Z4.h"
+#include "fsl_flash.h"
+#include "timestamp.h"
+#include "flash_rec.h"
+
+#define START_CRITICAL_SECTION \
+          uint32_t masking_state = __get_PRIMASK(); \
+          __disable_irq()
+
+#define END_CRITICAL_SECTION \
+          __set_PRIMASK(masking_state)
+
+#define SECTOR_SIZE     (1024U)
+#define REC_FLASH_END   (REC_FLASH_START + REC_FLASH_SIZE)
+// a longword program takes up to 145 us, plus the driver's own checks
+#define PGM_MAX_TICKS   (REC_PGM_MAX_US*TS_TICKS_PER_US)
+#define DUMP_PER_LINE   (16)
+
+#if AIN_NUM_CHANNELS < REC_MAX_CHANNELS
+#define REC_CHANNELS    (AIN_NUM_CHANNELS)
+#else
+#define REC_CHANNELS    (REC_MAX_CHANNELS)
+#endif
+
+// size of a record in flash, in 32-bit words
+#define REC_WORDS(nch)  ((sizeof(rec_header_t) + \
+                          AIN_FRAME_SAMPLES*(nch)*sizeof(uint16_t))/4)
+#define REC_ADPCM_WORDS(nch)  ((sizeof(rec_header_t) + \
+                          (nch)*ADPCM_BLOCK_BYTES(AIN_FRAME_SAMPLES))/4)
+
+static flash_config_t flash_cfg;
+static bool is_flash_ok;
+
+// the record being programmed, as it will appear in flash
+static union {
+  struct {
+    rec_header_t header;
+    union {
+      uint16_t samples[AIN_FRAME_SAMPLES*REC_CHANNELS];
+      uint8_t blocks[REC_CHANNELS][ADPCM_BLOCK_BYTES(AIN_FRAME_SAMPLES)];
+    };
+  } rec;
+  uint32_t words[REC_WORDS(REC_CHANNELS)];
+} stage;
+static uint32_t stage_nwords;   // words in the staged record, 0 when free
+static uint32_t stage_ndone;    // words programmed so far
+
+static uint32_t rec_addr;       // where the staged (or next) record goes
+static uint8_t rec_encoding;
+static adpcm_state_t coders[REC_CHANNELS];
+static rec_status_t status;
+
+// size of a record in flash, in 32-bit words
+static uint32_t _record_words(uint32_t nchannels, uint8_t encoding) {
+  return encoding == REC_ADPCM ? REC_ADPCM_WORDS(nchannels) :
+                                 REC_WORDS(nchannels);
+}
+
+// returns the valid record at addr, or NULL at the end of the recording
+static const rec_header_t* _record_at(uint32_t addr) {
+
+  if (addr + sizeof(rec_header_t) > REC_FLASH_END) return NULL;
+
+  const rec_header_t* header = (const rec_header_t*)(uintptr_t)addr;
+  if (header->magic != REC_MAGIC || header->nchannels < 1 ||
+      header->nchannels > REC_MAX_CHANNELS ||
+      (header->encoding != REC_RAW && header->encoding != REC_ADPCM) ||
+      addr + _record_words(header->nchannels, header->encoding)*4 >
+      REC_FLASH_END) {
+    return NULL;
+  }
+  return header;
+}
+
+// erases a sector of the parameter store
+static int _store_erase(store_flash_t* flash, uint32_t offset) {
+
+  if (!is_flash_ok) return -1;
+
+  START_CRITICAL_SECTION;
+  status_t result = FLASH_Erase(&flash_cfg, STORE_FLASH_START + offset,
+                                SECTOR_SIZE, kFLASH_ApiEraseKey);
+  END_CRITICAL_SECTION;
+
+  return result == kStatus_Success ? 0 : -1;
+}
+
+// programs a word of the parameter store
+static int _store_program(store_flash_t* flash, uint32_t offset,
+                          uint32_t word) {
+
+  if (!is_flash_ok) return -1;
+
+  START_CRITICAL_SECTION;
+  status_t result = FLASH_Program(&flash_cfg, STORE_FLASH_START + offset,
+                                  &word, 4);
+  END_CRITICAL_SECTION;
+
+  return result == kStatus_Success ? 0 : -1;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+// see .h for more details
+int rec_init() {
+
+  memset(&flash_cfg, 0, sizeof(flash_cfg));
+  is_flash_ok = (FLASH_Init(&flash_cfg) == kStatus_Success);
+
+  memset(&status, 0, sizeof(status));
+  status.capacity = REC_FLASH_SIZE/(REC_WORDS(REC_CHANNELS)*4);
+  stage_nwords = 0;
+
+  // count the records left by an earlier run
+  rec_addr = REC_FLASH_START;
+  const rec_header_t* header;
+  while ((header = _record_at(rec_addr)) != NULL) {
+    rec_addr += _record_words(header->nchannels, header->encoding)*4;
+    status.nrecords++;
+  }
+
+  return is_flash_ok ? 0 : -1;
+}
+
+// see .h for more details
+int rec_start(uint8_t encoding) {
+
+  if (!is_flash_ok || (encoding != REC_RAW && encoding != REC_ADPCM)) {
+    return -1;
+  }
+
+  status.is_recording = false;
+  stage_nwords = 0;
+
+  // a sector erase far exceeds a frame period, so the whole region is
+  // erased before recording rather than sector by sector as it fills
+  for (uint32_t addr = REC_FLASH_START; addr < REC_FLASH_END;
+       addr += SECTOR_SIZE) {
+    START_CRITICAL_SECTION;
+    status_t result = FLASH_Erase(&flash_cfg, addr, SECTOR_SIZE,
+                                  kFLASH_ApiEraseKey);
+    END_CRITICAL_SECTION;
+    if (result != kStatus_Success) return -1;
+  }
+
+  rec_addr = REC_FLASH_START;
+  rec_encoding = encoding;
+  for (int ch=0; ch<REC_CHANNELS; ch++) {
+    adpcm_init(&coders[ch]);
+  }
+  status.nrecords = 0;
+  status.nskipped = 0;
+  status.capacity = REC_FLASH_SIZE/(_record_words(REC_CHANNELS, encoding)*4);
+  status.is_recording = true;
+  return 0;
+}
+
+// see .h for more details
+void rec_stop() {
+  status.is_recording = false;
+  stage_nwords = 0;
+}
+
+// see .h for more details
+int rec_frame(const ain_frame_t* frame) {
+
+  if (frame == NULL || frame->samples == NULL || !status.is_recording) {
+    return -1;
+  }
+  if (stage_nwords) {
+    status.nskipped++;
+    return -1;
+  }
+
+  uint32_t nch = frame->nchannels < REC_CHANNELS ? frame->nchannels :
+                                                   REC_CHANNELS;
+  uint32_t nwords = _record_words(nch, rec_encoding);
+  if (rec_addr + nwords*4 > REC_FLASH_END) {
+    status.is_recording = false;
+    return -1;
+  }
+
+  stage.rec.header.magic = REC_MAGIC;
+  stage.rec.header.nchannels = nch;
+  stage.rec.header.encoding = rec_encoding;
+  stage.rec.header.seq = frame->seq;
+  stage.rec.header.sample_idx = frame->sample_idx;
+  stage.rec.header.t_capture = frame->t_capture;
+  if (rec_encoding == REC_ADPCM) {
+    for (int ch=0; ch<nch; ch++) {
+      adpcm_encode(&coders[ch], frame->samples + ch, AIN_FRAME_SAMPLES,
+                   frame->nchannels, stage.rec.blocks[ch]);
+    }
+  } else {
+    for (int i=0; i<AIN_FRAME_SAMPLES; i++) {
+      for (int ch=0; ch<nch; ch++) {
+        stage.rec.samples[i*nch + ch] =
+            frame->samples[i*frame->nchannels + ch];
+      }
+    }
+  }
+
+  stage_nwords = nwords;
+  stage_ndone = 0;
+  return 0;
+}
+
+// see .h for more details
+void rec_service(uint32_t t_deadline) {
+
+  while (stage_nwords) {
+
+    if ((int32_t)(t_deadline - ts_now()) < (int32_t)PGM_MAX_TICKS) return;
+
+    // the header word goes last, so a record is only valid once complete
+    uint32_t idx = (stage_ndone + 1) % stage_nwords;
+
+    START_CRITICAL_SECTION;
+    status_t result = FLASH_Program(&flash_cfg, rec_addr + idx*4,
+                                    &stage.words[idx], 4);
+    END_CRITICAL_SECTION;
+
+    if (result != kStatus_Success) {
+      rec_stop();
+      return;
+    }
+
+    if (++stage_ndone == stage_nwords) {
+      rec_addr += stage_nwords*4;
+      status.nrecords++;
+      stage_nwords = 0;
+    }
+  }
+}
+
+// see .h for more details
+void rec_get_status(rec_status_t* dest) {
+  if (dest == NULL) return;
+  *dest = status;
+}
+
+// see .h for more details
+uint32_t rec_dump() {
+
+  uint32_t addr = REC_FLASH_START;
+  uint32_t nrecords = 0;
+  const rec_header_t* header;
+
+  // printing takes seconds, recording would only skip frames meanwhile
+  rec_stop();
+
+  while ((header = _record_at(addr)) != NULL) {
+
+    const uint16_t* data = (const uint16_t*)(header + 1);
+    uint32_t nwords = _record_words(header->nchannels, header->encoding);
+    uint32_t ndata = (nwords*4 - sizeof(rec_header_t))/sizeof(uint16_t);
+
+    printf("rec frame %" PRIu32 " ch %u seq %" PRIu32 " idx %" PRIu32
+           " t %" PRIu32 "%s\r\n", nrecords, header->nchannels, header->seq,
+           header->sample_idx, header->t_capture,
+           header->encoding == REC_ADPCM ? " adpcm" : "");
+    for (uint32_t i=0; i<ndata; i+=DUMP_PER_LINE) {
+      printf("recd");
+      for (uint32_t j=i; j<i+DUMP_PER_LINE && j<ndata; j++) {
+        printf(" %04x", data[j]);
+      }
+      printf("\r\n");
+    }
+
+    addr += nwords*4;
+    nrecords++;
+  }
+
+  printf("rec end %" PRIu32 "\r\n", nrecords);
+  return nrecords;
+}
+
+// see .h for more details
+void rec_init_store_flash(store_flash_t* flash) {
+  if (flash == NULL) return;
+  flash->base = (const uint8_t*)(uintptr_t)STORE_FLASH_START;
+  flash->erase = _store_erase;
+  flash->program = _store_program;
+  flash->ctx = NULL;
+}
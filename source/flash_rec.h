@@ -0,0 +1,157 @@
+/* -----------------------------------------------------------------------------
+ * flash_rec.h - Records captured frames into program flash for offline study
+ *
+ * A region near the top of program flash (kept out of PROGRAM_FLASH in the
+ * linker memory map) holds a recording of whole ADC frames with their
+ * metadata. The region is erased when recording starts. Each frame to keep
+ * is copied to a RAM stage and programmed one longword at a time in the time
+ * left before the next frame completes. Frames that arrive while the stage
+ * is still being written are skipped, so a raw recording holds one frame in
+ * every few (a raw stereo frame takes about 35 ms to program). Each frame is
+ * complete, so replaying a raw recording through the pipeline reproduces
+ * what the visualizer did with it. A recording can instead be compressed
+ * 4:1 with IMA ADPCM (see adpcm.h): a stereo frame then takes about 9 ms to
+ * program, so most frames are kept and the region holds four times as many.
+ * rec_dump() prints the recording on the debug console; host/rec2wav turns
+ * that output back into a WAV file.
+ *
+ * The KL25Z has a single flash block, so the core cannot fetch from flash
+ * while a flash command runs. Interrupts are masked for each command, which
+ * blocks them for up to 145 us per longword and 114 ms per sector erase.
+ * The module owns the flash driver, and also provides the flash access of
+ * the parameter store (see config_store.h), which takes the last 4 sectors
+ * of the reserved region.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _FLASH_REC_H_
+#define _FLASH_REC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "analog_input.h"
+#include "adpcm.h"
+#include "config_store.h"
+
+#define REC_FLASH_START   (0x18000U)  // must match the linker memory map
+#define REC_FLASH_SIZE    (0x7000U)   // 28 sectors of 1 KB, then the store
+#define REC_PGM_MAX_US    (200)       // a longword program, with the driver
+#define REC_MAX_CHANNELS  (2)         // channels kept per frame, RAM bound
+#define REC_MAGIC         (0xAD10)
+
+// how the samples of a record are stored
+#define REC_RAW           (0xFF)      // uint16_t samples, interleaved
+#define REC_ADPCM         (0x01)      // one adpcm.h block per channel
+
+// a record in flash, followed by AIN_FRAME_SAMPLES*nchannels raw samples or
+// nchannels ADPCM blocks of AIN_FRAME_SAMPLES samples each
+typedef struct {
+  uint16_t magic;         // REC_MAGIC, erased (0xFFFF) past the last record
+  uint8_t nchannels;      // channels in the record
+  uint8_t encoding;       // REC_RAW or REC_ADPCM
+  uint32_t seq;           // the frame's ain_frame_t metadata
+  uint32_t sample_idx;
+  uint32_t t_capture;
+} rec_header_t;
+
+// the state of the recorder
+typedef struct {
+  uint32_t nrecords;      // frames stored in flash
+  uint32_t nskipped;      // frames passed over while the stage was busy
+  uint32_t capacity;      // frames the region holds
+  bool is_recording;      // rec_frame() is taking frames
+} rec_status_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+/*
+ * @brief   Initializes the flash driver and finds any existing recording
+ *
+ * @param   none
+ * @return  0 on success, -1 if the flash driver failed to initialize
+ */
+int rec_init();
+
+/*
+ * @brief   Erases the region and starts a new recording
+ *
+ * Erases one sector at a time with interrupts masked, about 0.5 s in total,
+ * during which no frames are processed.
+ *
+ * @param   encoding, REC_RAW or REC_ADPCM
+ * @return  0 on success, -1 on a flash error or an unknown encoding
+ */
+int rec_start(uint8_t encoding);
+
+/*
+ * @brief   Stops recording; a frame still in the stage is dropped
+ *
+ * @param   none
+ * @return  none
+ */
+void rec_stop();
+
+/*
+ * @brief   Offers a frame to the recording
+ *
+ * The first REC_MAX_CHANNELS channels are copied, so the frame may be reused
+ * as soon as this returns. Recording stops by itself when the region is full.
+ *
+ * @param   frame, the frame just taken from the sample source
+ * @return  0 if the frame was staged, -1 if not recording or still busy
+ */
+int rec_frame(const ain_frame_t* frame);
+
+/*
+ * @brief   Programs the staged frame into flash until a deadline
+ *
+ * Call when the frame's processing is done. Stops before a longword program
+ * could run past t_deadline, so it never delays taking the next frame.
+ *
+ * @param   t_deadline, timestamp (see timestamp.h) to be done by
+ * @return  none
+ */
+void rec_service(uint32_t t_deadline);
+
+/*
+ * @brief   Reports the state of the recorder
+ *
+ * @param   status, destination for the state
+ * @return  none
+ */
+void rec_get_status(rec_status_t* status);
+
+/*
+ * @brief   Prints the recording on the debug console
+ *
+ * One "rec frame" line per record (ending in "adpcm" for compressed ones),
+ * followed by "recd" lines of the record's data as 16 little endian 16-bit
+ * words in hex (the interleaved samples of a raw record), and a closing
+ * "rec end" line. Blocks until
+ * everything is printed (about 6 s for a full region at 115200 baud).
+ *
+ * @param   none
+ * @return  uint32_t, the number of records printed
+ */
+uint32_t rec_dump();
+
+/*
+ * @brief   Fills in the flash access for the parameter store
+ *
+ * Erase and program commands go to the STORE_FLASH_START region, with
+ * interrupts masked. Call after rec_init().
+ *
+ * @param   flash, the store's backend to fill in
+ * @return  none
+ */
+void rec_init_store_flash(store_flash_t* flash);
+
+#endif // _FLASH_REC_H_
@@ -0,0 +1,82 @@
+/* -----------------------------------------------------------------------------
+ * latency.c - Sample-to-LED latency histogram and percentiles
+ *
+ * Latencies are recorded (typically from an interrupt handler) into a
+ * histogram of LAT_BIN_US wide bins. Two histograms are used so the main loop
+ * can compute percentiles of one window while the next window accumulates.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "timestamp.h"
+#include "latency.h"
+
+// the ping-pong histograms, lat_active is the one being recorded into
+static uint16_t lat_hist[2][LAT_NBINS];
+static uint32_t lat_max_us[2];
+static volatile uint32_t lat_active;
+
+// see .h for more details
+void lat_record(uint32_t ticks) {
+
+  uint32_t us = ticks/TS_TICKS_PER_US;
+  uint32_t bin = us/LAT_BIN_US;
+  uint32_t active = lat_active;
+
+  if (bin >= LAT_NBINS) {
+    bin = LAT_NBINS-1;
+  }
+  // saturate rather than wrap the bin count
+  if (lat_hist[active][bin] < UINT16_MAX) {
+    lat_hist[active][bin]++;
+  }
+  if (us > lat_max_us[active]) {
+    lat_max_us[active] = us;
+  }
+}
+
+// see .h for more details
+int lat_report(lat_stats_t* stats) {
+
+  // error case
+  if (stats == NULL) return -1;
+
+  // flip the histograms, the finished window is no longer written
+  uint32_t done = lat_active;
+  lat_active = done ^ 1;
+
+  uint16_t *hist = lat_hist[done];
+  uint32_t count = 0;
+  for (int i=0; i<LAT_NBINS; i++) {
+    count += hist[i];
+  }
+
+  stats->count = count;
+  stats->p50_us = 0;
+  stats->p90_us = 0;
+  stats->p99_us = 0;
+  stats->max_us = lat_max_us[done];
+
+  // walk the cumulative distribution, reporting the upper edge of each bin
+  uint32_t cumulative = 0;
+  for (int i=0; i<LAT_NBINS && count>0; i++) {
+    cumulative += hist[i];
+    uint32_t edge_us = (i+1)*LAT_BIN_US;
+    uint32_t percent = cumulative*100;
+    if (stats->p50_us == 0 && percent >= count*50) stats->p50_us = edge_us;
+    if (stats->p90_us == 0 && percent >= count*90) stats->p90_us = edge_us;
+    if (stats->p99_us == 0 && percent >= count*99) stats->p99_us = edge_us;
+  }
+
+  // clear the finished window for its next turn
+  memset(hist, 0, sizeof(lat_hist[0]));
+  lat_max_us[done] = 0;
+
+  return 0;
+}
@@ -0,0 +1,57 @@
+/* -----------------------------------------------------------------------------
+ * latency.h - Sample-to-LED latency histogram and percentiles
+ *
+ * Latencies are recorded (typically from an interrupt handler) into a
+ * histogram of LAT_BIN_US wide bins. Two histograms are used so the main loop
+ * can compute percentiles of one window while the next window accumulates.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _LATENCY_H_
+#define _LATENCY_H_
+
+#include <stdint.h>
+
+#define LAT_BIN_US   (500)  // width of a histogram bin in microseconds
+#define LAT_NBINS    (64)   // the last bin also collects any overflow
+
+typedef struct {
+  uint32_t count;   // number of latencies recorded in the window
+  uint32_t p50_us;  // upper edge of the bin holding the 50th percentile
+  uint32_t p90_us;  // upper edge of the bin holding the 90th percentile
+  uint32_t p99_us;  // upper edge of the bin holding the 99th percentile
+  uint32_t max_us;  // exact worst case latency in the window
+} lat_stats_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+/*
+ * @brief   Records a single latency into the active histogram
+ *
+ * Safe to call from interrupt handlers.
+ *
+ * @param   ticks, the latency in timestamp ticks (see timestamp.h)
+ * @return  none
+ */
+void lat_record(uint32_t ticks);
+
+/*
+ * @brief   Ends the current window and computes its percentiles
+ *
+ * Recording switches over to the other histogram, the finished one is
+ * summarized into stats and then cleared.
+ *
+ * @param   stats, the destination for the summarized window
+ * @return  0 on success, -1 on error
+ */
+int lat_report(lat_stats_t* stats);
+
+#endif // _LATENCY_H_
@@ -0,0 +1,282 @@
+/* -----------------------------------------------------------------------------
+ * log_console.c - Non-blocking debug console output through a ring buffer
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "MKL25Z4.h"
+#include "fsl_lpsci.h"
+#include "events.h"
+#include "log_console.h"
+
+#define START_CRITICAL_SECTION \
+          uint32_t masking_state = __get_PRIMASK(); \
+          __disable_irq()
+
+#define END_CRITICAL_SECTION \
+          __set_PRIMASK(masking_state)
+
+#define RING_MASK  (LOG_BUF_SIZE-1)
+#define RX_MASK    (LOG_RX_SIZE-1)
+
+// a message waiting for log_service()
+typedef struct {
+  const char* fmt;
+  uint32_t args[3];
+} deferred_t;
+
+// the ring: head and tail run freely, head - tail bytes are queued. Writers
+// take space up to reserved and copy into it with interrupts enabled, the
+// last of them to finish moves head up to it
+static char ring[LOG_BUF_SIZE];
+static volatile uint32_t head;   // written by log_write()
+static volatile uint32_t tail;   // written by UART0_IRQHandler()
+static uint32_t reserved;
+static uint32_t nwriters;        // writers copying
+
+// received characters
+static char rx_ring[LOG_RX_SIZE];
+static volatile uint32_t rx_head;   // written by UART0_IRQHandler()
+static volatile uint32_t rx_tail;   // written by log_getc()
+
+static deferred_t deferred[LOG_DEFER_SIZE];
+static volatile uint32_t defer_head;
+static uint32_t defer_tail;
+
+static bool is_started = false;
+static volatile bool is_paused = false;
+static volatile bool is_blocking = false;
+static log_stats_t stats;
+
+// starts draining, call with interrupts masked. The handler alone writes
+// TIE, so a read-modify-write of C2 here cannot race with it
+static void _kick() {
+  if (is_started && !is_paused && head != tail) {
+    NVIC_SetPendingIRQ(UART0_IRQn);
+  }
+}
+
+// a writer is done copying. An interrupt that wrote meanwhile reserved
+// after it and published nothing, so the last writer to finish publishes
+// every byte copied, in order
+static void _publish(uint32_t n) {
+  START_CRITICAL_SECTION;
+  if (--nwriters == 0) {
+    head = reserved;
+    if (head - tail > stats.max_used) stats.max_used = head - tail;
+    _kick();
+  }
+  stats.nbytes += n;
+  END_CRITICAL_SECTION;
+}
+
+// copies what fits of data into the ring, returns the number of bytes.
+// Interrupts are only masked to take the space and to publish it, never
+// for the copy, so a long message cannot hold off the LED interrupt
+static uint32_t _put(const char* data, uint32_t nbytes, bool is_partial) {
+
+  uint32_t n = 0;
+  uint32_t h = 0;
+
+  START_CRITICAL_SECTION;
+  uint32_t room = LOG_BUF_SIZE - (reserved - tail);
+  if (nbytes <= room || is_partial) {
+    n = nbytes < room ? nbytes : room;
+  }
+  if (n) {
+    h = reserved;
+    reserved = h + n;
+    nwriters++;
+  }
+  END_CRITICAL_SECTION;
+
+  if (n == 0) return 0;
+
+  for (uint32_t i=0; i<n; i++) {
+    ring[(h + i) & RING_MASK] = data[i];
+  }
+  _publish(n);
+
+  return n;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+// see .h for more details
+void log_init() {
+  NVIC_SetPriority(UART0_IRQn, 3);
+  NVIC_ClearPendingIRQ(UART0_IRQn);
+  NVIC_EnableIRQ(UART0_IRQn);
+
+  START_CRITICAL_SECTION;
+  is_started = true;
+  UART0->C2 |= UART0_C2_RIE_MASK;
+  _kick();
+  END_CRITICAL_SECTION;
+}
+
+// see .h for more details
+int log_write(const char* data, uint32_t nbytes) {
+
+  if (data == NULL) return -1;
+
+  // wait for room only in the main loop, and only if the UART drains
+  if (is_blocking && is_started && !is_paused && __get_IPSR() == 0) {
+    uint32_t nput = 0;
+    while (nput < nbytes) {
+      nput += _put(data + nput, nbytes - nput, true);
+      if (nput < nbytes) {
+        evt_wait(EVT_LOG_XMIT);
+      }
+    }
+    return nbytes;
+  }
+
+  if (_put(data, nbytes, false) != nbytes) {
+    START_CRITICAL_SECTION;
+    stats.ndropped += nbytes;
+    END_CRITICAL_SECTION;
+    return -1;
+  }
+  return nbytes;
+}
+
+// see .h for more details
+int log_defer(const char* fmt, uint32_t arg0, uint32_t arg1, uint32_t arg2) {
+
+  int result = -1;
+
+  START_CRITICAL_SECTION;
+  if (defer_head - defer_tail < LOG_DEFER_SIZE) {
+    deferred_t* d = &deferred[defer_head % LOG_DEFER_SIZE];
+    d->fmt = fmt;
+    d->args[0] = arg0;
+    d->args[1] = arg1;
+    d->args[2] = arg2;
+    defer_head++;
+    result = 0;
+  } else {
+    stats.ndefer_dropped++;
+  }
+  END_CRITICAL_SECTION;
+
+  return result;
+}
+
+// see .h for more details
+void log_service() {
+  while (defer_tail != defer_head) {
+    deferred_t* d = &deferred[defer_tail % LOG_DEFER_SIZE];
+    printf(d->fmt, d->args[0], d->args[1], d->args[2]);
+    defer_tail++;
+    stats.ndeferred++;
+  }
+}
+
+// see .h for more details
+void log_set_blocking(bool new_is_blocking) {
+  is_blocking = new_is_blocking;
+}
+
+// see .h for more details
+void log_flush() {
+  if (!is_started || is_paused) return;
+
+  // the handler posts once per byte while blocking
+  bool was_blocking = is_blocking;
+  is_blocking = true;
+  while (head != tail) {
+    evt_wait(EVT_LOG_XMIT);
+  }
+  is_blocking = was_blocking;
+}
+
+// see .h for more details
+void log_pause() {
+  log_flush();
+  START_CRITICAL_SECTION;
+  is_paused = true;
+  END_CRITICAL_SECTION;
+}
+
+// see .h for more details
+void log_resume() {
+  START_CRITICAL_SECTION;
+  is_paused = false;
+  _kick();
+  END_CRITICAL_SECTION;
+}
+
+// see .h for more details
+int log_getc() {
+  if (rx_tail == rx_head) return -1;
+  char c = rx_ring[rx_tail & RX_MASK];
+  rx_tail++;
+  return (uint8_t)c;
+}
+
+// see .h for more details
+void log_get_stats(log_stats_t* out) {
+  if (out == NULL) return;
+  START_CRITICAL_SECTION;
+  *out = stats;
+  END_CRITICAL_SECTION;
+}
+
+// see .h for more details
+void UART0_IRQHandler() {
+
+  uint8_t s1 = UART0->S1;
+
+  // an overrun blocks further reception until cleared
+  if (s1 & UART0_S1_OR_MASK) {
+    UART0->S1 = UART0_S1_OR_MASK;
+    stats.nrx_dropped++;
+  }
+  if (s1 & UART0_S1_RDRF_MASK) {
+    char c = UART0->D;
+    if (rx_head - rx_tail < LOG_RX_SIZE) {
+      rx_ring[rx_head & RX_MASK] = c;
+      rx_head++;
+    } else {
+      stats.nrx_dropped++;
+    }
+  }
+
+  // the stream owns the transmitter (and TIE) while paused
+  if (is_paused) return;
+
+  if (tail != head && (s1 & UART0_S1_TDRE_MASK)) {
+    LPSCI_WriteByte(UART0, ring[tail & RING_MASK]);
+    tail++;
+  }
+  if (tail == head) {
+    UART0->C2 &= ~UART0_C2_TIE_MASK;
+  } else {
+    UART0->C2 |= UART0_C2_TIE_MASK;
+  }
+
+  // wake a writer waiting for room
+  if (is_blocking) {
+    evt_post(EVT_LOG_XMIT);
+  }
+}
+
+// the C library's output for printf(), replacing the SDK's blocking one
+#ifdef __REDLIB__
+int __sys_write(int handle, char* buffer, int size) {
+  if (handle != 1 && handle != 2) return -1;
+  return log_write(buffer, size) < 0 ? -1 : 0;
+}
+#endif
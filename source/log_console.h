@@ -0,0 +1,168 @@
+/* -----------------------------------------------------------------------------
+ * log_console.h - Non-blocking debug console output through a ring buffer
+ *
+ * printf() output (through the C library's __sys_write) is copied into a
+ * LOG_BUF_SIZE byte ring buffer and returns at once; the UART0 transmit
+ * interrupt drains the ring one byte per TDRE at the console's baud rate.
+ * When the ring is full the whole write is dropped and counted, so a burst
+ * of text costs a copy instead of stalling the visualizer for the time it
+ * takes to send (about 87 us per byte at 115200 baud). Startup text and
+ * long dumps can opt into waiting for room instead (log_set_blocking()).
+ *
+ * The same interrupt receives: typed characters are kept in a LOG_RX_SIZE
+ * byte ring until log_getc() takes them, so none are lost while the main
+ * loop is busy with a frame.
+ *
+ * Interrupt handlers should not call printf(): log_defer() queues a format
+ * string and up to three 32-bit arguments, and log_service() formats them
+ * later from the main loop.
+ *
+ * The Cortex-M0+ has no exclusive load/store, so several writers cannot
+ * reserve ring space lock-free. A write masks interrupts for a few cycles
+ * to take its space and again to publish it, and copies in between with
+ * interrupts enabled, so the length of a message never adds to the time
+ * they are masked; the transmit interrupt, the only reader, takes bytes
+ * without locking.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _LOG_CONSOLE_H_
+#define _LOG_CONSOLE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LOG_BUF_SIZE    (1024)  // must be a power of 2
+#define LOG_DEFER_SIZE  (16)    // deferred messages waiting to be formatted
+#define LOG_RX_SIZE     (64)    // received characters, a power of 2
+
+// what went through the console
+typedef struct {
+  uint32_t nbytes;          // bytes accepted into the ring
+  uint32_t ndropped;        // bytes dropped because the ring was full
+  uint32_t ndeferred;       // deferred messages formatted
+  uint32_t ndefer_dropped;  // deferred messages dropped, the queue was full
+  uint32_t max_used;        // high water mark of the ring, bytes
+  uint32_t nrx_dropped;     // received characters lost (ring full, overrun)
+} log_stats_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+/*
+ * @brief   Starts draining the ring to UART0
+ *
+ * UART0 must already be initialized (BOARD_InitDebugConsole()). Text
+ * written before is kept and sent now.
+ *
+ * @param   none
+ * @return  none
+ */
+void log_init();
+
+/*
+ * @brief   Queues bytes for the console
+ *
+ * Safe to call from interrupt handlers, which never block.
+ *
+ * @param   data, the bytes
+ *          nbytes, the number of bytes
+ * @return  int, nbytes if queued, -1 if dropped
+ */
+int log_write(const char* data, uint32_t nbytes);
+
+/*
+ * @brief   Queues a message to be formatted later by log_service()
+ *
+ * Safe to call from interrupt handlers. The format string must stay valid
+ * (a literal) and take only 32-bit integer arguments.
+ *
+ * @param   fmt, the printf() format
+ *          arg0 to arg2, the arguments (unused ones are ignored)
+ * @return  0 if queued, -1 if dropped
+ */
+int log_defer(const char* fmt, uint32_t arg0, uint32_t arg1, uint32_t arg2);
+
+/*
+ * @brief   Formats the deferred messages into the ring
+ *
+ * Call from the main loop.
+ *
+ * @param   none
+ * @return  none
+ */
+void log_service();
+
+/*
+ * @brief   Selects what a write from the main loop does when the ring is
+ *          full: wait for room (true) or drop (false, the default)
+ *
+ * Writes from interrupt handlers, and writes while paused, always drop.
+ *
+ * @param   is_blocking, the policy
+ * @return  none
+ */
+void log_set_blocking(bool is_blocking);
+
+/*
+ * @brief   Waits for the text queued so far to be sent
+ *
+ * Call from the main loop. Returns at once while paused.
+ *
+ * @param   none
+ * @return  none
+ */
+void log_flush();
+
+/*
+ * @brief   Waits for the text queued so far to be sent, then holds further
+ *          text in the ring until log_resume()
+ *
+ * For a caller that takes over the UART (see uart_stream.h).
+ *
+ * @param   none
+ * @return  none
+ */
+void log_pause();
+
+/*
+ * @brief   Resumes sending the text held since log_pause()
+ *
+ * @param   none
+ * @return  none
+ */
+void log_resume();
+
+/*
+ * @brief   Takes the next character received on the console
+ *
+ * @param   none
+ * @return  int, the character, or -1 if none is waiting
+ */
+int log_getc();
+
+/*
+ * @brief   Returns the console statistics since log_init()
+ *
+ * @param   stats, destination for the statistics
+ * @return  none
+ */
+void log_get_stats(log_stats_t* stats);
+
+/*
+ * @brief   UART0 interrupt: takes a received character and sends the next
+ *          byte of the ring
+ *
+ * @param   none
+ * @return  none
+ */
+void UART0_IRQHandler();
+
+#endif // _LOG_CONSOLE_H_
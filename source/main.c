@@ -7,6 +7,7 @@
  * -----------------------------------------------------------------------------
  */
 #include <stdio.h>
+#include <inttypes.h>
 #include "board.h"
 #include "peripherals.h"
 #include "pin_mux.h"
@@ -17,6 +18,49 @@
 #include "test_dsp_analysis.h"
 #include "dsp_analysis.h"
 #include "tpm_pixl.h"
+#include "timestamp.h"
+#include "events.h"
+#include "latency.h"
+#include "sample_source.h"
+#include "visualizer.h"
+#include "viz_modes.h"
+#include "button.h"
+#include "flash_rec.h"
+#include "uart_stream.h"
+#include "adpcm.h"
+#include "log_console.h"
+#include "config.h"
+#include "shell.h"
+#include "config_store.h"
+#include "profile.h"
+
+// the FFT self-test: 0 runs it only when "test" is typed on the console, 1
+// also runs it at boot, printing its FFT table, before the visualizer starts
+#ifndef BOOT_SELF_TEST
+#define BOOT_SELF_TEST     (0)
+#endif
+
+// single key commands, see console_command()
+#ifdef DEBUG
+#define HOT_KEYS           "rcsdamfpx"
+#else
+#define HOT_KEYS           ""
+#endif
+
+#define CYCLES_PER_TICK    \
+          ((uint32_t)(BOARD_BOOTCLOCKRUN_CORE_CLOCK/TS_TICKS_PER_SEC))
+
+static store_flash_t store_flash;
+
+// waits for the frame just handed to tpm_pixl_update() to go out, and
+// returns when the strips last latched a frame: that one, unless the strips
+// were showing its colors already
+static uint32_t _led_latched() {
+  tpm_pixl_stats_t pixl;
+  tpm_pixl_flush();
+  tpm_pixl_get_stats(&pixl);
+  return pixl.t_latched;
+}
 
 void system_init() {
   // initialize hardware
@@ -24,17 +68,123 @@ void system_init() {
   BOARD_InitBootClocks();
   BOARD_InitBootPeripherals();
 
-#ifdef DEBUG
-  // initialize debug console
+  // initialize the timestamp counter and the event flags, the boot times
+  // are measured from here
+  ts_init();
+  evt_init();
+
+  // initialize debug console, printf() no longer waits for the UART
   BOARD_InitDebugConsole();
-#endif
-  
+  log_init();
+
   // initialize analog input module
   ain_init();
 
   // initialize the neopixels
   tpm_pixl_init();
+
+  // the button that steps through the visualization modes
+  btn_init();
+
+  // find the recording left in flash by an earlier run, if any
+  rec_init();
+
+  // the tunable parameters, as last saved if they still check out, changed
+  // by commands typed on the console
+  cfg_init();
+  rec_init_store_flash(&store_flash);
+  uint32_t t_load = ts_now();
+  if (!store_init(&store_flash, cfg_edit())) {
+    if (cfg_commit()) {
+      printf("config: saved parameters invalid, using defaults\r\n");
+    }
+  }
+  const config_t* config = cfg_begin_frame(NULL);
+  viz_set_config(&config->viz);
+  tpm_pixl_set_output(config->brightness, config->is_gamma,
+                      config->is_dithering);
+  shell_init(HOT_KEYS);
+  store_status_t store;
+  store_get_status(&store);
+  printf("config: save %" PRIu32 " loaded in %" PRIu32 " us\r\n", store.seq,
+         (uint32_t)(ts_elapsed(t_load)/TS_TICKS_PER_US));
+
+#ifdef DEBUG
+  // stream frame data over the debug console's UART on request
+  stream_init();
+  viz_set_spectrum_sink(stream_spectrum);
+#endif
+}
+
+#ifdef DEBUG
+// single key commands on the debug console: r/c - start a raw/compressed
+// recording to flash, s - stop recording, d - dump the recording, a/m/f/p -
+// stream raw samples, compressed samples, the spectrum or the peaks,
+// x - stop streaming
+void console_command(char key) {
+  rec_status_t rec;
+  stream_stats_t stream;
+  stream_content_t content = STREAM_OFF;
+
+  switch (key) {
+    case 'r':
+    case 'c':
+      // the erase masks interrupts for ~0.5 s, capture would only overrun
+      // and the LED frame would break off
+      tpm_pixl_flush();
+      ain_pause_capture();
+      printf(rec_start(key == 'c' ? REC_ADPCM : REC_RAW) ?
+             "rec: flash error\r\n" : "rec: recording\r\n");
+      ain_resume_capture();
+      break;
+    case 's':
+      rec_stop();
+      rec_get_status(&rec);
+      printf("rec: stopped, %" PRIu32 " of %" PRIu32 " frames\r\n",
+             rec.nrecords, rec.capacity);
+      break;
+    case 'd':
+      // far more text than the console buffers, wait for it instead
+      ain_pause_capture();
+      log_set_blocking(true);
+      rec_dump();
+      log_flush();
+      log_set_blocking(false);
+      ain_resume_capture();
+      break;
+    case 'a':
+      content = STREAM_SAMPLES;
+      break;
+    case 'm':
+      content = STREAM_ADPCM;
+      break;
+    case 'f':
+      content = STREAM_SPECTRUM;
+      break;
+    case 'p':
+      content = STREAM_PEAKS;
+      break;
+    case 'x':
+      stream_stop();
+      stream_report(NULL, &stream);
+      printf("stream: stopped, %" PRIu32 " packets, %" PRIu32 " dropped, %"
+             PRIu32 " bytes\r\n", stream.nsent, stream.ndropped,
+             stream.nbytes);
+      break;
+    default:
+      break;
+  }
+
+  if (content != STREAM_OFF) {
+    if (stream_get_content() == STREAM_OFF) {
+      printf("stream: switching to %lu baud\r\n", STREAM_BAUD);
+    }
+    if (stream_start(content)) {
+      printf("stream: baud rate not available\r\n");
+    }
+  }
 }
+#endif
 
 /*
  * @brief   Application entry point.
@@ -44,63 +194,236 @@ int main(void) {
   // initialize the system
   system_init();
 
-  // run tests
-  test_dsp();
+#if BOOT_SELF_TEST
+  // run tests, keeping all of their output
+  ain_pause_capture();
+  log_set_blocking(true);
+  test_dsp(true);
   printf("all tests passed\r\n");
+  log_set_blocking(false);
+  ain_resume_capture();
+#endif
 
-  uint32_t curr_led_colors[8];
-  uint32_t init_led_colors[8] = {
-      RED,
-      PINK,
-      PURPLE,
-      BLUE,
-      AQUA,
-      GREEN,
-      YELLOW,
-      ORANGE
-  };
-  
-  for (int i=0; i<8; i++) {
-    curr_led_colors[i] = init_led_colors[i];
-  }
-
-  int thresh[NUM_PIXELS] = {
-      4, 4, 4, 4, 4, 4, 4, 0
-  };
-
-  uint32_t bucket_indices[] = {
-      0, 2, 4, 6, 10, 15, 20, 30, 255
-  };
+  sample_source_t src;
+  ain_frame_t frame;
+  viz_frame_t viz;
+  uint32_t samples_missed = 0;
+  uint16_t center;
+  uint32_t quiet_frames = 0;
+  uint32_t t_wake = 0;
+  bool is_waking = false;
+  bool is_live = false;
 
-  uint16_t *samples;
-  int16_t *fft_mags;
-  fft_peaks curr;
+  // frames come from the microphone(s) through analog_input
+  src_adc_init(&src);
 
-  // update initial colors:
-  tpm_pixl_update(&curr_led_colors, NUM_PIXELS);
+  // update initial colors, the first ADC frame is 10 ms off: the bucket
+  // colors spread over the strip
+  const uint32_t* palette = viz_get_palette();
+  for (int i=0; i<NUM_PIXELS; i++) {
+    viz.colors[i] = palette[i*NBUCKETS/NUM_PIXELS];
+  }
+  tpm_pixl_update(viz.colors, NUM_PIXELS);
+  uint32_t t_first_led = _led_latched();
 
   // main program loop
   while(1) {
 
-      // wait until more samples are available
-      while( !ain_is_adc_samples_avail() ) {;}
+      // sleep until more samples are available
+      while( !src_is_avail(&src) ) {
+        evt_wait(EVT_ADC_FRAME);
+      }
       // get ADC samples from microphone (also begins new sampling sequence)
-      samples = ain_get_samples();
-      // get fft magnitude (power spectrum of ADC samples)
-      fft_mags = dsp_fft_mag(samples, 512);
-      // find the peaks, delineate with bucket_indices
-      dsp_find_peaks(fft_mags, &curr, bucket_indices);
-      // loop through pixels
-      for (int i=0; i<NUM_PIXELS; i++) {
-        // if the peak magnitude is above some threshold
-        if ( curr.mags[i] > thresh[i])  {
-          curr_led_colors[i] = init_led_colors[i];
-        } else {
-          curr_led_colors[i] = 0x0;
+      PROF_START(t_handoff);
+      src_get_frame(&src, &frame);
+      PROF_LAP(t_handoff, PROF_HANDOFF);
+      samples_missed += frame.samples_missed;
+
+      // take up the parameters changed since the last frame
+      bool is_config_changed;
+      const config_t* config = cfg_begin_frame(&is_config_changed);
+      if (is_config_changed) {
+        viz_set_config(&config->viz);
+        tpm_pixl_set_output(config->brightness, config->is_gamma,
+                            config->is_dithering);
+      }
+
+      // send the raw samples to the host if streaming them
+      stream_samples(&frame);
+
+      // keep a copy if recording and the last one has been written
+      rec_frame(&frame);
+
+      // after a few quiet seconds, blank the strip and stop the core until
+      // the ADC compare function sees a loud sample
+      if (dsp_peak_amplitude(frame.samples, AIN_FRAME_SAMPLES,
+                             frame.nchannels, &center) <
+          config->idle_amplitude) {
+        quiet_frames++;
+      } else {
+        quiet_frames = 0;
+      }
+      if (quiet_frames >= config->idle_enter_frames) {
+        for (int i=0; i<NUM_PIXELS; i++) {
+          viz.colors[i] = 0x0;
         }
-    }
+        tpm_pixl_update(viz.colors, NUM_PIXELS);
+        tpm_pixl_flush();
+
+        ain_arm_sound_wake(center, config->wake_amplitude);
+        evt_stop(EVT_SOUND_WAKE);
+        t_wake = ts_now();
+        ain_resume_capture();
+
+        quiet_frames = 0;
+        is_waking = true;
+        continue;
+      }
+
+      // fft, peaks and the mapping onto the pixels
+      viz_process(&frame, &viz);
+      stream_peaks(viz.peaks, frame.nchannels);
+      stream_beat(&viz.beat, &viz.peaks[0]);
+
     // update the pixels
-    tpm_pixl_update(&curr_led_colors, NUM_PIXELS);
+    tpm_pixl_set_capture_time(frame.t_capture);
+    tpm_pixl_update(viz.colors, NUM_PIXELS);
+
+    // report how soon after boot the LEDs lit and then followed the sound,
+    // as latched by the strips; waiting for it once costs one LED frame
+    if (!is_live) {
+      uint32_t t_first_frame = _led_latched();
+      printf("boot: first LED frame at %" PRIu32 " us, first analyzed "
+             "frame at %" PRIu32 " us\r\n",
+             (uint32_t)(t_first_led/TS_TICKS_PER_US),
+             (uint32_t)(t_first_frame/TS_TICKS_PER_US));
+      is_live = true;
+    }
+
+    // flash commands mask interrupts for longer than the LED stream can
+    // wait for its next chunk, so with flash work due the frame goes first
+    rec_status_t rec;
+    store_status_t store;
+    rec_get_status(&rec);
+    store_get_status(&store);
+    if (rec.is_recording || store.nwords_left) {
+      tpm_pixl_flush();
+    }
+
+    // write the recording in the time left until the next frame completes
+    uint32_t t_next = frame.t_capture + src_sample_time(AIN_FRAME_SAMPLES);
+    rec_service(t_next);
+
+    // then the saved parameters; a sector erase outlasts a frame, so capture
+    // is paused for it as for the recording's erase
+    if (store_is_erase_due()) {
+      ain_pause_capture();
+      store_erase();
+      ain_resume_capture();
+    }
+    int32_t t_left = (int32_t)(t_next - ts_now());
+    store_service(t_left > 0 ? t_left/(REC_PGM_MAX_US*TS_TICKS_PER_US) : 0);
+
+    // format what interrupt handlers logged
+    log_service();
+
+    // tuning commands typed on the console, and single key commands
+#ifdef DEBUG
+    console_command(shell_service());
+#else
+    shell_service();
+#endif
+
+    // the button steps through the modes, from the next frame on
+    if (btn_poll()) {
+      config_t* edit = cfg_edit();
+      edit->viz.mode = (edit->viz.mode + 1) % VIZ_NMODES;
+      cfg_commit();
+      printf("viz: %s\r\n", viz_modes[cfg_get()->viz.mode].name);
+    }
+
+#ifdef DEBUG
+    // report how long it took from the wake interrupt to lit LEDs, unless
+    // the frame was as blank as the one before sleeping and was not sent
+    if (is_waking) {
+      int32_t t_lit = (int32_t)(_led_latched() - t_wake);
+      if (t_lit > 0) {
+        printf("wake: %" PRIu32 " us to first LED frame\r\n",
+               (uint32_t)(t_lit/TS_TICKS_PER_US));
+      }
+    }
+#endif
+    is_waking = false;
+
+#ifdef DEBUG
+    // report the headroom left for the DSP once per second
+    uint32_t idle_permille;
+    bool is_report_due = evt_idle_report(&idle_permille);
+    if (is_report_due && stream_get_content() != STREAM_OFF) {
+      // text would garble the stream, the statistics go out as messages
+      stream_timing_t timing;
+      timing.idle_permille = idle_permille;
+      timing.samples_missed = samples_missed;
+      lat_report(&timing.latency);
+      samples_missed = 0;
+
+      stream_stats_t stream;
+      stream_report(&timing, &stream);
+    } else if (is_report_due) {
+      printf("idle: %" PRIu32 ".%" PRIu32 "%%\r\n", idle_permille/10,
+             idle_permille%10);
+
+      // and the sample-to-LED latency over the same window
+      lat_stats_t lat;
+      lat_report(&lat);
+      printf("frame %" PRIu32 ": latency us p50 %" PRIu32 " p90 %" PRIu32
+             " p99 %" PRIu32 " max %" PRIu32 ", missed samples %" PRIu32
+             "\r\n", frame.seq, lat.p50_us, lat.p90_us,
+             lat.p99_us, lat.max_us, samples_missed);
+      samples_missed = 0;
+
+      // and what became of the LED frames over the same window
+      static tpm_pixl_stats_t pixl_reported;
+      tpm_pixl_stats_t pixl;
+      tpm_pixl_get_stats(&pixl);
+      uint32_t nsent = pixl.nsent - pixl_reported.nsent;
+      printf("pixl: %" PRIu32 " frames sent, %" PRIu32 " pixels each, %"
+             PRIu32 " unchanged, %" PRIu32 " replaced, %" PRIu32
+             " dither refreshes\r\n", nsent,
+             nsent ? (pixl.npixels_sent - pixl_reported.npixels_sent)/nsent
+                   : 0,
+             pixl.nunchanged - pixl_reported.nunchanged,
+             pixl.nreplaced - pixl_reported.nreplaced,
+             pixl.nrefreshed - pixl_reported.nrefreshed);
+      pixl_reported = pixl;
+
+      // and what compressing a channel costs, to weigh it against the FFT
+      static adpcm_state_t coder;
+      static uint8_t block[ADPCM_BLOCK_BYTES(AIN_FRAME_SAMPLES)];
+      uint32_t t_start = ts_now();
+      adpcm_encode(&coder, frame.samples, AIN_FRAME_SAMPLES, frame.nchannels,
+                   block);
+      printf("adpcm: %" PRIu32 " cycles per sample\r\n",
+             ts_elapsed(t_start)*CYCLES_PER_TICK/AIN_FRAME_SAMPLES);
+
+      // and any console text lost since the last report
+      log_stats_t log;
+      static uint32_t ndropped_reported;
+      log_get_stats(&log);
+      if (log.ndropped + log.ndefer_dropped != ndropped_reported) {
+        ndropped_reported = log.ndropped + log.ndefer_dropped;
+        printf("log: %" PRIu32 " bytes, %" PRIu32 " messages dropped\r\n",
+               log.ndropped, log.ndefer_dropped);
+      }
+
+      // and the progress of a recording
+      rec_get_status(&rec);
+      if (rec.is_recording) {
+        printf("rec: %" PRIu32 " of %" PRIu32 " frames, %" PRIu32
+               " skipped\r\n", rec.nrecords, rec.capacity, rec.nskipped);
+      }
+    }
+#endif
   }
 
   // will never return
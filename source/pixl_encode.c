@@ -0,0 +1,253 @@
+/* -----------------------------------------------------------------------------
+ * pixl_encode.c - Expands 24-bit colors into the WS2812 duty cycle stream
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "pixl_encode.h"
+
+#define RED_SHIFT       (16)
+#define GRN_SHIFT       (8)
+#define BLU_SHIFT       (0)
+#define DITHER_SHIFT    (5)         // 8 steps of 32 in the 8 bit fraction
+#define DITHER_MASK     (0xE0)      // the part of the fraction dithered
+
+// the four duty cycles of a nibble, the first to go out in the low byte
+// (the Cortex-M0+ is little endian)
+#define DUTY(n, bit)    ((uint32_t)(((n) & (bit)) ? PIXL_1 : PIXL_0))
+#define NIBBLE(n)       (DUTY(n, 8) | DUTY(n, 4) << 8 | DUTY(n, 2) << 16 | \
+                         DUTY(n, 1) << 24)
+
+static const uint32_t nibble_duties[16] = {
+  NIBBLE(0),  NIBBLE(1),  NIBBLE(2),  NIBBLE(3),
+  NIBBLE(4),  NIBBLE(5),  NIBBLE(6),  NIBBLE(7),
+  NIBBLE(8),  NIBBLE(9),  NIBBLE(10), NIBBLE(11),
+  NIBBLE(12), NIBBLE(13), NIBBLE(14), NIBBLE(15)
+};
+
+// the four MOSI bytes of a color byte come from its two nibbles, two bytes
+// each: the first bit in the high half of the first byte, which goes out in
+// the low byte of the word
+#define SPI_BIT(n, bit) ((uint32_t)(((n) & (bit)) ? PIXL_SPI_1 : PIXL_SPI_0))
+#define SPI_NIBBLE(n)   (SPI_BIT(n, 8) << 4 | SPI_BIT(n, 4) | \
+                         SPI_BIT(n, 2) << 12 | SPI_BIT(n, 1) << 8)
+
+static const uint16_t nibble_spi[16] = {
+  SPI_NIBBLE(0),  SPI_NIBBLE(1),  SPI_NIBBLE(2),  SPI_NIBBLE(3),
+  SPI_NIBBLE(4),  SPI_NIBBLE(5),  SPI_NIBBLE(6),  SPI_NIBBLE(7),
+  SPI_NIBBLE(8),  SPI_NIBBLE(9),  SPI_NIBBLE(10), SPI_NIBBLE(11),
+  SPI_NIBBLE(12), SPI_NIBBLE(13), SPI_NIBBLE(14), SPI_NIBBLE(15)
+};
+
+// 0 to 7 in bit-reversed order
+static const uint8_t dither_order[PIXL_DITHER_STEPS] = {
+  0, 4, 2, 6, 1, 5, 3, 7
+};
+
+// see .h for more details
+const uint16_t pixl_gamma[256] = {
+      0,     0,     2,     4,     7,    11,    17,    24,
+     32,    42,    53,    65,    78,    94,   110,   128,
+    148,   169,   191,   216,   241,   269,   298,   328,
+    360,   394,   430,   467,   506,   547,   589,   633,
+    679,   726,   776,   827,   880,   934,   991,  1049,
+   1109,  1171,  1235,  1300,  1368,  1437,  1508,  1581,
+   1656,  1733,  1812,  1893,  1975,  2060,  2146,  2235,
+   2325,  2417,  2512,  2608,  2706,  2806,  2908,  3013,
+   3119,  3227,  3337,  3450,  3564,  3680,  3798,  3919,
+   4041,  4166,  4292,  4421,  4552,  4685,  4819,  4956,
+   5096,  5237,  5380,  5525,  5673,  5823,  5974,  6128,
+   6284,  6442,  6603,  6765,  6930,  7097,  7266,  7437,
+   7610,  7786,  7963,  8143,  8325,  8509,  8696,  8885,
+   9075,  9268,  9464,  9661,  9861, 10063, 10267, 10474,
+  10682, 10893, 11107, 11322, 11540, 11760, 11982, 12207,
+  12433, 12663, 12894, 13128, 13363, 13602, 13842, 14085,
+  14330, 14578, 14827, 15080, 15334, 15591, 15850, 16111,
+  16375, 16641, 16909, 17180, 17453, 17729, 18006, 18287,
+  18569, 18854, 19141, 19431, 19723, 20017, 20314, 20613,
+  20915, 21218, 21525, 21833, 22144, 22458, 22774, 23092,
+  23413, 23736, 24062, 24390, 24720, 25053, 25388, 25726,
+  26066, 26408, 26753, 27101, 27451, 27803, 28158, 28515,
+  28875, 29237, 29602, 29969, 30338, 30710, 31085, 31462,
+  31841, 32223, 32608, 32995, 33384, 33776, 34170, 34567,
+  34967, 35369, 35773, 36180, 36589, 37001, 37416, 37833,
+  38252, 38674, 39099, 39526, 39956, 40388, 40823, 41260,
+  41700, 42142, 42587, 43034, 43484, 43937, 44392, 44849,
+  45310, 45772, 46238, 46706, 47176, 47649, 48125, 48603,
+  49084, 49567, 50053, 50542, 51033, 51526, 52023, 52522,
+  53023, 53527, 54034, 54543, 55055, 55570, 56087, 56607,
+  57129, 57654, 58182, 58712, 59245, 59780, 60318, 60859,
+  61402, 61948, 62497, 63048, 63602, 64159, 64718, 65280
+};
+
+// the byte sent for a color byte, through the output stage; collects the
+// fraction left to dither in fractions
+static inline uint32_t _output(uint32_t byte, const pixl_output_t* output,
+                               uint32_t* fractions) {
+
+  uint32_t level = output->gamma != NULL ? output->gamma[byte] : byte << 8;
+  level = (level*output->brightness) >> 8;
+  *fractions |= level & DITHER_MASK;
+  level = (level + output->dither) >> 8;
+  return level > 0xFF ? 0xFF : level;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+// see .h for more details
+uint32_t pixl_dither(uint32_t frame) {
+  return (uint32_t)dither_order[frame % PIXL_DITHER_STEPS] << DITHER_SHIFT;
+}
+
+// see .h for more details
+uint32_t pixl_encode(const uint32_t* colors, uint32_t npixels,
+                     const pixl_output_t* output, uint32_t* out) {
+
+  const uint32_t* start = colors;
+  const uint32_t* end = colors + npixels;
+  uint32_t ndither = 0;
+
+  // as they are, when the output stage would not change a byte
+  if (output != NULL && output->gamma == NULL &&
+      output->brightness == PIXL_FULL_BRIGHTNESS) {
+    output = NULL;
+  }
+
+  while (colors < end) {
+    uint32_t grn = (*colors >> GRN_SHIFT) & 0xFF;
+    uint32_t red = (*colors >> RED_SHIFT) & 0xFF;
+    uint32_t blu = (*colors >> BLU_SHIFT) & 0xFF;
+    colors++;
+
+    if (output != NULL) {
+      uint32_t fractions = 0;
+      grn = _output(grn, output, &fractions);
+      red = _output(red, output, &fractions);
+      blu = _output(blu, output, &fractions);
+      if (fractions) {
+        ndither = colors - start;
+      }
+    }
+
+    // green first, then red, then blue
+    out[0] = nibble_duties[grn >> 4];
+    out[1] = nibble_duties[grn & 0xF];
+    out[2] = nibble_duties[red >> 4];
+    out[3] = nibble_duties[red & 0xF];
+    out[4] = nibble_duties[blu >> 4];
+    out[5] = nibble_duties[blu & 0xF];
+    out += PIXL_WORDS_PER_PIXEL;
+  }
+
+  return ndither;
+}
+
+// see .h for more details
+uint32_t pixl_encode_spi(const uint32_t* colors, uint32_t npixels,
+                         const pixl_output_t* output, uint32_t* out) {
+
+  const uint32_t* start = colors;
+  const uint32_t* end = colors + npixels;
+  uint32_t ndither = 0;
+
+  // as they are, when the output stage would not change a byte
+  if (output != NULL && output->gamma == NULL &&
+      output->brightness == PIXL_FULL_BRIGHTNESS) {
+    output = NULL;
+  }
+
+  while (colors < end) {
+    uint32_t grn = (*colors >> GRN_SHIFT) & 0xFF;
+    uint32_t red = (*colors >> RED_SHIFT) & 0xFF;
+    uint32_t blu = (*colors >> BLU_SHIFT) & 0xFF;
+    colors++;
+
+    if (output != NULL) {
+      uint32_t fractions = 0;
+      grn = _output(grn, output, &fractions);
+      red = _output(red, output, &fractions);
+      blu = _output(blu, output, &fractions);
+      if (fractions) {
+        ndither = colors - start;
+      }
+    }
+
+    // green first, then red, then blue
+    out[0] = nibble_spi[grn >> 4] | (uint32_t)nibble_spi[grn & 0xF] << 16;
+    out[1] = nibble_spi[red >> 4] | (uint32_t)nibble_spi[red & 0xF] << 16;
+    out[2] = nibble_spi[blu >> 4] | (uint32_t)nibble_spi[blu & 0xF] << 16;
+    out += PIXL_SPI_WORDS_PER_PIXEL;
+  }
+
+  return ndither;
+}
+
+// see .h for more details
+uint32_t pixl_encode_bitwise(const uint32_t* colors, uint32_t npixels,
+                             const pixl_output_t* output, uint32_t* out) {
+
+  uint32_t mask;
+  int tpm_idx = 0;
+  uint8_t *tpm_output = (uint8_t*)out;
+  const uint32_t *color = colors;
+  const uint32_t *end = colors + npixels;
+  uint32_t ndither = 0;
+
+  while ( color<end ) {
+
+    uint32_t grb = *color;
+    if (output != NULL) {
+      uint32_t fractions = 0;
+      grb = (_output((grb >> RED_SHIFT) & 0xFF, output, &fractions)
+                << RED_SHIFT) |
+            (_output((grb >> GRN_SHIFT) & 0xFF, output, &fractions)
+                << GRN_SHIFT) |
+            (_output((grb >> BLU_SHIFT) & 0xFF, output, &fractions)
+                << BLU_SHIFT);
+      if (fractions) {
+        ndither = color - colors + 1;
+      }
+    }
+
+    // generate tpm bytes for green first
+    for (mask=0x8000; mask>0x80; mask>>=1) {
+
+       tpm_output[tpm_idx] = PIXL_0;
+       if (grb & mask) {
+         tpm_output[tpm_idx] = PIXL_1;
+       }
+       tpm_idx++;
+    }
+
+    // generate tpm bytes for red next
+    for (mask=0x800000; mask>0x8000; mask>>=1) {
+      tpm_output[tpm_idx] = PIXL_0;
+      if (grb & mask) {
+        tpm_output[tpm_idx] = PIXL_1;
+      }
+      tpm_idx++;
+    }
+
+    // generate tpm bytes for blue next
+    for (mask=0x80; mask>0; mask>>=1) {
+      tpm_output[tpm_idx] = PIXL_0;
+      if (grb & mask) {
+        tpm_output[tpm_idx] = PIXL_1;
+      }
+      tpm_idx++;
+    }
+
+  color++;
+  } // end for loop over npixels
+
+  return ndither;
+}
@@ -0,0 +1,110 @@
+/* -----------------------------------------------------------------------------
+ * pixl_encode.h - Expands 24-bit colors into the WS2812 duty cycle stream
+ *
+ * Each bit of a pixel becomes one TPM1 period, and one byte in the stream
+ * holds its duty cycle: PIXL_0 for a 0 bit, PIXL_1 for a 1 bit. The bytes go
+ * out green, red, blue, most significant bit first. The encoder looks up
+ * each half of a color byte in a 16 entry table of four duty cycles, so a
+ * byte becomes two word stores, with no branch per bit.
+ *
+ * In the same pass each color byte can go through an output stage (see
+ * pixl_output_t): a gamma table to an 8.8 fixed point level, a global
+ * brightness, and temporal dithering of the fraction that is left. The
+ * dither adds one of PIXL_DITHER_STEPS offsets to the level before the
+ * fraction is dropped, a different one each frame, so over that many frames
+ * a level shows at 3 bits finer than the byte sent: dim colors fade in
+ * steps of 1/8 rather than banding.
+ *
+ * The SPI backend (PIXL_SPI, see tpm_pixl.h) sends each bit as four bits
+ * of MOSI instead: PIXL_SPI_0 or PIXL_SPI_1, so an SPI byte carries two
+ * WS2812 bits and a color byte becomes one word, looked up a nibble at a
+ * time in the same way.
+ *
+ * The former bit by bit encoder is kept as the reference the host tests
+ * check against, and for the shell's bench command.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _PIXL_ENCODE_H_
+#define _PIXL_ENCODE_H_
+
+#include <stdint.h>
+
+#define PIXL_0                (0x1)   // duty cycle of a 0 bit, 333 ns high
+#define PIXL_1                (0x3)   // duty cycle of a 1 bit, 1 us high
+#define PIXL_WORDS_PER_PIXEL  (6)     // 24 duty cycle bytes
+#define PIXL_SPI_0            (0x8)   // MOSI bits of a 0 bit, 1 high of 4
+#define PIXL_SPI_1            (0xC)   // MOSI bits of a 1 bit, 2 high of 4
+#define PIXL_SPI_WORDS_PER_PIXEL  (3) // 12 SPI bytes
+#define PIXL_FULL_BRIGHTNESS  (256)
+#define PIXL_DITHER_STEPS     (8)
+
+// the output stage applied to each color byte
+typedef struct {
+  const uint16_t* gamma;  // from the byte to an 8.8 level, NULL for linear
+  uint32_t brightness;    // scales the level, PIXL_FULL_BRIGHTNESS is 1.0
+  uint32_t dither;        // added to the level, pixl_dither(), 0 for none
+} pixl_output_t;
+
+// gamma 2.2, from a color byte to the 8.8 fixed point level that looks that
+// bright
+extern const uint16_t pixl_gamma[256];
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+/*
+ * @brief   Returns the dither offset of a frame
+ *
+ * The offsets step through the fraction in bit-reversed order, so a level
+ * rounds up in frames spread evenly over PIXL_DITHER_STEPS.
+ *
+ * @param   frame, counts up by one for each frame sent
+ * @return  uint32_t, the offset for pixl_output_t.dither
+ */
+uint32_t pixl_dither(uint32_t frame);
+
+/*
+ * @brief   Encodes pixels with the nibble table
+ *
+ * @param   colors, the 24-bit 0xRRGGBB colors
+ *          npixels, the number of colors
+ *          output, the output stage, or NULL to send the colors as they are
+ *          out, destination for PIXL_WORDS_PER_PIXEL words per pixel, sent
+ *              in byte order
+ * @return  uint32_t, the pixels up to and including the last one whose
+ *              levels have a fraction to dither, 0 if none
+ */
+uint32_t pixl_encode(const uint32_t* colors, uint32_t npixels,
+                     const pixl_output_t* output, uint32_t* out);
+
+/*
+ * @brief   Encodes pixels into the SPI backend's MOSI bytes
+ *
+ * @param   colors, the 24-bit 0xRRGGBB colors
+ *          npixels, the number of colors
+ *          output, the output stage, or NULL to send the colors as they are
+ *          out, destination for PIXL_SPI_WORDS_PER_PIXEL words per pixel,
+ *              sent in byte order, each byte most significant bit first
+ * @return  uint32_t, as pixl_encode()
+ */
+uint32_t pixl_encode_spi(const uint32_t* colors, uint32_t npixels,
+                         const pixl_output_t* output, uint32_t* out);
+
+/*
+ * @brief   Encodes pixels bit by bit, the reference for pixl_encode()
+ *
+ * @param   see pixl_encode()
+ * @return  see pixl_encode()
+ */
+uint32_t pixl_encode_bitwise(const uint32_t* colors, uint32_t npixels,
+                             const pixl_output_t* output, uint32_t* out);
+
+#endif // _PIXL_ENCODE_H_
@@ -0,0 +1,98 @@
+/* -----------------------------------------------------------------------------
+ * profile.c - Per-stage timing of the pipeline, with log2 histograms
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+#include "profile.h"
+
+static const char* stage_names[PROF_NSTAGES] = {
+  "handoff", "window", "fft", "magnitude", "peaks", "map", "led_encode",
+  "led_refill", "led_xmit"
+};
+
+static prof_stats_t stats[PROF_NSTAGES];
+
+// prints ticks as microseconds with one decimal
+static void _print_us(uint64_t ticks) {
+  uint64_t tenths = ticks*10/TS_TICKS_PER_US;
+  printf(" %" PRIu32 ".%" PRIu32, (uint32_t)(tenths/10),
+         (uint32_t)(tenths%10));
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+// see .h for more details
+void prof_record(prof_stage_t stage, uint32_t ticks) {
+
+  if (stage >= PROF_NSTAGES) return;
+  prof_stats_t* s = &stats[stage];
+
+  // the bin of the highest bit set, the M0+ has no CLZ instruction
+  uint32_t bin = 0;
+  while (bin < PROF_NBINS-1 && (ticks >> (bin+1)) != 0) {
+    bin++;
+  }
+  if (s->hist[bin] < UINT16_MAX) {
+    s->hist[bin]++;
+  }
+
+  if (s->count == 0 || ticks < s->min_ticks) s->min_ticks = ticks;
+  if (ticks > s->max_ticks) s->max_ticks = ticks;
+  s->sum_ticks += ticks;
+  s->count++;
+}
+
+// see .h for more details
+int prof_get(prof_stage_t stage, prof_stats_t* dest) {
+  if (stage >= PROF_NSTAGES || dest == NULL) return -1;
+  *dest = stats[stage];
+  return 0;
+}
+
+// see .h for more details
+void prof_report() {
+
+  printf("prof: stage count min mean max (us)\r\n");
+  for (int i=0; i<PROF_NSTAGES; i++) {
+    prof_stats_t* s = &stats[i];
+    if (s->count == 0) continue;
+    printf("prof: %s %" PRIu32, stage_names[i], s->count);
+    _print_us(s->min_ticks);
+    _print_us(s->sum_ticks/s->count);
+    _print_us(s->max_ticks);
+    printf("\r\n");
+  }
+
+  // lower bin edge in us, then the count
+  for (int i=0; i<PROF_NSTAGES; i++) {
+    prof_stats_t* s = &stats[i];
+    if (s->count == 0) continue;
+    printf("prof: %s", stage_names[i]);
+    for (int bin=0; bin<PROF_NBINS; bin++) {
+      if (s->hist[bin] == 0) continue;
+      _print_us(bin ? 1UL << bin : 0);
+      printf(":%u", s->hist[bin]);
+    }
+    printf("\r\n");
+  }
+
+  prof_reset();
+}
+
+// see .h for more details
+void prof_reset() {
+  memset(stats, 0, sizeof(stats));
+}
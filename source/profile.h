@@ -0,0 +1,121 @@
+/* -----------------------------------------------------------------------------
+ * profile.h - Per-stage timing of the pipeline, with log2 histograms
+ *
+ * The boundaries of each stage of a frame (taking the frame from the
+ * source, windowing, FFT, magnitudes, peak search, beat and color mapping,
+ * LED encoding, refilling the LED chunks and LED transmission) are
+ * timestamped with ts_now() (TPM2, 1/3 us), and each stage keeps its count,
+ * minimum, mean, maximum and a histogram of log2 wide bins. Host builds
+ * link a clock_gettime() based ts_now() (host/ts_host.c), so viz_host
+ * reports the same stages.
+ *
+ * The instrumentation is only compiled in with PROFILE defined; without it
+ * the PROF_ macros expand to nothing and the stages cost no time or RAM.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _PROFILE_H_
+#define _PROFILE_H_
+
+#include <stdint.h>
+#include "timestamp.h"
+
+#define PROF_NBINS  (20)   // bin k holds [2^k, 2^(k+1)) ticks, the last
+                           // also collects any overflow
+
+// the timed stages
+typedef enum {
+  PROF_HANDOFF,      // src_get_frame(), the frame from capture
+  PROF_WINDOW,       // level shift and Hann window, per channel
+  PROF_FFT,          // arm_rfft_q15(), per channel
+  PROF_MAGNITUDE,    // squared magnitudes, per channel
+  PROF_PEAKS,        // peak search in the buckets, per channel
+  PROF_MAP,          // beat detection and the mapping onto the pixels
+  PROF_LED_ENCODE,   // the first two chunks of the TPM1 duty cycle stream
+  PROF_LED_REFILL,   // the DMA1 interrupt, encoding a chunk once the next
+                     // has been started
+  PROF_LED_XMIT,     // the bit stream and reset pattern out to the strip
+  PROF_NSTAGES
+} prof_stage_t;
+
+// the timings of one stage
+typedef struct {
+  uint32_t count;
+  uint32_t min_ticks;
+  uint32_t max_ticks;
+  uint64_t sum_ticks;
+  uint16_t hist[PROF_NBINS];
+} prof_stats_t;
+
+#ifdef PROFILE
+// starts timing in a new local variable t
+#define PROF_START(t)         uint32_t t = ts_now()
+// records the time since t for stage, and restarts t for the next stage
+#define PROF_LAP(t, stage)    do { \
+                                uint32_t prof_now = ts_now(); \
+                                prof_record((stage), prof_now - (t)); \
+                                (t) = prof_now; \
+                              } while (0)
+// starts timing in an existing variable t
+#define PROF_MARK(t)          ((t) = ts_now())
+// records a time measured some other way
+#define PROF_RECORD(stage, ticks)  prof_record((stage), (ticks))
+#else
+#define PROF_START(t)
+#define PROF_LAP(t, stage)
+#define PROF_MARK(t)
+#define PROF_RECORD(stage, ticks)
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+/*
+ * @brief   Adds a time to a stage
+ *
+ * Safe to call from an interrupt handler, as long as each stage is
+ * recorded from one context only.
+ *
+ * @param   stage, the stage timed
+ *          ticks, its duration in timestamp ticks (see timestamp.h)
+ * @return  none
+ */
+void prof_record(prof_stage_t stage, uint32_t ticks);
+
+/*
+ * @brief   Copies the timings of a stage
+ *
+ * @param   stage, the stage
+ *          stats, destination for its timings
+ * @return  0 on success, -1 for an unknown stage
+ */
+int prof_get(prof_stage_t stage, prof_stats_t* stats);
+
+/*
+ * @brief   Prints the timings of every stage and starts over
+ *
+ * One line per stage with the count and the minimum, mean and maximum in
+ * microseconds, then one line per stage of the non-empty histogram bins,
+ * each as the lower edge of the bin in microseconds and its count.
+ *
+ * @param   none
+ * @return  none
+ */
+void prof_report();
+
+/*
+ * @brief   Clears the timings of every stage
+ *
+ * @param   none
+ * @return  none
+ */
+void prof_reset();
+
+#endif // _PROFILE_H_
@@ -0,0 +1,93 @@
+/* -----------------------------------------------------------------------------
+ * sample_source.c - A common interface for anything that produces frames
+ *
+ * The generic entry points and the memory backend. This file does not touch
+ * any hardware and is shared with the host build.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "timestamp.h"
+#include "sample_source.h"
+
+// timestamp ticks per 48 kHz sample is 62.5, kept as a ratio
+#define TICKS_PER_SAMPLE_NUM  (TS_TICKS_PER_SEC/1000)
+#define TICKS_PER_SAMPLE_DEN  (48)
+
+// see .h for more details
+bool src_is_avail(sample_source_t* src) {
+  if (src == NULL || src->is_avail == NULL) return false;
+  return src->is_avail(src);
+}
+
+// see .h for more details
+int src_get_frame(sample_source_t* src, ain_frame_t* frame) {
+  if (src == NULL || src->get_frame == NULL || frame == NULL) return -1;
+  return src->get_frame(src, frame);
+}
+
+// see .h for more details
+uint32_t src_sample_time(uint32_t sample_idx) {
+  return (uint32_t)(((uint64_t)sample_idx*TICKS_PER_SAMPLE_NUM)/
+                    TICKS_PER_SAMPLE_DEN);
+}
+
+static bool _memory_is_avail(sample_source_t* src) {
+  src_memory_ctx_t* ctx = src->ctx;
+  return ctx->is_looping || ctx->next < ctx->nframes;
+}
+
+static int _memory_get_frame(sample_source_t* src, ain_frame_t* frame) {
+
+  src_memory_ctx_t* ctx = src->ctx;
+
+  if (!_memory_is_avail(src)) return -1;
+  if (ctx->next >= ctx->nframes) {
+    ctx->next = 0;
+  }
+
+  // the sample index keeps counting across loops
+  uint32_t sample_idx = ctx->seq*AIN_FRAME_SAMPLES;
+  uint32_t last_idx = sample_idx + AIN_FRAME_SAMPLES - 1;
+
+  frame->samples = ctx->samples + ctx->next*AIN_FRAME_SAMPLES*ctx->nchannels;
+  frame->nchannels = ctx->nchannels;
+  frame->seq = ++ctx->seq;
+  frame->sample_idx = sample_idx;
+  frame->samples_missed = 0;
+  frame->t_capture = src_sample_time(last_idx);
+  ctx->next++;
+
+  return 0;
+}
+
+// see .h for more details
+int src_memory_init(sample_source_t* src, src_memory_ctx_t* ctx,
+                    uint16_t* samples, uint32_t nsamples, uint32_t nchannels,
+                    bool is_looping) {
+
+  // error case
+  if (src == NULL || ctx == NULL || samples == NULL || nchannels == 0 ||
+      nsamples < AIN_FRAME_SAMPLES*nchannels) {
+    return -1;
+  }
+
+  ctx->samples = samples;
+  ctx->nframes = nsamples/(AIN_FRAME_SAMPLES*nchannels);
+  ctx->nchannels = nchannels;
+  ctx->next = 0;
+  ctx->seq = 0;
+  ctx->is_looping = is_looping;
+
+  src->is_avail = _memory_is_avail;
+  src->get_frame = _memory_get_frame;
+  src->ctx = ctx;
+
+  return 0;
+}
@@ -0,0 +1,108 @@
+/* -----------------------------------------------------------------------------
+ * sample_source.h - A common interface for anything that produces frames
+ *
+ * The analysis pipeline pulls ain_frame_t frames from a sample_source_t
+ * without knowing where they come from. On target the ADC backend wraps
+ * analog_input; the memory backend replays a buffer of samples (on target
+ * or host) and host builds add WAV file and synthetic signal backends (see
+ * host/), so the same DSP and LED mapping code can be run without the board.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _SAMPLE_SOURCE_H_
+#define _SAMPLE_SOURCE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "analog_input.h"
+
+typedef struct sample_source sample_source_t;
+
+// a sample source, filled in by one of the src_*_init() functions
+struct sample_source {
+  bool (*is_avail)(sample_source_t* src);                 // frame ready?
+  int  (*get_frame)(sample_source_t* src, ain_frame_t* frame); // take it
+  void* ctx;                                              // backend state
+};
+
+// state of the memory backend
+typedef struct {
+  uint16_t* samples;    // interleaved samples to replay
+  uint32_t nframes;     // number of whole frames in samples
+  uint32_t nchannels;   // interleaved channels in samples
+  uint32_t next;        // index of the next frame to return
+  uint32_t seq;         // sequence number of the last frame returned
+  bool is_looping;      // start over after the last frame
+} src_memory_ctx_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+/*
+ * @brief   Returns whether a new frame can be taken from the source
+ *
+ * @param   src, the sample source
+ * @return  bool, true  - a frame is available
+ *                false - no frame yet (or the source is exhausted)
+ */
+bool src_is_avail(sample_source_t* src);
+
+/*
+ * @brief   Takes the next frame from the source
+ *
+ * The frame stays valid until the next call on the same source.
+ *
+ * @param   src, the sample source
+ *          frame, destination for the frame and its metadata
+ * @return  0 on success, -1 if no frame is available or on error
+ */
+int src_get_frame(sample_source_t* src, ain_frame_t* frame);
+
+/*
+ * @brief   Converts a 48 kHz sample index into timestamp ticks
+ *
+ * Used by the backends that do not capture live to give their frames a
+ * t_capture consistent with the sample clock (see timestamp.h).
+ *
+ * @param   sample_idx, the sample index counted from the start of the source
+ * @return  uint32_t, the time of that sample in timestamp ticks
+ */
+uint32_t src_sample_time(uint32_t sample_idx);
+
+/*
+ * @brief   Sets up a source that returns frames captured by analog_input
+ *
+ * Target only. ain_init() must be called separately.
+ *
+ * @param   src, the sample source to initialize
+ * @return  none
+ */
+void src_adc_init(sample_source_t* src);
+
+/*
+ * @brief   Sets up a source that replays frames from a buffer in memory
+ *
+ * Frames are returned in place (no copy). Each frame's t_capture is derived
+ * from its position in the buffer at the 48 kHz sample clock, in timestamp
+ * ticks (see timestamp.h), as if the buffer had been captured live.
+ *
+ * @param   src, the sample source to initialize
+ *          ctx, storage for the backend state, must outlive src
+ *          samples, the interleaved samples to replay
+ *          nsamples, the total number of samples (all channels) in samples
+ *          nchannels, the number of interleaved channels
+ *          is_looping, whether to start over after the last whole frame
+ * @return  0 on success, -1 on error (e.g. less than one frame of samples)
+ */
+int src_memory_init(sample_source_t* src, src_memory_ctx_t* ctx,
+                    uint16_t* samples, uint32_t nsamples, uint32_t nchannels,
+                    bool is_looping);
+
+#endif // _SAMPLE_SOURCE_H_
@@ -0,0 +1,332 @@
+/* -----------------------------------------------------------------------------
+ * shell.c - Console commands to tune the pipeline while it runs
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include "log_console.h"
+#include "config.h"
+#include "config_store.h"
+#include "timestamp.h"
+#include "test_dsp_analysis.h"
+#include "profile.h"
+#include "pixl_encode.h"
+#include "effects.h"
+#include "viz_modes.h"
+#include "tpm_pixl.h"
+#include "clock_config.h"
+#include "shell.h"
+
+#define MAX_ARGS  (NBUCKETS+1)   // edges takes the most
+#define BENCH_REPEATS   (10)
+#define CYCLES_PER_TICK \
+          ((uint32_t)(BOARD_BOOTCLOCKRUN_CORE_CLOCK/TS_TICKS_PER_SEC))
+
+static const char* hot_keys = "";
+static char line[SHELL_LINE_SIZE+1];
+static uint32_t nchars;
+
+// parses exactly count numbers, returns 0 on success or -1
+static int _parse_numbers(char** args, int nargs, uint32_t* values,
+                          int count, int base) {
+  if (nargs != count) return -1;
+  for (int i=0; i<count; i++) {
+    char* end;
+    values[i] = strtoul(args[i], &end, base);
+    if (end == args[i] || *end != '\0') return -1;
+  }
+  return 0;
+}
+
+// prints the newest parameters as the commands that set them
+static void _print_config() {
+
+  const config_t* config = cfg_get();
+  const viz_config_t* viz = &config->viz;
+
+  printf("edges");
+  for (int i=0; i<=NBUCKETS; i++) {
+    printf(" %" PRIu32, viz->bucket_hz[i]);
+  }
+  printf("\r\nthresh");
+  for (int i=0; i<NBUCKETS; i++) {
+    printf(" %d", viz->thresh[i]);
+  }
+  printf("\r\ngain %" PRIu32 "\r\n", viz->gain_pct);
+  for (int i=0; i<NBUCKETS; i++) {
+    printf("led %d %06" PRIx32 "\r\n", i, viz->palette[i]);
+  }
+  printf("nfft %" PRIu32 "\r\n", viz->fft_size);
+  printf("view %s\r\n",
+         viz->stereo_view == VIZ_STEREO_SPLIT ? "split" : "balance");
+  printf("viz %s\r\n", viz_modes[viz->mode].name);
+  printf("gradient %" PRIu32 " %" PRIu32 "\r\n", viz->gradient,
+         viz->fade_rate);
+  printf("beat %" PRIu32 " %" PRIu32 " %" PRIu32 "\r\n", viz->beat_ratio_x4,
+         viz->beat_min_energy, viz->beat_holdoff);
+  printf("idle %" PRIu32 " %" PRIu32 " %" PRIu32 "\r\n",
+         config->idle_amplitude, config->idle_enter_frames,
+         config->wake_amplitude);
+  printf("output %" PRIu32 " %d %d\r\n", config->brightness,
+         config->is_gamma, config->is_dithering);
+}
+
+// times encoding strips of a few lengths for the LED driver, chunk by chunk
+// as it does: with the nibble table, then with the output stage as well,
+// then with the former bit by bit encoder
+static void _bench() {
+
+  static const uint32_t lengths[] = { 8, 60, 300 };
+  const pixl_output_t output = { pixl_gamma, PIXL_FULL_BRIGHTNESS/2,
+                                 pixl_dither(1) };
+  uint32_t colors[PIXL_CHUNK_PIXELS];
+  uint32_t out[PIXL_CHUNK_PIXELS*PIXL_WORDS_PER_PIXEL];
+  uint32_t cycles[3];
+
+  for (int i=0; i<PIXL_CHUNK_PIXELS; i++) {
+    colors[i] = cfg_get()->viz.palette[i % NBUCKETS];
+  }
+
+  for (int i=0; i<sizeof(lengths)/sizeof(lengths[0]); i++) {
+    for (int encoder=0; encoder<3; encoder++) {
+      uint32_t t_start = ts_now();
+      for (int n=0; n<BENCH_REPEATS; n++) {
+        for (uint32_t done=0; done<lengths[i]; done+=PIXL_CHUNK_PIXELS) {
+          uint32_t npixels = lengths[i] - done;
+          if (npixels > PIXL_CHUNK_PIXELS) npixels = PIXL_CHUNK_PIXELS;
+          if (encoder == 2) {
+            pixl_encode_bitwise(colors, npixels, NULL, out);
+          } else {
+            pixl_encode(colors, npixels, encoder ? &output : NULL, out);
+          }
+        }
+      }
+      cycles[encoder] = ts_elapsed(t_start)*CYCLES_PER_TICK/
+                           (BENCH_REPEATS*lengths[i]);
+    }
+    printf("bench: %" PRIu32 " pixels, %" PRIu32 " cycles per pixel, %"
+           PRIu32 " with the output stage, %" PRIu32 " bit by bit\r\n",
+           lengths[i], cycles[0], cycles[1], cycles[2]);
+  }
+
+  // a gradient shaded and cross-faded, chunk by chunk, the per pixel work
+  // of the visualizer's effects
+  uint32_t shown[PIXL_CHUNK_PIXELS] = { 0 };
+  uint8_t energy[PIXL_CHUNK_PIXELS];
+  uint32_t npixels = lengths[sizeof(lengths)/sizeof(lengths[0]) - 1];
+  uint32_t t_start = ts_now();
+  for (int n=0; n<BENCH_REPEATS; n++) {
+    for (uint32_t done=0; done<npixels; done+=PIXL_CHUNK_PIXELS) {
+      for (int i=0; i<PIXL_CHUNK_PIXELS; i++) {
+        energy[i] = fx_intensity(done + i);
+        colors[i] = fx_scale(fx_palette_color(&fx_palettes[0], done + i),
+                             energy[i] + 1);
+      }
+      fx_crossfade(shown, colors, energy, PIXL_CHUNK_PIXELS, FX_FULL/4);
+    }
+  }
+  printf("bench: %" PRIu32 " pixels, %" PRIu32 " cycles per pixel for "
+         "the effects\r\n", npixels,
+         ts_elapsed(t_start)*CYCLES_PER_TICK/(BENCH_REPEATS*npixels));
+}
+
+// prints what each mode has cost per frame so far, and the RAM it keeps
+static void _print_modes() {
+
+  viz_mode_id_t active = cfg_get()->viz.mode;
+
+  printf("viz: mode frames, cycles per frame mean max, bytes\r\n");
+  for (int i=0; i<VIZ_NMODES; i++) {
+    viz_mode_stats_t stats;
+    viz_get_mode_stats(i, &stats);
+    uint32_t mean = stats.count ?
+                    stats.sum_ticks*CYCLES_PER_TICK/stats.count : 0;
+    printf("viz: %s%s %" PRIu32 " %" PRIu32 " %" PRIu32 " %" PRIu32 "\r\n",
+           viz_modes[i].name, i == active ? "*" : "", stats.count,
+           mean, stats.max_ticks*CYCLES_PER_TICK,
+           viz_modes[i].ram_bytes);
+  }
+}
+
+// runs one command line
+static void _execute(char* cmd) {
+
+  char* args[MAX_ARGS+2];
+  int nargs = 0;
+  for (char* arg = strtok(cmd, " \t"); arg != NULL && nargs < MAX_ARGS+2;
+       arg = strtok(NULL, " \t")) {
+    args[nargs++] = arg;
+  }
+  if (nargs == 0) return;
+
+  if (!strcmp(args[0], "?") || !strcmp(args[0], "help")) {
+    _print_config();
+    return;
+  }
+  if (!strcmp(args[0], "test") && nargs == 1) {
+    // one FFT and the peak search, a few ms between frames
+    uint32_t t_start = ts_now();
+    test_dsp(false);
+    printf("test: dsp passed in %" PRIu32 " us\r\n",
+           (uint32_t)(ts_elapsed(t_start)/TS_TICKS_PER_US));
+    return;
+  }
+  if (!strcmp(args[0], "bench") && nargs == 1) {
+    // a few ms, between frames
+    _bench();
+    return;
+  }
+  if (!strcmp(args[0], "viz") && nargs == 1) {
+    _print_modes();
+    return;
+  }
+  if (!strcmp(args[0], "timing") && nargs == 1) {
+#ifdef PROFILE
+    prof_report();
+#else
+    printf("shell: built without PROFILE\r\n");
+#endif
+    return;
+  }
+  if (!strcmp(args[0], "write") && nargs == 1) {
+    // written to flash between the next frames
+    printf(store_save(cfg_get()) ? "shell: busy\r\n" : "ok\r\n");
+    return;
+  }
+
+  config_t* config = cfg_edit();
+  viz_config_t* viz = &config->viz;
+  uint32_t values[MAX_ARGS];
+  char** vargs = args+1;
+  int nvalues = nargs-1;
+  int result = -1;
+
+  if (!strcmp(args[0], "edges")) {
+    result = _parse_numbers(vargs, nvalues, values, NBUCKETS+1, 10);
+    for (int i=0; !result && i<=NBUCKETS; i++) {
+      viz->bucket_hz[i] = values[i];
+    }
+  } else if (!strcmp(args[0], "thresh")) {
+    result = _parse_numbers(vargs, nvalues, values, NBUCKETS, 10);
+    for (int i=0; !result && i<NBUCKETS; i++) {
+      if (values[i] > INT16_MAX) result = -1;
+      viz->thresh[i] = values[i];
+    }
+  } else if (!strcmp(args[0], "gain")) {
+    result = _parse_numbers(vargs, nvalues, values, 1, 10);
+    if (!result) viz->gain_pct = values[0];
+  } else if (!strcmp(args[0], "led")) {
+    result = nvalues == 2 ? 0 : -1;
+    if (!result) result = _parse_numbers(vargs, 1, values, 1, 10);
+    if (!result) result = _parse_numbers(vargs+1, 1, values+1, 1, 16);
+    if (!result && values[0] >= NBUCKETS) result = -1;
+    if (!result) viz->palette[values[0]] = values[1];
+  } else if (!strcmp(args[0], "nfft")) {
+    result = _parse_numbers(vargs, nvalues, values, 1, 10);
+    if (!result) viz->fft_size = values[0];
+  } else if (!strcmp(args[0], "view") && nvalues == 1) {
+    if (!strcmp(vargs[0], "split")) {
+      viz->stereo_view = VIZ_STEREO_SPLIT;
+      result = 0;
+    } else if (!strcmp(vargs[0], "balance")) {
+      viz->stereo_view = VIZ_STEREO_BALANCE;
+      result = 0;
+    }
+  } else if (!strcmp(args[0], "viz") && nvalues == 1) {
+    int mode = viz_find_mode(vargs[0]);
+    if (mode >= 0) {
+      viz->mode = mode;
+      result = 0;
+    }
+  } else if (!strcmp(args[0], "gradient")) {
+    result = _parse_numbers(vargs, nvalues, values, 2, 10);
+    if (!result) {
+      viz->gradient = values[0];
+      viz->fade_rate = values[1];
+    }
+  } else if (!strcmp(args[0], "beat")) {
+    result = _parse_numbers(vargs, nvalues, values, 3, 10);
+    if (!result) {
+      viz->beat_ratio_x4 = values[0];
+      viz->beat_min_energy = values[1];
+      viz->beat_holdoff = values[2];
+    }
+  } else if (!strcmp(args[0], "idle")) {
+    result = _parse_numbers(vargs, nvalues, values, 3, 10);
+    if (!result) {
+      config->idle_amplitude = values[0];
+      config->idle_enter_frames = values[1];
+      config->wake_amplitude = values[2];
+    }
+  } else if (!strcmp(args[0], "output")) {
+    result = _parse_numbers(vargs, nvalues, values, 3, 10);
+    if (!result && (values[1] > 1 || values[2] > 1)) result = -1;
+    if (!result) {
+      config->brightness = values[0];
+      config->is_gamma = values[1];
+      config->is_dithering = values[2];
+    }
+  } else {
+    printf("shell: unknown command, ? for help\r\n");
+    return;
+  }
+
+  // the edit is only committed whole and valid
+  if (!result) {
+    result = cfg_commit();
+  }
+  printf(result ? "shell: invalid\r\n" : "ok\r\n");
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+// see .h for more details
+void shell_init(const char* new_hot_keys) {
+  hot_keys = new_hot_keys != NULL ? new_hot_keys : "";
+  nchars = 0;
+}
+
+// see .h for more details
+char shell_service() {
+
+  int c;
+
+  while ((c = log_getc()) >= 0) {
+    if (nchars == 0 && c != '\0' && strchr(hot_keys, c) != NULL) {
+      return c;
+    }
+
+    if (c == '\r' || c == '\n') {
+      // a CR LF pair ends a line once
+      if (nchars > 0) {
+        log_write("\r\n", 2);
+        line[nchars] = '\0';
+        nchars = 0;
+        _execute(line);
+      }
+    } else if (c == '\b' || c == 0x7F) {
+      if (nchars > 0) {
+        nchars--;
+        log_write("\b \b", 3);
+      }
+    } else if (c >= ' ' && c < 0x7F && nchars < SHELL_LINE_SIZE) {
+      line[nchars++] = c;
+      log_write(&line[nchars-1], 1);
+    }
+  }
+
+  return 0;
+}
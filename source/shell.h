@@ -0,0 +1,76 @@
+/* -----------------------------------------------------------------------------
+ * shell.h - Console commands to tune the pipeline while it runs
+ *
+ * Lines typed on the debug console change the parameters in config.h, which
+ * take effect from the next frame, so tuning at a venue needs no rebuild:
+ *
+ *   ?                      print the parameters, as commands that set them
+ *   edges HZ0 ... HZ8      the bucket edges in Hz, increasing
+ *   thresh T0 ... T7       the threshold of each bucket
+ *   gain PERCENT           scales the peaks before the thresholds
+ *   led I RRGGBB           the color of bucket I, in hex
+ *   nfft N                 the FFT length, 128, 256 or 512
+ *   view split|balance     how stereo is shown
+ *   viz MODE               how the analysis is drawn: spectrum, vu, pulse,
+ *                          wheel, fire or ripple (see viz_modes.h)
+ *   viz                    print each mode's cost per frame in cycles, and
+ *                          the RAM it keeps; * marks the one shown
+ *   gradient G RATE        0 for the bucket colors, or 1 to 4 for a gradient
+ *                          shaded by level (see effects.h); the cross-fade,
+ *                          1 (slow) to 256 (none)
+ *   beat RATIO_X4 MIN HOLD the beat detector: ratio to the average x4, the
+ *                          least energy, frames from one beat to the next
+ *   idle LEVEL FRAMES WAKE the idle mode: the level below which a frame is
+ *                          quiet, quiet frames before sleeping, wake level
+ *   output LEVEL G D       the LED output stage: brightness 0 to 256, gamma
+ *                          2.2 (G) and temporal dithering (D), 1 on, 0 off
+ *   write                  keep the parameters in flash, loaded at boot
+ *                          (see config_store.h)
+ *   test                   run the FFT self-test (see test_dsp_analysis.h)
+ *   timing                 print and clear the stage timings (see profile.h)
+ *   bench                  time the LED encoder and the effects, in cycles
+ *                          per pixel (see pixl_encode.h, effects.h)
+ *
+ * A line ends with CR or LF, and backspace edits it. Characters arrive by
+ * interrupt (see log_console.h) and are handled by shell_service() from the
+ * main loop, between frames. A hot key typed at the start of a line is not
+ * part of a command: it is handed back to the caller at once, which keeps
+ * the single key commands of main.c working; no command starts with one.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _SHELL_H_
+#define _SHELL_H_
+
+#define SHELL_LINE_SIZE  (80)   // the longest command, characters
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+/*
+ * @brief   Starts with an empty line
+ *
+ * @param   hot_keys, the characters to hand back, a string that must stay
+ *              valid ("" for none)
+ * @return  none
+ */
+void shell_init(const char* hot_keys);
+
+/*
+ * @brief   Handles the characters received since the last call
+ *
+ * Stops at a hot key, leaving the characters after it for the next call.
+ *
+ * @param   none
+ * @return  char, the hot key typed, or 0 if none
+ */
+char shell_service();
+
+#endif // _SHELL_H_
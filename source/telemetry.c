@@ -0,0 +1,87 @@
+/* -----------------------------------------------------------------------------
+ * telemetry.c - COBS framing with a CRC for binary messages to the host
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "crc16.h"
+#include "telemetry.h"
+
+#define COBS_MAX_CODE  (0xFF)   // a run of 254 non-zero bytes, no zero after
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+// see .h for more details
+uint32_t telem_encode(telem_buf_t* buf) {
+
+  if (buf == NULL || buf->header.length > TELEM_MAX_PAYLOAD) return 0;
+
+  uint8_t* msg = (uint8_t*)buf + offsetof(telem_buf_t, header);
+  uint32_t nbytes = sizeof(telem_header_t) + buf->header.length;
+  uint16_t crc = crc16(msg, nbytes);
+  msg[nbytes++] = crc & 0xFF;
+  msg[nbytes++] = crc >> 8;
+
+  // each run of non-zero bytes is preceded by a code, its length + 1. The
+  // output starts TELEM_GAP bytes ahead of the message and gains at most one
+  // byte per 254, so a byte is always read before it is overwritten
+  uint8_t* out = (uint8_t*)buf;
+  uint8_t* code_ptr = out++;
+  uint32_t code = 1;
+  for (uint32_t i=0; i<nbytes; i++) {
+    uint8_t byte = msg[i];
+    if (byte != 0) {
+      *out++ = byte;
+      code++;
+    }
+    if (byte == 0 || code == COBS_MAX_CODE) {
+      *code_ptr = code;
+      code_ptr = out++;
+      code = 1;
+    }
+  }
+  *code_ptr = code;
+  *out++ = TELEM_DELIMITER;
+
+  return out - (uint8_t*)buf;
+}
+
+// see .h for more details
+const telem_header_t* telem_decode(uint8_t* data, uint32_t nbytes) {
+
+  if (data == NULL) return NULL;
+
+  // the output never gets ahead of the input
+  uint8_t* out = data;
+  uint32_t i = 0;
+  while (i < nbytes) {
+    uint32_t code = data[i++];
+    if (code == 0 || i + code - 1 > nbytes) return NULL;
+    for (uint32_t j=1; j<code; j++) {
+      *out++ = data[i++];
+    }
+    if (code != COBS_MAX_CODE && i < nbytes) {
+      *out++ = 0;
+    }
+  }
+
+  uint32_t length = out - data;
+  const telem_header_t* header = (const telem_header_t*)data;
+  if (length < TELEM_MSG_BYTES(0) ||
+      header->length != length - TELEM_MSG_BYTES(0)) {
+    return NULL;
+  }
+  uint16_t crc = data[length-2] | (data[length-1] << 8);
+  if (crc16(data, length-2) != crc) return NULL;
+
+  return header;
+}
@@ -0,0 +1,84 @@
+/* -----------------------------------------------------------------------------
+ * telemetry.h - COBS framing with a CRC for binary messages to the host
+ *
+ * A message is a telem_header_t and up to TELEM_MAX_PAYLOAD payload bytes,
+ * followed by a CRC-16 (see crc16.h) of both. On the wire it is COBS
+ * encoded, which removes every zero byte, and ends in a single zero. A
+ * receiver can therefore start listening at any point, resynchronizes at the
+ * next zero, and drops a message that text or line noise got mixed into by
+ * its CRC. COBS costs one byte per 254, plus the delimiter.
+ *
+ * A message is built in a telem_buf_t and encoded in place, so it can be
+ * handed to DMA without a second copy.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _TELEMETRY_H_
+#define _TELEMETRY_H_
+
+#include <stdint.h>
+#include "analog_input.h"
+
+#define TELEM_DELIMITER    (0x00)
+#define TELEM_MAX_PAYLOAD  (AIN_FRAME_SAMPLES*sizeof(uint16_t))
+
+// the message header (little endian)
+typedef struct {
+  uint8_t type;       // what the payload holds, defined by the sender
+  uint8_t nchannels;  // channels in the payload
+  uint16_t length;    // payload bytes
+  uint32_t seq;       // sequence number of the frame the data came from
+  uint32_t t_capture; // capture timestamp of that frame (see timestamp.h)
+} telem_header_t;
+
+// bytes of a message with n payload bytes, before and after encoding
+#define TELEM_MSG_BYTES(n)   (sizeof(telem_header_t) + (n) + sizeof(uint16_t))
+#define TELEM_WIRE_BYTES(n)  (TELEM_MSG_BYTES(n) + TELEM_MSG_BYTES(n)/254 + 2)
+
+// room ahead of the header for what COBS adds, rounded to keep it aligned
+#define TELEM_GAP  ((TELEM_WIRE_BYTES(TELEM_MAX_PAYLOAD) - \
+                     TELEM_MSG_BYTES(TELEM_MAX_PAYLOAD) + 3) & ~3U)
+
+// a buffer to build a message in and encode it in place
+typedef struct {
+  uint8_t gap[TELEM_GAP];
+  telem_header_t header;
+  uint8_t payload[TELEM_MAX_PAYLOAD + sizeof(uint16_t)]; // room for the CRC
+} telem_buf_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+/*
+ * @brief   Encodes the message in a buffer for the wire
+ *
+ * The header and payload must be filled in. Appends the CRC and encodes the
+ * message in place; afterwards the buffer starts with the wire bytes,
+ * including the closing delimiter, and the header is no longer valid.
+ *
+ * @param   buf, the message
+ * @return  uint32_t, the number of wire bytes, 0 if the payload is too long
+ */
+uint32_t telem_encode(telem_buf_t* buf);
+
+/*
+ * @brief   Decodes one message received from the wire
+ *
+ * Decodes in place, so the message starts at the beginning of data, which
+ * must be aligned for telem_header_t. The payload follows the header.
+ *
+ * @param   data, the bytes between two delimiters
+ *          nbytes, the number of bytes
+ * @return  const telem_header_t*, the message, NULL if it is malformed or
+ *          its CRC does not match
+ */
+const telem_header_t* telem_decode(uint8_t* data, uint32_t nbytes);
+
+#endif // _TELEMETRY_H_
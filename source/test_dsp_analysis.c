@@ -15,7 +15,7 @@
 
 #define NSAMPLES  (512)
 
-int test_dsp() {
+int test_dsp(bool is_printing) {
 
   // RUN TESTCODE ON PYTHON GENERATED WAVEFORM:
   int16_t* fft_mag;
@@ -87,10 +87,12 @@ int test_dsp() {
 
   fft_mag = dsp_fft_mag(samples_in, NSAMPLES);
   // PRINT OUTPUT FOR PLOTTING IN PYTHON:
-  printf("%3s , %10s , %5s\r\n", "idx","mag","freq");
-  for (int i=0; i<NSAMPLES/2; i++) {
-    printf("%3d , %10d , %5d\r\n", i, fft_mag[i], i*48000/NSAMPLES);
-  } 
+  if (is_printing) {
+    printf("%3s , %10s , %5s\r\n", "idx","mag","freq");
+    for (int i=0; i<NSAMPLES/2; i++) {
+      printf("%3d , %10d , %5d\r\n", i, fft_mag[i], i*48000/NSAMPLES);
+    }
+  }
 
   // following results were calculated with python
   fft_peaks results = {
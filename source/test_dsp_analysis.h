@@ -10,11 +10,14 @@
 #ifndef _TEST_DSP_ANALYSIS_H_
 #define _TEST_DSP_ANALYSIS_H_
 
+#include <stdbool.h>
+
 /* @brief   Tests functionality of dsp_analysis module
  *
- * @param   none
+ * @param   is_printing, also print the FFT magnitudes for plotting (257
+ *              lines, far more than the console buffers)
  * @return  Will not return if assert (testing) fails
  */
-int test_dsp();
+int test_dsp(bool is_printing);
 
 #endif // _TEST_DSP_ANALYSIS_H_
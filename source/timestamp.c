@@ -0,0 +1,92 @@
+/* -----------------------------------------------------------------------------
+ * timestamp.c - A free-running 32-bit timestamp counter built on TPM2
+ *
+ * TPM2 counts up at TS_TICKS_PER_SEC and the overflow interrupt extends the
+ * 16-bit hardware counter to 32 bits. The counter wraps roughly every 23
+ * minutes, so only differences between timestamps should be used.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "MKL25Z4.h"
+#include "timestamp.h"
+
+#define START_CRITICAL_SECTION \
+          uint32_t masking_state = __get_PRIMASK(); \
+          __disable_irq()
+
+#define END_CRITICAL_SECTION \
+          __set_PRIMASK(masking_state)
+
+// upper 16 bits of the timestamp
+static volatile uint32_t ts_overflows;
+
+// see .h for more details
+uint32_t ts_now() {
+
+  uint32_t ovf, cnt;
+
+  START_CRITICAL_SECTION;
+
+  ovf = ts_overflows;
+  cnt = TPM2->CNT;
+  // the counter may have rolled over while interrupts were masked, in which
+  // case the overflow is still pending - account for it here
+  if (TPM2->SC & TPM_SC_TOF_MASK) {
+    cnt = TPM2->CNT;
+    ovf++;
+  }
+
+  END_CRITICAL_SECTION;
+
+  return (ovf << 16) | cnt;
+}
+
+// see .h for more details
+uint32_t ts_elapsed(uint32_t since) {
+  return ts_now() - since;
+}
+
+// see .h for more details
+void TPM2_IRQHandler() {
+  // clear overflow flag
+  TPM2->SC |= TPM_SC_TOF_MASK;
+  ts_overflows++;
+}
+
+// see .h for more details
+void ts_init() {
+
+  // configure clock gating for tpm2 on scgc6
+  SIM->SCGC6 |= SIM_SCGC6_TPM2_MASK;
+  // Configure TPM clock source - KL25Z datasheet sec. 12.2.3
+  SIM->SOPT2 |= (SIM_SOPT2_TPMSRC(1) | SIM_SOPT2_PLLFLLSEL(1));
+
+  // TPM must be disabled to select prescale/counter bits:
+  //   PS   - sets prescaler to 16 - yields 3MHz clock
+  //   TOIE - interrupt on overflow to extend the counter
+  TPM2->SC &= ~TPM_SC_CMOD_MASK;
+  TPM2->SC = TPM_SC_PS(0b100) | TPM_SC_TOIE_MASK | TPM_SC_TOF_MASK;
+
+  // Continue the TPM operation while in debug mode
+  // KL25Z datasheet sec. 31.3.7
+  TPM2->CONF |= TPM_CONF_DBGMODE(3);
+
+  // count through the full 16-bit range
+  TPM2->MOD = 0xFFFF;
+  TPM2->CNT = 0;
+  ts_overflows = 0;
+
+  // configure the overflow interrupt, priority
+  NVIC_SetPriority(TPM2_IRQn, 1);
+  NVIC_ClearPendingIRQ(TPM2_IRQn);
+  NVIC_EnableIRQ(TPM2_IRQn);
+
+  // start timer
+  TPM2->SC |= TPM_SC_CMOD(1);
+}
@@ -0,0 +1,68 @@
+/* -----------------------------------------------------------------------------
+ * timestamp.h - A free-running 32-bit timestamp counter built on TPM2
+ *
+ * TPM2 counts up at TS_TICKS_PER_SEC and the overflow interrupt extends the
+ * 16-bit hardware counter to 32 bits. The counter wraps roughly every 23
+ * minutes, so only differences between timestamps should be used.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _TIMESTAMP_H_
+#define _TIMESTAMP_H_
+
+#include <stdint.h>
+
+#define TS_TICKS_PER_SEC  (3000000UL) // 48 MHz / 16
+#define TS_TICKS_PER_US   (TS_TICKS_PER_SEC/1000000UL)
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+/*
+ * @brief   Returns the current timestamp
+ *
+ * Safe to call from both the main loop and interrupt handlers.
+ *
+ * @param   none
+ * @return  uint32_t, the current time in ticks of TS_TICKS_PER_SEC
+ */
+uint32_t ts_now();
+
+/*
+ * @brief   Returns the number of ticks elapsed since a previous timestamp
+ *
+ * @param   since, a timestamp previously returned by ts_now()
+ * @return  uint32_t, the elapsed time in ticks (wrap-around safe)
+ */
+uint32_t ts_elapsed(uint32_t since);
+
+/*
+ * @brief   Initializes and starts TPM2 as the free-running timestamp counter
+ *
+ * @param   none
+ * @return  none
+ */
+void ts_init();
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PRIVATE FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+/*
+ * @brief   The TPM2 IRQ handler, counts overflows of the 16-bit counter
+ *
+ * @param   none
+ * @return  none
+ */
+void TPM2_IRQHandler();
+
+#endif // _TIMESTAMP_H_
@@ -14,13 +14,17 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include "MKL25Z4.h"
 #include "tpm_pixl.h"
+#include "analog_input.h"
+#include "events.h"
+#include "timestamp.h"
+#include "latency.h"
+#include "profile.h"
+#include "pixl_encode.h"
 
 // defines for pixels / colors
-#define PIXL_0          (0x1)       // the 0 bit for tpm output
-#define PIXL_1          (0x3)       // the 1 bit for tpm output
-#define BITS_PER_PIXEL  (24)        // 24-bit G-R-B output for neopixels
 #define RED_SHIFT       (16)
 #define GRN_SHIFT       (8)
 #define BLU_SHIFT       (0)
@@ -28,17 +32,126 @@
 #define GRN_MASK        (0x00FF00)
 #define BLU_MASK        (0x0000FF)
 
-// the board pins for TPM1,CH0 peripheral:
+#define START_CRITICAL_SECTION \
+          uint32_t primask_state = __get_PRIMASK(); \
+          __disable_irq()
+#define END_CRITICAL_SECTION \
+          __set_PRIMASK(primask_state)
+
+#if PIXL_NUM_STRIPS != 1 && PIXL_NUM_STRIPS != 2
+#error "PIXL_NUM_STRIPS must be 1 or 2, TPM1 has two channels"
+#endif
+#if defined(PIXL_SPI) && PIXL_NUM_STRIPS > 1
+#error "the SPI backend drives one strip"
+#endif
+
+// what goes over the wire: a duty cycle byte per bit for TPM1, or half a
+// MOSI byte per bit for SPI0 (see pixl_encode.h), and the low bytes after
+// the last bit that latch the colors. A WS2812 latches after 50 us low, and
+// the next frame can follow right away, so the reset outlasts that
+#ifdef PIXL_SPI
+#define WORDS_PER_PIXEL (PIXL_SPI_WORDS_PER_PIXEL)
+#define RESET_BYTES     (22)        // zero MOSI bytes, 59 us
+#define ENCODE          pixl_encode_spi
+#else
+#define WORDS_PER_PIXEL (PIXL_WORDS_PER_PIXEL)
+#define RESET_BYTES     (36)        // low TPM1 periods, 60 us
+#define ENCODE          pixl_encode
+#endif
+#if PIXL_NUM_STRIPS > 1 && AIN_NUM_CHANNELS > 1
+#error "the second strip needs DMA2, which AIN_NUM_CHANNELS > 1 takes"
+#endif
+
+// the board pins for TPM1 peripheral:
 #define TPM_PORT     (PORTA)
-#define TPM_PIN      (12)
 #define TPM_MUX_ALT  (3)
 
-// the bytes that will go over tpm to drive neopixels
-static uint16_t tpm_output[NUM_PIXELS*BITS_PER_PIXEL];
-static uint16_t tpm_reset = 0;
-
-// flag indicating whether tpm/dma has finished transmitting
-static volatile bool is_pixel_xmit_complete;
+// and for SPI0 MOSI:
+#define SPI_PORT     (PORTD)
+#define SPI_PIN      (2)
+#define SPI_MUX_ALT  (2)
+
+// a strip: a TPM1 channel, its pin and the DMA channel writing its CnV.
+// DMA1 is requested by the TPM1 overflow and links to the DMA channel of
+// the next strip after each transfer, so all strips get the duty cycle of
+// the same bit period
+typedef struct {
+  uint32_t channel;         // of TPM1
+  uint32_t pin;             // of TPM_PORT, TPM_MUX_ALT
+  uint32_t dma;             // channel of DMA0
+  uint32_t first;           // its first pixel in a frame
+  uint32_t npixels;
+} pixl_strip_t;
+
+static const pixl_strip_t strips[PIXL_NUM_STRIPS] = {
+  { 0, 12, 1, 0, PIXL_STRIP0_PIXELS },
+#if PIXL_NUM_STRIPS > 1
+  { 1, 13, 2, PIXL_STRIP0_PIXELS, PIXL_STRIP1_PIXELS },
+#endif
+};
+
+// the bytes that will go over tpm to drive neopixels, one duty cycle per
+// bit: the duty cycles fit in a byte, which DMA1 writes into the low byte of
+// CnV (see _init_dma1()). The strip is sent a chunk at a time: while DMA1
+// shifts out one half, the DMA1 interrupt encodes the next pixels into the
+// other, so the RAM used does not grow with the strip. Words, for the
+// encoder's word stores (see pixl_encode.h)
+static uint32_t tpm_chunks[PIXL_NUM_STRIPS][2]
+                          [PIXL_CHUNK_PIXELS*WORDS_PER_PIXEL];
+static uint8_t tpm_reset = 0;
+
+// a frame of colors handed to the driver
+typedef struct {
+  uint32_t colors[NUM_PIXELS];
+  uint32_t npixels;
+  uint32_t nsend;           // the pixels sent of each strip, from its first
+  uint32_t t_capture;       // for the latency, if is_tagged
+  bool is_tagged;
+} pixl_frame_t;
+
+// the states of the DMA1 interrupt
+typedef enum {
+  PIXL_IDLE,                // nothing is sending, the line is low
+  PIXL_DATA,                // the bit pattern of xmit is sending
+  PIXL_RESET                // the reset pattern is latching xmit
+} pixl_state_t;
+
+// three frames rotate: tpm_pixl_update() fills one, the mailbox holds the
+// newest complete one, and the DMA1 interrupt sends the third. A frame
+// that arrives while the mailbox is full replaces it, the latest wins
+static pixl_frame_t frames[3];
+static pixl_frame_t* fill;
+static pixl_frame_t* volatile mailbox;
+static pixl_frame_t* xmit;
+static volatile bool is_mailbox_full;
+static volatile pixl_state_t state;
+static pixl_frame_t* posted;   // the newest frame, what the strip will show
+
+// the output stage: set by tpm_pixl_set_output(), taken up by each frame
+static pixl_output_t next_output;
+static bool is_dithering;
+static bool is_output_changed;   // the next frame is sent whole
+static pixl_output_t output;     // of the frame being sent
+static uint32_t dither_frame;
+static volatile uint32_t ndither;  // pixels to dither, of the last frame
+static volatile bool is_flushing;  // no dither refresh, tpm_pixl_flush()
+
+static tpm_pixl_stats_t stats;
+
+static volatile uint32_t xmit_nencoded;    // pixels of xmit encoded so far
+static volatile uint32_t xmit_next_nbytes; // waiting in the other half, or 0
+static volatile uint32_t xmit_half;        // the half DMA1 is sending
+static volatile uint32_t xmit_ndither;     // pixels to dither so far, of
+                                           // the strip with the most
+
+// capture time of the next tpm_pixl_update(), for latency measurement
+static uint32_t pending_t_capture;
+static bool is_pending_tagged;
+
+#ifdef PROFILE
+// when the bit pattern started, for the transmit time
+static volatile uint32_t t_xmit_start;
+#endif
 
 // see .h for more details
 uint32_t tpm_pixl_rgb_to_24bit(color_t* col_rgb) {
@@ -60,102 +173,372 @@ color_t tpm_pixl_24bit_to_rgb(uint32_t* col_24bit) {
 }
 
 // see .h for more details
-int tpm_pixl_update(const uint32_t *rgb_24bit_colors, uint32_t npixels) {
-  
-  // error case: 
-  if (rgb_24bit_colors == NULL || npixels <= 0) return -1;
-
-  uint32_t mask;
-  int tpm_idx = 0;
-  const uint32_t *color;
-  color = rgb_24bit_colors;
-  
-  while ( color-rgb_24bit_colors<npixels ) {
-
-    // generate tpm bytes for green first
-    for (mask=0x8000; mask>0x80; mask>>=1) {
+void tpm_pixl_set_capture_time(uint32_t t_capture) {
+  pending_t_capture = t_capture;
+  is_pending_tagged = true;
+}
 
-       tpm_output[tpm_idx] = PIXL_0;
-       if (*color & mask) {
-         tpm_output[tpm_idx] = PIXL_1;
-       }
-       tpm_idx++;
-    }
+// the pixels of a frame of npixels that go to a strip
+static uint32_t _strip_npixels(const pixl_strip_t* strip, uint32_t npixels) {
+  if (npixels <= strip->first) return 0;
+  npixels -= strip->first;
+  return npixels < strip->npixels ? npixels : strip->npixels;
+}
 
-    // generate tpm bytes for red next
-    for (mask=0x800000; mask>0x8000; mask>>=1) {
-      tpm_output[tpm_idx] = PIXL_0;
-      if (*color & mask) {
-        tpm_output[tpm_idx] = PIXL_1;
+// the pixels to send of each strip: all of them, or with the frame sent
+// before to compare with, up to the last one that changed on any strip
+static uint32_t _count_nsend(const uint32_t* colors, uint32_t npixels,
+                             const pixl_frame_t* before) {
+  uint32_t nsend = 0;
+  for (uint32_t s=0; s<PIXL_NUM_STRIPS; s++) {
+    const uint32_t* now = colors + strips[s].first;
+    uint32_t n = _strip_npixels(&strips[s], npixels);
+    if (before != NULL) {
+      const uint32_t* was = before->colors + strips[s].first;
+      while (n > nsend && now[n-1] == was[n-1]) {
+        n--;
       }
-      tpm_idx++;
     }
+    if (n > nsend) nsend = n;
+  }
+  return nsend;
+}
 
-    // generate tpm bytes for blue next
-    for (mask=0x80; mask>0; mask>>=1) {
-      tpm_output[tpm_idx] = PIXL_0;
-      if (*color & mask) {
-        tpm_output[tpm_idx] = PIXL_1;
+// encodes the next pixels of each strip into one half of its chunk buffer,
+// a strip with fewer pixels than the others holding its line low after
+// them. Returns the number of bytes encoded per strip, 0 once every pixel
+// has been
+static uint32_t _encode_chunk(uint32_t half) {
+
+  uint32_t nrows = xmit->nsend - xmit_nencoded;
+  if (nrows > PIXL_CHUNK_PIXELS) nrows = PIXL_CHUNK_PIXELS;
+
+  for (uint32_t s=0; s<PIXL_NUM_STRIPS; s++) {
+    uint32_t npixels = _strip_npixels(&strips[s], xmit->npixels);
+    npixels = npixels > xmit_nencoded ? npixels - xmit_nencoded : 0;
+    if (npixels > nrows) npixels = nrows;
+
+    // a strip that has ended only pads, its colors are not touched
+    uint32_t* out = tpm_chunks[s][half];
+    if (npixels) {
+      uint32_t nfractions = ENCODE(xmit->colors + strips[s].first +
+                                   xmit_nencoded, npixels, &output, out);
+      if (nfractions && xmit_nencoded + nfractions > xmit_ndither) {
+        xmit_ndither = xmit_nencoded + nfractions;
       }
-      tpm_idx++;
     }
+    memset(out + npixels*WORDS_PER_PIXEL, 0,
+           (nrows - npixels)*WORDS_PER_PIXEL*sizeof(uint32_t));
+  }
+
+  xmit_nencoded += nrows;
+  return nrows*WORDS_PER_PIXEL*sizeof(uint32_t);
+}
 
-  color++;
-  } // end for loop over npixels
+// loads the DMA channel of a strip after the first, which is started by the
+// link from DMA1 on each of its transfers
+static void _load_linked(uint32_t s, const void* src, uint32_t nbytes) {
+  uint32_t ch = strips[s].dma;
+  DMA0->DMA[ch].DSR_BCR |= DMA_DSR_BCR_DONE_MASK;
+  DMA0->DMA[ch].DSR_BCR = DMA_DSR_BCR_BCR(nbytes);
+  DMA0->DMA[ch].SAR = DMA_SAR_SAR((uint32_t)src);
+}
 
-  // SEND THE BITPATTERN TO LATCH COLORS:
-  // wait for reset to complete
-  while(!is_pixel_xmit_complete) {;}
-  // enable source increment for output
-  DMA0->DMA[1].DCR |= DMA_DCR_SINC_MASK;
-  // set byte count 
-  DMA0->DMA[1].DSR_BCR |= DMA_DSR_BCR_BCR(BITS_PER_PIXEL*NUM_PIXELS*2);
-  // setup source register to start at tpm_output
-  DMA0->DMA[1].SAR = DMA_SAR_SAR((uint32_t)&(tpm_output[0]));
-  // set flag 
-  is_pixel_xmit_complete = false; 
+// points the DMA channels at one half of the chunk buffers and starts DMA1
+static void _start_chunk(uint32_t half, uint32_t nbytes) {
+  for (uint32_t s=1; s<PIXL_NUM_STRIPS; s++) {
+    _load_linked(s, &(tpm_chunks[s][half][0]), nbytes);
+  }
+  // set byte count
+  DMA0->DMA[1].DSR_BCR |= DMA_DSR_BCR_BCR(nbytes);
+  // setup source register to start at the half
+  DMA0->DMA[1].SAR = DMA_SAR_SAR((uint32_t)&(tpm_chunks[0][half][0]));
+  xmit_half = half;
   // re-enable peripheral request
   DMA0->DMA[1].DCR |= DMA_DCR_ERQ_MASK;
+}
 
-  // SEND THE RESET PATTERN TO DISPLAY COLORS:
-  // wait for reset to complete
-  while(!is_pixel_xmit_complete) {;}
+// starts the reset pattern once the last bit has been handed to DMA1
+static void _start_reset() {
   // disable source increment
-  DMA0->DMA[1].DCR &= ~DMA_DCR_SINC_MASK;
+  for (uint32_t s=0; s<PIXL_NUM_STRIPS; s++) {
+    DMA0->DMA[strips[s].dma].DCR &= ~DMA_DCR_SINC_MASK;
+  }
+  for (uint32_t s=1; s<PIXL_NUM_STRIPS; s++) {
+    _load_linked(s, &tpm_reset, RESET_BYTES);
+  }
   // set reset byte count
-  DMA0->DMA[1].DSR_BCR |= DMA_DSR_BCR_BCR(30);
+  DMA0->DMA[1].DSR_BCR |= DMA_DSR_BCR_BCR(RESET_BYTES);
   // setup source register as reset
   DMA0->DMA[1].SAR = DMA_SAR_SAR((uint32_t)&(tpm_reset));
-  // set flag
-  is_pixel_xmit_complete = false;
+  state = PIXL_RESET;
   // re-enable peripheral request
   DMA0->DMA[1].DCR |= DMA_DCR_ERQ_MASK;
+}
+
+// encodes both halves of xmit with the next dither offset and starts the
+// bit pattern, with DMA1 idle
+static void _start_xmit() {
+
+  output.dither = is_dithering ? pixl_dither(dither_frame++) : 0;
+  xmit_ndither = 0;
+
+  PROF_START(t_encode);
+  xmit_nencoded = 0;
+  uint32_t nbytes = _encode_chunk(0);
+  xmit_next_nbytes = _encode_chunk(1);
+  PROF_LAP(t_encode, PROF_LED_ENCODE);
+
+  // SEND THE BITPATTERN TO LATCH COLORS:
+  // enable source increment for output
+  for (uint32_t s=0; s<PIXL_NUM_STRIPS; s++) {
+    DMA0->DMA[strips[s].dma].DCR |= DMA_DCR_SINC_MASK;
+  }
+  state = PIXL_DATA;
+  PROF_MARK(t_xmit_start);
+  _start_chunk(0, nbytes);
+}
+
+// takes the frame in the mailbox and sends it in the output stage set last
+static void _start_frame() {
+
+  pixl_frame_t* sent = xmit;
+  xmit = mailbox;
+  mailbox = sent;
+  is_mailbox_full = false;
+  stats.nsent++;
+  for (uint32_t s=0; s<PIXL_NUM_STRIPS; s++) {
+    uint32_t n = _strip_npixels(&strips[s], xmit->npixels);
+    stats.npixels_sent += n < xmit->nsend ? n : xmit->nsend;
+  }
+
+  output = next_output;
+  _start_xmit();
+}
+
+// sends the pixels of xmit that have a fraction again, in the same output
+// stage but with the next dither offset, so the dither cycle runs at the
+// rate of the strip rather than that of the frames handed over
+static void _start_refresh() {
+  xmit->nsend = ndither;
+  xmit->is_tagged = false;
+  stats.nrefreshed++;
+  _start_xmit();
+}
+
+// see .h for more details
+int tpm_pixl_update(const uint32_t *rgb_24bit_colors, uint32_t npixels) {
+  
+  // error case: 
+  if (rgb_24bit_colors == NULL || npixels <= 0 || npixels > NUM_PIXELS) {
+    return -1;
+  }
+
+  // pixels past the last one that changed keep their colors on the strip,
+  // so only the pixels up to it are sent, and nothing if none changed
+  bool is_comparing = posted != NULL && posted->npixels == npixels &&
+                      !is_output_changed;
+  uint32_t nsend = _count_nsend(rgb_24bit_colors, npixels,
+                                is_comparing ? posted : NULL);
+  if (is_comparing) {
+    // dithered pixels change even when their colors do not. The DMA1
+    // interrupt sends them again on its own, unless a flush stopped it
+    if (is_dithering && nsend < ndither && state == PIXL_IDLE) {
+      nsend = ndither;
+    }
+  }
+  is_output_changed = false;
+  if (nsend == 0) {
+    stats.nunchanged++;
+    is_pending_tagged = false;
+    return 0;
+  }
+
+  // fill the frame no one else holds
+  memcpy(fill->colors, rgb_24bit_colors, npixels*sizeof(uint32_t));
+  fill->npixels = npixels;
+  fill->nsend = nsend;
+  fill->t_capture = pending_t_capture;
+  fill->is_tagged = is_pending_tagged;
+  is_pending_tagged = false;
+  posted = fill;
+
+  // post it, replacing a frame still waiting (whose changes it then has to
+  // carry too), and claim DMA1 if it is idle
+  START_CRITICAL_SECTION;
+  if (is_mailbox_full) {
+    stats.nreplaced++;
+    if (mailbox->nsend > fill->nsend) {
+      fill->nsend = mailbox->nsend;
+    }
+  }
+  pixl_frame_t* replaced = mailbox;
+  mailbox = fill;
+  fill = replaced;
+  is_mailbox_full = true;
+  bool is_starting = state == PIXL_IDLE;
+  if (is_starting) {
+    state = PIXL_DATA;
+  }
+  END_CRITICAL_SECTION;
+
+  // otherwise the DMA1 interrupt starts it after the current reset pattern
+  if (is_starting) {
+    _start_frame();
+  }
 
   return 0;
 }
 
+// see .h for more details
+void tpm_pixl_set_output(uint32_t brightness, bool is_gamma,
+                         bool is_dithering_on) {
+
+  const uint16_t* gamma = is_gamma ? pixl_gamma : NULL;
+  if (brightness > PIXL_FULL_BRIGHTNESS) {
+    brightness = PIXL_FULL_BRIGHTNESS;
+  }
+  if (brightness == next_output.brightness && gamma == next_output.gamma &&
+      is_dithering_on == is_dithering) {
+    return;
+  }
+
+  // taken up by the next frame started, in the main loop or the DMA1
+  // interrupt
+  START_CRITICAL_SECTION;
+  next_output.gamma = gamma;
+  next_output.brightness = brightness;
+  is_dithering = is_dithering_on;
+  END_CRITICAL_SECTION;
+  is_output_changed = true;
+}
+
+// see .h for more details
+void tpm_pixl_get_stats(tpm_pixl_stats_t* dest) {
+  if (dest == NULL) return;
+  START_CRITICAL_SECTION;
+  *dest = stats;
+  END_CRITICAL_SECTION;
+}
+
+// see .h for more details
+void tpm_pixl_flush() {
+  is_flushing = true;
+  while(state != PIXL_IDLE || is_mailbox_full) {
+    evt_wait(EVT_PIXL_XMIT);
+  }
+  is_flushing = false;
+}
+
 // see .h for more details
 void tpm_pixl_init() {
 
   // initialize subsystems
   _init_dma1();
 
+#ifdef PIXL_SPI
+  _init_spi0();
+#else
   _init_tpm1();
-
-  // set xmit complete flag
-  is_pixel_xmit_complete = true;
+#endif
+
+  // nothing to send yet
+  fill = &frames[0];
+  mailbox = &frames[1];
+  xmit = &frames[2];
+  is_mailbox_full = false;
+  state = PIXL_IDLE;
+  posted = NULL;
+  is_pending_tagged = false;
+  next_output.gamma = NULL;
+  next_output.brightness = PIXL_FULL_BRIGHTNESS;
+  is_dithering = false;
+  is_output_changed = false;
+  ndither = 0;
+  is_flushing = false;
+  memset(&stats, 0, sizeof(stats));
 
 }
 
 // see .h for more details 
 void DMA1_IRQHandler() {
-  TPM1->CONTROLS[0].CnV = 0;
+  // CnV is buffered until the next TPM1 overflow, so the last bit written
+  // has not gone out yet: leave it be, the next chunk (or the reset pattern)
+  // has until the overflow after that, two bit periods, to be started.
+  // Masked interrupts may delay this handler by one of them (see .h).
+  // With SPI0 the last byte waits in D behind the one shifting, and as
+  // every byte ends low a start a little late only stretches a low bit.
   // clear done flag
   DMA0->DMA[1].DSR_BCR |= DMA_DSR_BCR_DONE_MASK;
-  // set flag that DMA TX complete 
-  is_pixel_xmit_complete = true;
+
+  if (state == PIXL_DATA) {
+    if (xmit_next_nbytes) {
+      // send the other half right away, then refill the one just sent
+      uint32_t sent = xmit_half;
+      _start_chunk(sent ^ 1, xmit_next_nbytes);
+      // timed from the restart on, so the timestamp's critical section
+      // does not delay it
+      PROF_START(t_refill);
+      xmit_next_nbytes = _encode_chunk(sent);
+      PROF_LAP(t_refill, PROF_LED_REFILL);
+    } else {
+      ndither = xmit_ndither;
+      _start_reset();
+    }
+    return;
+  }
+
+  // colors are latched once the reset pattern is out, record the latency
+  stats.t_latched = ts_now();
+  if (xmit->is_tagged) {
+    lat_record(ts_elapsed(xmit->t_capture));
+  }
+  PROF_RECORD(PROF_LED_XMIT, ts_elapsed(t_xmit_start));
+
+  // go on with the newest frame, if one came meanwhile, or keep the
+  // fractions of this one dithering
+  if (is_mailbox_full) {
+    _start_frame();
+  } else if (is_dithering && ndither && !is_flushing) {
+    _start_refresh();
+  } else {
+    state = PIXL_IDLE;
+  }
+  // wake the main loop
+  evt_post(EVT_PIXL_XMIT);
 }
 
+#ifdef PIXL_SPI
+// see .h for more details
+void _init_spi0() {
+
+  // configure clock gating for spi0 on scgc4
+  SIM->SCGC4 |= SIM_SCGC4_SPI0_MASK;
+
+  // KL25Z datasheet sec. 37.3, SPI must be disabled to configure:
+  //   MSTR   - master, drives SCK and MOSI
+  //   CPHA   - data on the first clock edge, so bytes go back to back
+  //   MSB first, SS and MISO left to GPIO
+  SPI0->C1 = SPI_C1_MSTR_MASK | SPI_C1_CPHA_MASK;
+
+  // TXDMAE - request DMA while the transmit buffer is empty
+  SPI0->C2 = SPI_C2_TXDMAE_MASK;
+
+  // 24 MHz bus clock / (SPPR+1) / 2^(SPR+1) = 3 MHz, a WS2812 bit is four
+  // MOSI bits, 1.33 us
+  SPI0->BR = SPI_BR_SPPR(3) | SPI_BR_SPR(0);
+
+  // enable SPI output to PORTD:
+  //    PTD2 - SPI0_MOSI - ALT2
+  SIM->SCGC5 |= SIM_SCGC5_PORTD_MASK;
+  SPI_PORT->PCR[SPI_PIN] &= ~PORT_PCR_MUX_MASK;
+  SPI_PORT->PCR[SPI_PIN] |= PORT_PCR_MUX(SPI_MUX_ALT);
+
+  // enable SPI, MOSI idles low until DMA1 writes the first byte
+  SPI0->C1 |= SPI_C1_SPE_MASK;
+}
+
+#else
 #define TPM1_CLK_INPUT_FREQ (48000000UL) // 48 MHz
 // see .h for more details 
 void _init_tpm1() {
@@ -180,22 +563,27 @@ void _init_tpm1() {
   // set the overflow val - KL25Z datasheet sec. 31.3.3
   TPM1->MOD = 4;
 
-  // enable edge-aligned high-true PWM mode
-  TPM1->CONTROLS[0].CnSC = ( TPM_CnSC_MSB_MASK  |
-                             TPM_CnSC_ELSB_MASK );
-  
-  TPM1->CONTROLS[0].CnV = 0;
-
   // enable TPM outputs to PORTA:
   //    PTA12 - TPM1CH0 - ALT3
+  //    PTA13 - TPM1CH1 - ALT3, with two strips
   SIM->SCGC5 |= SIM_SCGC5_PORTA_MASK;
-  TPM_PORT->PCR[TPM_PIN] &= ~PORT_PCR_MUX_MASK;
-  TPM_PORT->PCR[TPM_PIN] |= PORT_PCR_MUX(TPM_MUX_ALT);
+  for (uint32_t s=0; s<PIXL_NUM_STRIPS; s++) {
+    // enable edge-aligned high-true PWM mode
+    TPM1->CONTROLS[strips[s].channel].CnSC = ( TPM_CnSC_MSB_MASK  |
+                                               TPM_CnSC_ELSB_MASK );
+
+    TPM1->CONTROLS[strips[s].channel].CnV = 0;
+
+    TPM_PORT->PCR[strips[s].pin] &= ~PORT_PCR_MUX_MASK;
+    TPM_PORT->PCR[strips[s].pin] |= PORT_PCR_MUX(TPM_MUX_ALT);
+  }
 
   // start timer
   TPM1->SC |= TPM_SC_CMOD(1);
 }
+#endif
 
+#define DMA_SPI0_TX_TRIG      (17)
 #define DMA_TPM1_OVRFLW_TRIG  (55)
 // see .h for more details
 void _init_dma1() {
@@ -203,34 +591,62 @@ void _init_dma1() {
   SIM->SCGC7 |= SIM_SCGC7_DMA_MASK;
   SIM->SCGC6 |= SIM_SCGC6_DMAMUX_MASK;
 
-  // disable during config.
-  DMAMUX0->CHCFG[1] = 0;
+  for (uint32_t s=0; s<PIXL_NUM_STRIPS; s++) {
+    uint32_t ch = strips[s].dma;
+
+    // disable during config. The DMA channels of the strips after the
+    // first have no peripheral request, they are started through the links
+    DMAMUX0->CHCFG[ch] = 0;
+
+    // see pg. 357 of datasheet
+    // SINC  - Enable source increment after transfer
+    // SSIZE - sets source size to 8 bits
+    // DSIZE - sets destination size to 8 bits: the duty cycles are below
+    //         256, a byte write sets the low byte of CnV and the rest stays
+    //         0; SPI0 D is a byte
+    // CS    - force single read/write per request (cycle steal)
+    DMA0->DMA[ch].DCR = ( DMA_DCR_SINC_MASK  |
+                          DMA_DCR_SSIZE(1)   |
+                          DMA_DCR_DSIZE(1)   |
+                          DMA_DCR_CS_MASK    );
+    // LINKCC - link to LCH1 after each cycle steal transfer
+    // LCH1   - the DMA channel of the next strip
+    if (s+1 < PIXL_NUM_STRIPS) {
+      DMA0->DMA[ch].DCR |= DMA_DCR_LINKCC(2) |
+                           DMA_DCR_LCH1(strips[s+1].dma);
+    }
 
-  // see pg. 357 of datasheet
+#ifdef PIXL_SPI
+    // set destination address as the SPI0 data register
+    DMA0->DMA[ch].DAR = DMA_DAR_DAR((uint32_t)&(SPI0->D));
+#else
+    // set destination address as pwm duty cycle for the strip's channel
+    DMA0->DMA[ch].DAR =
+        DMA_DAR_DAR((uint32_t)&(TPM1->CONTROLS[strips[s].channel].CnV));
+#endif
+  }
+
+  // DMA1 paces the others:
   // EINT  - Enable interrupts on transfer completion
-  // SINC  - Enable source increment after transfer
-  // SSIZE - sets source size to 16 bits
-  // DSIZE - sets destination size to 16 bits
   // D_REQ - DCR ERQ bit is cleared when BCR is depleted
-  // CS    - force single read/write per request (cycle steal)
-  DMA0->DMA[1].DCR = ( DMA_DCR_EINT_MASK  |
-                       DMA_DCR_SINC_MASK  |
-                       DMA_DCR_SSIZE(2)   |
-                       DMA_DCR_DSIZE(2)   |
-                       DMA_DCR_D_REQ_MASK |
-                       DMA_DCR_CS_MASK    );
-  
-  // set destination address as pwm duty cycle for TPM1CH0 
-  DMA0->DMA[1].DAR = DMA_DAR_DAR((uint32_t)&(TPM1->CONTROLS[0].CnV));
+  DMA0->DMA[1].DCR |= DMA_DCR_EINT_MASK | DMA_DCR_D_REQ_MASK;
 
-  // configure the interrupt upon transfer complete, priority 
-  NVIC_SetPriority(DMA1_IRQn, 3);
+  // configure the interrupt upon transfer complete, priority: above all
+  // others, as each chunk has to be started within two bit periods (two
+  // MOSI bytes with SPI0)
+  NVIC_SetPriority(DMA1_IRQn, 0);
   NVIC_ClearPendingIRQ(DMA1_IRQn);
   NVIC_EnableIRQ(DMA1_IRQn);
 
-  // enable DMA, triggered by TPM1 xmit datasheet 3.4.8.1
+  // enable DMA, triggered by TPM1 xmit (or the SPI0 transmit buffer empty)
+  // datasheet 3.4.8.1
+#ifdef PIXL_SPI
+  DMAMUX0->CHCFG[1] = (DMAMUX_CHCFG_SOURCE(DMA_SPI0_TX_TRIG) |
+                       DMAMUX_CHCFG_ENBL_MASK);
+#else
   DMAMUX0->CHCFG[1] = (DMAMUX_CHCFG_SOURCE(DMA_TPM1_OVRFLW_TRIG) |
                        DMAMUX_CHCFG_ENBL_MASK);
+#endif
 
 }
 
@@ -4,6 +4,16 @@
  * The neopixel (WS2812B) communication specification is implemented via TPM1
  * and DMA1. Note: KL25Z is a 3.3V board and neopixels are typically supplied
  * with 5V. Make proper hardware considerations. 
+ *
+ * Built with PIXL_SPI, SPI0 sends the bit stream instead, on its MOSI pin
+ * (PTD2), with DMA1 writing a byte for every two bits rather than a duty
+ * cycle for every bit, and TPM1 is left free.
+ *
+ * With PIXL_NUM_STRIPS 2 the pixels are split over two strips that are sent
+ * side by side, one on each TPM1 channel, so a frame takes as long as its
+ * longest strip rather than all of its pixels. TPM1 has no more channels
+ * and the second strip takes DMA2, which the ADC input sequence needs with
+ * AIN_NUM_CHANNELS > 1, so two strips are for mono builds, on TPM1 only.
  * 
  * @author  Jake Michael
  * @date    2020-12-07 
@@ -15,8 +25,35 @@
 #define _TPM_PIXL_H_
 
 #include <stdint.h>
+#include <stdbool.h>
+
+// the strips and their lengths: the frame handed to tpm_pixl_update()
+// fills strip 0 first, then strip 1
+#ifndef PIXL_NUM_STRIPS
+#define PIXL_NUM_STRIPS     (1)
+#endif
+#if PIXL_NUM_STRIPS > 1
+#ifndef PIXL_STRIP0_PIXELS
+#define PIXL_STRIP0_PIXELS  (5)
+#endif
+#ifndef PIXL_STRIP1_PIXELS
+#define PIXL_STRIP1_PIXELS  (3)
+#endif
+#define NUM_PIXELS  (PIXL_STRIP0_PIXELS + PIXL_STRIP1_PIXELS)
+#else
+#ifndef PIXL_STRIP0_PIXELS
+#define PIXL_STRIP0_PIXELS  (8)
+#endif
+#define NUM_PIXELS  (PIXL_STRIP0_PIXELS)
+#endif
 
-#define NUM_PIXELS  (8)
+// the bit stream takes one byte per WS2812 bit, 24 bytes per pixel, and is
+// encoded PIXL_CHUNK_PIXELS at a time into two halves of a buffer, so it
+// takes 2*PIXL_CHUNK_PIXELS*PIXL_BYTES_PER_PIXEL bytes per strip for any
+// strip length.
+// The colors themselves are kept in three frames of 4 bytes per pixel
+#define PIXL_BYTES_PER_PIXEL  (24)
+#define PIXL_CHUNK_PIXELS     (4)
 
 // Popular Neopixel colors:
 #define RED     (0xff0000)
@@ -29,6 +66,16 @@
 #define ORANGE  (0xbd3900)
 
 
+// what became of the frames handed to tpm_pixl_update()
+typedef struct {
+  uint32_t nsent;         // frames sent to the strip
+  uint32_t npixels_sent;  // pixels in them, only up to the last that changed
+  uint32_t nunchanged;    // frames skipped, no pixel changed
+  uint32_t nreplaced;     // frames replaced in the mailbox before being sent
+  uint32_t nrefreshed;    // frames sent again by the driver to dither
+  uint32_t t_latched;     // ts_now() when the strips last latched a frame
+} tpm_pixl_stats_t;
+
 // color struct holding byte values for red, green, blue 
 typedef struct {
   uint8_t red;
@@ -57,20 +104,95 @@ uint32_t tpm_pixl_rgb_to_24bit(color_t* col_rgb);
 color_t tpm_pixl_24bit_to_rgb(uint32_t* col_24bit);
 
 
-/* @brief   Updates the neopixel strip via TPM1 and DMA1
+/* @brief   Hands a frame of colors to the neopixel strips, without waiting
  *
- * The logical output to the neopixels is on KL25Z Port A, Pin 12 (PTA12)
+ * The logical output to the neopixels is on KL25Z Port A, Pin 12 (PTA12),
+ * and that of the second strip, if any, on PTA13; with PIXL_SPI it is on
+ * PTD2. Both strips send one bit per TPM1 period, each up to its own
+ * length, and the shorter one holds its line low for the rest of the frame.
+ * The colors are copied into a mailbox and the call returns at once. When
+ * the strip is idle the frame starts right away, otherwise the DMA1
+ * interrupt starts it after the reset pattern of the frame being sent; a
+ * frame still waiting in the mailbox is replaced, so the latest one wins.
+ * The first two chunks are encoded when the frame starts, the rest by the
+ * DMA1 interrupt while the chunk before is shifting out. The interrupt has
+ * two bit periods (3.3 us, or two MOSI bytes, 5.3 us, with PIXL_SPI) to
+ * start the next chunk, and needs part of that to get there, so while a
+ * frame is sending interrupts must not be masked for more than one of
+ * them (1.67 us, or 2.7 us): call tpm_pixl_flush() before e.g.
+ * programming flash.
  *
- * @param   none
+ * The frame is compared with the one handed over before it: on each strip,
+ * pixels past the last one that changed on any strip (counted from the
+ * start of each) keep their colors and are not sent, and a frame with no
+ * change is not sent at all (nor is its latency
+ * recorded, see tpm_pixl_set_capture_time()).
+ *
+ * @param   rgb_24bit_colors, the 24-bit colors, copied, those of strip 0
+ *              first
+ *          npixels, the number of colors, at most NUM_PIXELS
  * @return  -1 on error, 0 on success
  */
-int tpm_pixl_update();
+int tpm_pixl_update(const uint32_t *rgb_24bit_colors, uint32_t npixels);
+
+
+/* @brief   Sets the output stage the colors go through to the strip
+ *
+ * Applied in the encoder (see pixl_encode.h) from the next frame on, which
+ * is then sent whole. While dithering, pixels whose levels have a fraction
+ * change from frame to frame, so as long as no new frame is waiting the
+ * DMA1 interrupt sends the last one again, up to the last such pixel, with
+ * the next dither offset. The 8 step cycle then runs at the strip's
+ * refresh rate (about 380 us a frame for 8 pixels) rather than at the
+ * 94 frames/s of the analysis, where it would blink at 11.7 Hz.
+ *
+ * @param   brightness, 0 to PIXL_FULL_BRIGHTNESS
+ *          is_gamma, true for gamma 2.2 on each color byte
+ *          is_dithering, true to dither the fractions left over time
+ * @return  none
+ */
+void tpm_pixl_set_output(uint32_t brightness, bool is_gamma,
+                         bool is_dithering);
+
+
+/* @brief   Reports what became of the frames handed over since boot
+ *
+ * @param   stats, destination for the counters
+ * @return  none
+ */
+void tpm_pixl_get_stats(tpm_pixl_stats_t* stats);
+
+
+/* @brief   Waits until every frame handed over has been fully transmitted
+ *
+ * Sleeps via evt_wait() until the mailbox is empty, the last reset pattern
+ * is out and DMA1 is idle, e.g. before stopping the clocks that TPM1 and
+ * DMA1 run on or before masking interrupts for long. The dither refresh
+ * stops for it, and starts again with the next frame handed over.
+ *
+ * @param   none
+ * @return  none
+ */
+void tpm_pixl_flush();
+
+
+/* @brief   Tags the next tpm_pixl_update() with the capture time of its data
+ *
+ * When the reset pattern of the tagged update has been sent (i.e. the colors
+ * are latched by the strip) the sample-to-LED latency is recorded with
+ * lat_record(). Untagged updates are not recorded.
+ *
+ * @param   t_capture, the capture timestamp of the frame being displayed
+ * @return  none
+ */
+void tpm_pixl_set_capture_time(uint32_t t_capture);
 
 
 /* @brief   Initializes the neopixel output module
  *
  * Initializes DMA1 to update TPM1.CH0 edge-aligned pulse width for communication
- * to an external neopixel strip
+ * to an external neopixel strip, and DMA2 to update TPM1.CH1 for the second
+ * strip, if any
  *
  * @param   none
  * @return  none
@@ -90,20 +212,33 @@ void tpm_pixl_init();
  */
 void DMA1_IRQHandler();
 
-/* @brief   Initializes TPM1 CH0
+/* @brief   Initializes TPM1 CH0 (and CH1)
  *
  * TPM1 CH0 is output on PTA12 as an edge-aligned high true PWM signal with 
- * 3 MHz input clock
+ * 3 MHz input clock, and so is CH1 on PTA13 for the second strip
  *
  * @param   none
  * @return  none
  */
 void _init_tpm1();
 
-/* @brief   Initializes DMA1 
+/* @brief   Initializes SPI0
+ *
+ * Only used with PIXL_SPI. SPI0 is a master shifting out MSB first at
+ * 3 MHz on MOSI (PTD2), and requests DMA while its transmit buffer is empty
+ *
+ * @param   none
+ * @return  none
+ */
+void _init_spi0();
+
+/* @brief   Initializes DMA1 (and DMA2)
  *
  * DMA1 will update the pulse width CnV register of TPM1 upon TPM1 overflow
- * to output the 0 and 1 bit pulses that the neopixels need
+ * to output the 0 and 1 bit pulses that the neopixels need, or with
+ * PIXL_SPI write the next byte into the SPI0 data register. With two strips
+ * DMA1 links to DMA2 after each transfer, which updates CH1 in the same
+ * period
  *
  * @param   none
  * @return  none
@@ -0,0 +1,330 @@
+/* -----------------------------------------------------------------------------
+ * uart_stream.c - Streams frame data to the host over UART0 with DMA
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "MKL25Z4.h"
+#include "board.h"
+#include "fsl_lpsci.h"
+#include "events.h"
+#include "timestamp.h"
+#include "log_console.h"
+#include "uart_stream.h"
+
+#define START_CRITICAL_SECTION \
+          uint32_t masking_state = __get_PRIMASK(); \
+          __disable_irq()
+
+#define END_CRITICAL_SECTION \
+          __set_PRIMASK(masking_state)
+
+#define NUM_BINS       (AIN_FRAME_SAMPLES/2)
+#define NO_PACKET      (-1)
+
+static telem_buf_t packets[2];
+static uint32_t wire_nbytes[2];              // encoded length of each
+static volatile int xmit_idx = NO_PACKET;    // the message DMA3 is sending
+static volatile int queued_idx = NO_PACKET;  // the message sent next
+
+static stream_content_t content = STREAM_OFF;
+static adpcm_state_t coder;
+static volatile uint32_t nsent;
+static volatile uint32_t nbytes;
+static uint32_t ndropped;
+static uint32_t window_nbytes;   // nbytes at the start of the report window
+static uint32_t window_start;
+
+// hands an encoded message to DMA3, call with interrupts masked
+static void _xmit(int idx) {
+  xmit_idx = idx;
+  DMA0->DMA[3].SAR = DMA_SAR_SAR((uint32_t)&(packets[idx]));
+  DMA0->DMA[3].DSR_BCR = DMA_DSR_BCR_BCR(wire_nbytes[idx]);
+  DMA0->DMA[3].DCR |= DMA_DCR_ERQ_MASK;
+}
+
+// returns a buffer that is neither on the wire nor queued, or NO_PACKET
+static int _claim() {
+  for (int idx=0; idx<2; idx++) {
+    if (idx != xmit_idx && idx != queued_idx) return idx;
+  }
+  ndropped++;
+  return NO_PACKET;
+}
+
+// fills in the header, encodes the message and sends it, or queues it
+// behind the current one
+static void _send(int idx, stream_content_t type, uint32_t nchannels,
+                  uint32_t seq, uint32_t t_capture, uint32_t length) {
+
+  telem_header_t* header = &packets[idx].header;
+  header->type = type;
+  header->nchannels = nchannels;
+  header->length = length;
+  header->seq = seq;
+  header->t_capture = t_capture;
+  wire_nbytes[idx] = telem_encode(&packets[idx]);
+
+  START_CRITICAL_SECTION;
+  if (xmit_idx == NO_PACKET) {
+    _xmit(idx);
+  } else {
+    queued_idx = idx;
+  }
+  END_CRITICAL_SECTION;
+}
+
+// waits for the UART to finish shifting out whatever it holds
+static void _wait_tx_idle() {
+  while (!(UART0->S1 & UART0_S1_TC_MASK)) {
+  }
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+// see .h for more details
+void stream_init() {
+  _init_dma3();
+  content = STREAM_OFF;
+  xmit_idx = NO_PACKET;
+  queued_idx = NO_PACKET;
+  window_start = ts_now();
+}
+
+// see .h for more details
+int stream_start(stream_content_t new_content) {
+
+  if (new_content != STREAM_SAMPLES && new_content != STREAM_ADPCM &&
+      new_content != STREAM_SPECTRUM && new_content != STREAM_PEAKS) {
+    return -1;
+  }
+
+  if (content == STREAM_OFF) {
+    // the console's text goes out first, later text waits for stream_stop()
+    log_pause();
+    _wait_tx_idle();
+    if (LPSCI_SetBaudRate(UART0, STREAM_BAUD, BOARD_DEBUG_UART_CLK_FREQ) !=
+        kStatus_Success) {
+      log_resume();
+      return -1;
+    }
+    LPSCI_EnableTxDMA(UART0, true);
+  }
+
+  adpcm_init(&coder);
+  content = new_content;
+  return 0;
+}
+
+// see .h for more details
+void stream_stop() {
+
+  if (content == STREAM_OFF) return;
+  content = STREAM_OFF;
+
+  while (xmit_idx != NO_PACKET) {
+    evt_wait(EVT_STREAM_XMIT);
+  }
+  _wait_tx_idle();
+  LPSCI_EnableTxDMA(UART0, false);
+  LPSCI_SetBaudRate(UART0, BOARD_DEBUG_UART_BAUDRATE,
+                    BOARD_DEBUG_UART_CLK_FREQ);
+  log_resume();
+}
+
+// see .h for more details
+stream_content_t stream_get_content() {
+  return content;
+}
+
+// see .h for more details
+int stream_samples(const ain_frame_t* frame) {
+
+  static uint8_t block[ADPCM_BLOCK_BYTES(AIN_FRAME_SAMPLES)];
+
+  if ((content != STREAM_SAMPLES && content != STREAM_ADPCM) ||
+      frame == NULL || frame->samples == NULL) {
+    return -1;
+  }
+
+  if (content == STREAM_ADPCM) {
+    // code into a scratch block first, the coder must see every frame
+    uint32_t nbytes = adpcm_encode(&coder, frame->samples, AIN_FRAME_SAMPLES,
+                                   frame->nchannels, block);
+    int idx = _claim();
+    if (idx == NO_PACKET) return -1;
+    memcpy(packets[idx].payload, block, nbytes);
+    _send(idx, STREAM_ADPCM, 1, frame->seq, frame->t_capture, nbytes);
+    return 0;
+  }
+
+  int idx = _claim();
+  if (idx == NO_PACKET) return -1;
+
+  // de-interleave channel 0
+  uint16_t* dest = (uint16_t*)packets[idx].payload;
+  for (int i=0; i<AIN_FRAME_SAMPLES; i++) {
+    dest[i] = frame->samples[i*frame->nchannels];
+  }
+
+  _send(idx, STREAM_SAMPLES, 1, frame->seq, frame->t_capture,
+        AIN_FRAME_SAMPLES*sizeof(uint16_t));
+  return 0;
+}
+
+// see .h for more details
+void stream_spectrum(uint32_t ch, const int16_t* mags, uint32_t nbins,
+                     const ain_frame_t* frame) {
+
+  if (content != STREAM_SPECTRUM || ch != 0 || mags == NULL ||
+      nbins > NUM_BINS || frame == NULL) {
+    return;
+  }
+  int idx = _claim();
+  if (idx == NO_PACKET) return;
+
+  memcpy(packets[idx].payload, mags, nbins*sizeof(int16_t));
+  _send(idx, STREAM_SPECTRUM, 1, frame->seq, frame->t_capture,
+        nbins*sizeof(int16_t));
+}
+
+// see .h for more details
+int stream_peaks(const fft_peaks* peaks, uint32_t nchannels) {
+
+  if (content != STREAM_PEAKS || peaks == NULL || nchannels < 1 ||
+      nchannels > AIN_NUM_CHANNELS) {
+    return -1;
+  }
+  int idx = _claim();
+  if (idx == NO_PACKET) return -1;
+
+  uint16_t* dest = (uint16_t*)packets[idx].payload;
+  for (int ch=0; ch<nchannels; ch++) {
+    for (int i=0; i<NBUCKETS; i++) {
+      *dest++ = peaks[ch].indices[i];
+      *dest++ = peaks[ch].mags[i];
+    }
+  }
+
+  _send(idx, STREAM_PEAKS, nchannels, peaks[0].seq, peaks[0].t_capture,
+        nchannels*NBUCKETS*2*sizeof(uint16_t));
+  return 0;
+}
+
+// see .h for more details
+int stream_beat(const viz_beat_t* beat, const fft_peaks* peaks) {
+
+  if (content == STREAM_OFF || beat == NULL || peaks == NULL ||
+      !beat->is_beat) {
+    return -1;
+  }
+  int idx = _claim();
+  if (idx == NO_PACKET) return -1;
+
+  stream_beat_t* dest = (stream_beat_t*)packets[idx].payload;
+  dest->energy = beat->energy;
+  dest->average = beat->average;
+  _send(idx, STREAM_BEAT, 0, peaks->seq, peaks->t_capture,
+        sizeof(stream_beat_t));
+  return 0;
+}
+
+// see .h for more details
+void stream_report(const stream_timing_t* timing, stream_stats_t* stats) {
+
+  if (stats == NULL) return;
+
+  uint32_t elapsed = ts_elapsed(window_start);
+  uint32_t bytes = nbytes;
+
+  stats->nsent = nsent;
+  stats->ndropped = ndropped;
+  stats->nbytes = bytes;
+  stats->bytes_per_sec = elapsed ? ((uint64_t)(bytes - window_nbytes)*
+                                    TS_TICKS_PER_SEC)/elapsed : 0;
+  stats->baud = STREAM_BAUD;
+  window_nbytes = bytes;
+  window_start += elapsed;
+
+  // the statistics go out with the data, printing would garble it
+  if (content == STREAM_OFF) return;
+  int idx = _claim();
+  if (idx == NO_PACKET) return;
+  uint8_t* payload = packets[idx].payload;
+  memcpy(payload, stats, sizeof(stream_stats_t));
+  if (timing != NULL) {
+    memcpy(payload + sizeof(stream_stats_t), timing, sizeof(stream_timing_t));
+  } else {
+    memset(payload + sizeof(stream_stats_t), 0, sizeof(stream_timing_t));
+  }
+  _send(idx, STREAM_STATS, 0, 0, ts_now(),
+        sizeof(stream_stats_t) + sizeof(stream_timing_t));
+}
+
+// see .h for more details
+void DMA3_IRQHandler() {
+  // clear done flag
+  DMA0->DMA[3].DSR_BCR |= DMA_DSR_BCR_DONE_MASK;
+
+  nsent++;
+  nbytes += wire_nbytes[xmit_idx];
+
+  // start the message queued meanwhile, if any
+  if (queued_idx != NO_PACKET) {
+    int idx = queued_idx;
+    queued_idx = NO_PACKET;
+    _xmit(idx);
+  } else {
+    xmit_idx = NO_PACKET;
+  }
+
+  // wake stream_stop()
+  evt_post(EVT_STREAM_XMIT);
+}
+
+#define DMA_UART0_TX_TRIG  (3)
+// see .h for more details
+void _init_dma3() {
+  // enable clock gating to DMA
+  SIM->SCGC7 |= SIM_SCGC7_DMA_MASK;
+  SIM->SCGC6 |= SIM_SCGC6_DMAMUX_MASK;
+
+  // disable during config.
+  DMAMUX0->CHCFG[3] = 0;
+
+  // EINT  - Enable interrupts on transfer completion
+  // SINC  - Enable source increment after transfer
+  // SSIZE - sets source size to 8 bits
+  // DSIZE - sets destination size to 8 bits
+  // D_REQ - DCR ERQ bit is cleared when BCR is depleted
+  // CS    - force single read/write per request (cycle steal)
+  DMA0->DMA[3].DCR = ( DMA_DCR_EINT_MASK  |
+                       DMA_DCR_SINC_MASK  |
+                       DMA_DCR_SSIZE(1)   |
+                       DMA_DCR_DSIZE(1)   |
+                       DMA_DCR_D_REQ_MASK |
+                       DMA_DCR_CS_MASK    );
+
+  // set destination address as the UART0 data register
+  DMA0->DMA[3].DAR = DMA_DAR_DAR(LPSCI_GetDataRegisterAddress(UART0));
+
+  // configure the interrupt upon transfer complete, lowest priority
+  NVIC_SetPriority(DMA3_IRQn, 3);
+  NVIC_ClearPendingIRQ(DMA3_IRQn);
+  NVIC_EnableIRQ(DMA3_IRQn);
+
+  // enable DMA, triggered by UART0 transmit data register empty
+  DMAMUX0->CHCFG[3] = (DMAMUX_CHCFG_SOURCE(DMA_UART0_TX_TRIG) |
+                       DMAMUX_CHCFG_ENBL_MASK);
+}
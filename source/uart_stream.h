@@ -0,0 +1,197 @@
+/* -----------------------------------------------------------------------------
+ * uart_stream.h - Streams frame data to the host over UART0 with DMA
+ *
+ * One kind of content (raw or ADPCM compressed samples, FFT magnitudes or
+ * bucket peaks) is sent every frame as a binary message, along with a
+ * message for each detected beat and once-per-second timing and throughput
+ * statistics. Messages are framed by telemetry.h (COBS with a CRC). A
+ * message is built and encoded in one of two buffers and handed to DMA3,
+ * which feeds UART0 one byte per TDRE request, so the core never waits for
+ * the UART. When both buffers are busy (one on the wire, one waiting) the
+ * new message is dropped and counted. Gaps in the sequence numbers show the
+ * host which frames were lost.
+ *
+ * UART0 is shared with the debug console (log_console.h). Streaming waits
+ * for the console's text to go out, then switches it to STREAM_BAUD, and
+ * stopping switches it back. Text printed while streaming is held in the
+ * console's ring buffer until then, and what does not fit is dropped.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _UART_STREAM_H_
+#define _UART_STREAM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "analog_input.h"
+#include "dsp_analysis.h"
+#include "adpcm.h"
+#include "latency.h"
+#include "telemetry.h"
+#include "visualizer.h"
+
+// 48 MHz / (16 x 3) has no baud rate error; raw samples need ~980 kbaud
+#ifndef STREAM_BAUD
+#define STREAM_BAUD   (1000000UL)
+#endif
+
+// what is streamed each frame, and the type of each message
+typedef enum {
+  STREAM_OFF = 0,
+  STREAM_SAMPLES,     // AIN_FRAME_SAMPLES uint16_t of channel 0
+  STREAM_SPECTRUM,    // fft_size/2 int16_t FFT magnitudes, channel 0
+  STREAM_PEAKS,       // per channel NBUCKETS x {uint16_t index, int16_t mag}
+  STREAM_STATS,       // a stream_stats_t and a stream_timing_t, once per
+                      // second
+  STREAM_ADPCM,       // an adpcm.h block of AIN_FRAME_SAMPLES, channel 0
+  STREAM_BEAT         // a stream_beat_t, on each beat
+} stream_content_t;
+
+// throughput and loss
+typedef struct {
+  uint32_t nsent;         // messages sent
+  uint32_t ndropped;      // messages dropped because both buffers were busy
+  uint32_t nbytes;        // bytes sent
+  uint32_t bytes_per_sec; // over the window since the previous report
+  uint32_t baud;          // UART0 baud rate while streaming
+} stream_stats_t;
+
+// the beat detector's view of the frame a beat was found in
+typedef struct {
+  uint32_t energy;        // viz_beat_t
+  uint32_t average;
+} stream_beat_t;
+
+// how the pipeline kept up over the last report window
+typedef struct {
+  uint32_t idle_permille; // CPU time spent asleep
+  uint32_t samples_missed;
+  lat_stats_t latency;    // sample-to-LED latency
+} stream_timing_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+/*
+ * @brief   Initializes DMA3 to feed UART0
+ *
+ * UART0 itself must already be initialized (BOARD_InitDebugConsole()).
+ *
+ * @param   none
+ * @return  none
+ */
+void stream_init();
+
+/*
+ * @brief   Switches UART0 to STREAM_BAUD and starts streaming content
+ *
+ * Waits for the debug console's last character to go out first.
+ *
+ * @param   content, what to send each frame: STREAM_SAMPLES, STREAM_ADPCM,
+ *          STREAM_SPECTRUM or STREAM_PEAKS
+ * @return  0 on success, -1 if the content is invalid or the baud rate
+ *          cannot be reached
+ */
+int stream_start(stream_content_t content);
+
+/*
+ * @brief   Stops streaming and restores the debug console's baud rate
+ *
+ * Sleeps until the messages already handed to DMA are sent.
+ *
+ * @param   none
+ * @return  none
+ */
+void stream_stop();
+
+/*
+ * @brief   Returns what is being streamed
+ *
+ * @param   none
+ * @return  stream_content_t, STREAM_OFF when not streaming
+ */
+stream_content_t stream_get_content();
+
+/*
+ * @brief   Sends channel 0 of a frame, if streaming STREAM_SAMPLES or
+ *          STREAM_ADPCM
+ *
+ * The ADPCM coder runs on every frame while streaming, so a block dropped
+ * for lack of a buffer does not upset the ones after it.
+ *
+ * @param   frame, the captured frame
+ * @return  0 if the message was queued, -1 if not streaming it or dropped
+ */
+int stream_samples(const ain_frame_t* frame);
+
+/*
+ * @brief   Sends the FFT magnitudes of channel 0, if streaming STREAM_SPECTRUM
+ *
+ * Matches viz_spectrum_sink_t, so the visualizer can hand over each spectrum
+ * before it is overwritten by the next channel's.
+ *
+ * @param   ch, the channel the spectrum belongs to (others are ignored)
+ *          mags, the useful magnitudes
+ *          nbins, the number of magnitudes, up to AIN_FRAME_SAMPLES/2
+ *          frame, the frame the spectrum was computed from
+ * @return  none
+ */
+void stream_spectrum(uint32_t ch, const int16_t* mags, uint32_t nbins,
+                     const ain_frame_t* frame);
+
+/*
+ * @brief   Sends the bucket peaks of every channel, if streaming STREAM_PEAKS
+ *
+ * @param   peaks, the peaks of each channel
+ *          nchannels, the number of channels
+ * @return  0 if the message was queued, -1 if not streaming it or dropped
+ */
+int stream_peaks(const fft_peaks* peaks, uint32_t nchannels);
+
+/*
+ * @brief   Sends a STREAM_BEAT message if the frame holds a beat
+ *
+ * @param   beat, the frame's beat detector output
+ *          peaks, the peaks of the frame's channel 0, for its identity
+ * @return  0 if the message was queued, -1 if not streaming, no beat or
+ *          dropped
+ */
+int stream_beat(const viz_beat_t* beat, const fft_peaks* peaks);
+
+/*
+ * @brief   Reports the throughput and starts a new window
+ *
+ * While streaming, the statistics are also sent as a STREAM_STATS message
+ * together with the pipeline's timing. One message rather than two, so the
+ * report takes a single buffer from the frame data.
+ *
+ * @param   timing, the pipeline's timing over the window, NULL for none
+ *          stats, destination for the statistics
+ * @return  none
+ */
+void stream_report(const stream_timing_t* timing, stream_stats_t* stats);
+
+/*
+ * @brief   DMA3 interrupt: a message has been sent, start the next one
+ *
+ * @param   none
+ * @return  none
+ */
+void DMA3_IRQHandler();
+
+/*
+ * @brief   Initializes DMA3 for UART0 transmit requests
+ *
+ * @param   none
+ * @return  none
+ */
+void _init_dma3();
+
+#endif // _UART_STREAM_H_
@@ -0,0 +1,210 @@
+/* -----------------------------------------------------------------------------
+ * visualizer.c - Turns a frame of samples into a frame of neopixel colors
+ *
+ * Runs the FFT and peak search on every channel of a captured frame and maps
+ * the bucket peaks onto the pixels.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "visualizer.h"
+#include "viz_modes.h"
+#include "profile.h"
+
+#define SAMPLE_HZ  (48000)   // the capture rate of analog_input
+
+// the parameters before any viz_set_config(). A beat is a bass energy
+// beat_ratio_x4/4 times its moving average, which follows 1/2^BEAT_AVG_SHIFT
+// of each frame (about 90 ms at 94 frames/s)
+static const viz_config_t default_config = {
+  // bins 0, 2, 4, 6, 10, 15, 20, 30 and 255 of the 512 point FFT
+  .bucket_hz = { 0, 188, 375, 563, 938, 1406, 1875, 2813, 23906 },
+  // a bucket lights up when its peak magnitude is above its threshold
+  .thresh = { 4, 4, 4, 4, 4, 4, 4, 0 },
+  .palette = { RED, PINK, PURPLE, BLUE, AQUA, GREEN, YELLOW, ORANGE },
+  .gain_pct = 100,
+  .fft_size = AIN_FRAME_SAMPLES,
+  .stereo_view = VIZ_STEREO_SPLIT,
+  .mode = VIZ_MODE_SPECTRUM,
+  .beat_ratio_x4 = 6,
+  .beat_min_energy = 8,
+  .beat_holdoff = 20,   // ~210 ms
+  .gradient = 0,
+  .fade_rate = FX_FULL,
+};
+
+#define BEAT_BUCKETS    (2)   // buckets 0 and 1, up to 375 Hz
+#define BEAT_AVG_SHIFT  (3)
+
+static viz_config_t config = default_config;
+static uint32_t bucket_indices[NBUCKETS+1] = {
+    0, 2, 4, 6, 10, 15, 20, 30, 255
+};
+
+static uint32_t beat_average_q4;     // the average, 4 fractional bits
+static uint32_t frames_since_beat = UINT32_MAX;
+
+static viz_spectrum_sink_t spectrum_sink = NULL;
+
+static uint32_t shown[NUM_PIXELS];   // the colors after the cross-fade
+static uint8_t energy[NUM_PIXELS];   // how loud the sound behind each is
+
+// compares the bass energy of the frame with its recent average
+static void _detect_beat(fft_peaks* peaks, uint32_t nchannels,
+                         viz_beat_t* beat) {
+
+  uint32_t energy = 0;
+  for (int ch=0; ch<nchannels; ch++) {
+    for (int i=0; i<BEAT_BUCKETS; i++) {
+      if (peaks[ch].mags[i] > 0) energy += peaks[ch].mags[i];
+    }
+  }
+
+  beat->energy = energy;
+  beat->average = beat_average_q4 >> 4;
+  // compared in 64 bits, so no ratio or energy can overflow
+  beat->is_beat = frames_since_beat >= config.beat_holdoff &&
+                  energy >= config.beat_min_energy &&
+                  ((uint64_t)energy << 6) >
+                  (uint64_t)config.beat_ratio_x4*beat_average_q4;
+
+  if (beat->is_beat) {
+    frames_since_beat = 0;
+  } else if (frames_since_beat < UINT32_MAX) {
+    frames_since_beat++;
+  }
+  // the average moves 1/2^BEAT_AVG_SHIFT of the way to the energy
+  if ((energy << 4) >= beat_average_q4) {
+    beat_average_q4 += ((energy << 4) - beat_average_q4) >> BEAT_AVG_SHIFT;
+  } else {
+    beat_average_q4 -= (beat_average_q4 - (energy << 4)) >> BEAT_AVG_SHIFT;
+  }
+}
+
+// see .h for more details
+int viz_process(ain_frame_t* frame, viz_frame_t* out) {
+
+  // error case
+  if (frame == NULL || out == NULL || frame->samples == NULL ||
+      frame->nchannels < 1 || frame->nchannels > AIN_NUM_CHANNELS) {
+    return -1;
+  }
+
+  // a shorter FFT takes the latest samples of the frame
+  uint16_t* latest = frame->samples +
+                     (AIN_FRAME_SAMPLES - config.fft_size)*frame->nchannels;
+
+  for (int ch=0; ch<frame->nchannels; ch++) {
+    // get fft magnitude (power spectrum of ADC samples), de-interleaving
+    // this channel on the fly
+    int16_t* fft_mags = dsp_fft_mag_strided(latest+ch, config.fft_size,
+                                            frame->nchannels);
+    if (spectrum_sink != NULL) {
+      spectrum_sink(ch, fft_mags, config.fft_size/2, frame);
+    }
+    // find the peaks, delineate with bucket_indices
+    PROF_START(t_peaks);
+    dsp_find_peaks(fft_mags, &out->peaks[ch], bucket_indices);
+    PROF_LAP(t_peaks, PROF_PEAKS);
+    // carry the frame identity through to the LED update
+    out->peaks[ch].seq = frame->seq;
+    out->peaks[ch].t_capture = frame->t_capture;
+  }
+
+  PROF_START(t_map);
+  _detect_beat(out->peaks, frame->nchannels, &out->beat);
+
+  viz_input_t in = { out->peaks, frame->nchannels, &out->beat, &config };
+  viz_render(config.mode, &in, out->colors, energy);
+
+  // the loud pixels change at once, the others trail off
+  if (config.fade_rate < FX_FULL) {
+    fx_crossfade(shown, out->colors, energy, NUM_PIXELS, config.fade_rate);
+    memcpy(out->colors, shown, sizeof(shown));
+  } else {
+    memcpy(shown, out->colors, sizeof(shown));
+  }
+  PROF_LAP(t_map, PROF_MAP);
+
+  return 0;
+}
+
+// see .h for more details
+void viz_get_default_config(viz_config_t* out) {
+  if (out != NULL) {
+    *out = default_config;
+  }
+}
+
+// see .h for more details
+int viz_check_config(const viz_config_t* new_config) {
+
+  if (new_config == NULL) return -1;
+
+  if (new_config->fft_size < VIZ_FFT_MIN ||
+      new_config->fft_size > VIZ_FFT_MAX ||
+      (new_config->fft_size & (new_config->fft_size-1))) {
+    return -1;
+  }
+  for (int i=0; i<NBUCKETS; i++) {
+    if (new_config->bucket_hz[i] >= new_config->bucket_hz[i+1]) return -1;
+  }
+  if (new_config->bucket_hz[NBUCKETS] > SAMPLE_HZ/2) return -1;
+  for (int i=0; i<NBUCKETS; i++) {
+    if (new_config->thresh[i] < 0 || new_config->palette[i] > 0xFFFFFF) {
+      return -1;
+    }
+  }
+  if (new_config->gain_pct == 0 || new_config->gain_pct > 10000 ||
+      (new_config->stereo_view != VIZ_STEREO_SPLIT &&
+       new_config->stereo_view != VIZ_STEREO_BALANCE) ||
+      new_config->beat_ratio_x4 < 5 ||
+      new_config->beat_ratio_x4 > VIZ_BEAT_RATIO_X4_MAX ||
+      new_config->beat_holdoff == 0 ||
+      new_config->mode >= VIZ_NMODES ||
+      new_config->gradient > FX_NPALETTES || new_config->fade_rate == 0 ||
+      new_config->fade_rate > FX_FULL) {
+    return -1;
+  }
+  return 0;
+}
+
+// see .h for more details
+int viz_set_config(const viz_config_t* new_config) {
+
+  if (viz_check_config(new_config)) return -1;
+  config = *new_config;
+
+  // to the nearest bin, keeping every bucket at least one bin wide
+  uint32_t nbins = config.fft_size/2;
+  for (int i=0; i<=NBUCKETS; i++) {
+    uint32_t bin = (config.bucket_hz[i]*config.fft_size + SAMPLE_HZ/2) /
+                   SAMPLE_HZ;
+    if (i > 0 && bin <= bucket_indices[i-1]) bin = bucket_indices[i-1] + 1;
+    if (bin > nbins-1 - (NBUCKETS-i)) bin = nbins-1 - (NBUCKETS-i);
+    bucket_indices[i] = bin;
+  }
+  return 0;
+}
+
+// see .h for more details
+const uint32_t* viz_get_palette() {
+  return config.palette;
+}
+
+// see .h for more details
+void viz_set_stereo_view(viz_stereo_view_t view) {
+  config.stereo_view = view;
+}
+
+// see .h for more details
+void viz_set_spectrum_sink(viz_spectrum_sink_t sink) {
+  spectrum_sink = sink;
+}
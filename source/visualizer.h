@@ -0,0 +1,164 @@
+/* -----------------------------------------------------------------------------
+ * visualizer.h - Turns a frame of samples into a frame of neopixel colors
+ *
+ * Runs the FFT and peak search on every channel of a captured frame and maps
+ * the bucket peaks onto the pixels. A beat is detected when the bass
+ * buckets' energy jumps well above its recent average. The selected mode
+ * (see viz_modes.h) draws the frame; colors come from the palette, or from a
+ * gradient (see effects.h) shaded by how far a bucket is over its
+ * threshold, and can cross-fade from frame to frame. The module is free of
+ * hardware access so the host build (see host/) runs exactly the same
+ * analysis as the target.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _VISUALIZER_H_
+#define _VISUALIZER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "analog_input.h"
+#include "dsp_analysis.h"
+#include "tpm_pixl.h"
+#include "effects.h"
+
+// how two or more capture channels are shown on the strip
+typedef enum {
+  VIZ_STEREO_SPLIT,   // left half shows channel 0, right half channel 1
+  VIZ_STEREO_BALANCE  // a single pixel shows where the sound sits left/right
+} viz_stereo_view_t;
+
+// how the analysis is drawn on the strip, see viz_modes.h
+typedef enum {
+  VIZ_MODE_SPECTRUM,  // each bucket lights its own pixel
+  VIZ_MODE_VU,        // a level meter per channel
+  VIZ_MODE_PULSE,     // the strip flashes on the beats
+  VIZ_MODE_WHEEL,     // a band of hues turning with the spectrum
+  VIZ_MODE_FIRE,      // flames fed by the bass
+  VIZ_MODE_RIPPLE,    // rings spreading from the loudest bucket on beats
+  VIZ_NMODES
+} viz_mode_id_t;
+
+// the FFT lengths viz_config_t.fft_size can select
+#define VIZ_FFT_MIN  (128)
+#define VIZ_FFT_MAX  (AIN_FRAME_SAMPLES)
+#define VIZ_BEAT_RATIO_X4_MAX  (64)
+
+// the tunable parameters, see viz_set_config()
+typedef struct {
+  uint32_t bucket_hz[NBUCKETS+1]; // bucket edges, increasing, up to 24 kHz
+  int16_t thresh[NBUCKETS];       // a bucket lights when its peak is above
+  uint32_t palette[NBUCKETS];     // the 24-bit color of each bucket
+  uint32_t gain_pct;              // scales the peaks before the thresholds
+  uint32_t fft_size;              // FFT of the latest samples, a power of 2
+                                  // from VIZ_FFT_MIN to VIZ_FFT_MAX
+  viz_stereo_view_t stereo_view;
+  viz_mode_id_t mode;             // how the analysis is drawn
+  uint32_t beat_ratio_x4;         // a beat is a bass energy this/4 times its
+                                  // moving average, 5 to
+                                  // VIZ_BEAT_RATIO_X4_MAX
+  uint32_t beat_min_energy;       // ignore onsets out of near silence
+  uint32_t beat_holdoff;          // frames from one beat to the next
+  uint32_t gradient;              // 0 for the palette above, 1 to
+                                  // FX_NPALETTES for a built-in gradient
+                                  // over the buckets, shaded by level
+  uint32_t fade_rate;             // how far the colors move to the new ones
+                                  // each frame, 1 to FX_FULL (no fading),
+                                  // faster for the pixels of loud buckets
+} viz_config_t;
+
+// receives each channel's FFT magnitudes while viz_process() has them
+typedef void (*viz_spectrum_sink_t)(uint32_t ch, const int16_t* mags,
+                                    uint32_t nbins, const ain_frame_t* frame);
+
+// the beat detector's output for one frame
+typedef struct {
+  uint32_t energy;    // summed peaks of the bass buckets of every channel
+  uint32_t average;   // the moving average of energy before this frame
+  bool is_beat;       // the frame starts a beat
+} viz_beat_t;
+
+// the result of analyzing one frame
+typedef struct {
+  fft_peaks peaks[AIN_NUM_CHANNELS];  // bucket peaks of each channel
+  viz_beat_t beat;
+  uint32_t colors[NUM_PIXELS];        // 24-bit colors to send to the strip
+} viz_frame_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+/*
+ * @brief   Analyzes a frame and maps it onto the pixels
+ *
+ * The frame's sequence number and capture time are copied into the peaks of
+ * every channel.
+ *
+ * @param   frame, the captured frame (1 to AIN_NUM_CHANNELS channels)
+ *          out, destination for the peaks and pixel colors
+ * @return  0 on success, -1 on error
+ */
+int viz_process(ain_frame_t* frame, viz_frame_t* out);
+
+/*
+ * @brief   Fills in the parameters the visualizer starts with
+ *
+ * @param   config, destination for the defaults
+ * @return  none
+ */
+void viz_get_default_config(viz_config_t* config);
+
+/*
+ * @brief   Checks a set of parameters without applying it
+ *
+ * @param   config, the parameters
+ * @return  0 if viz_set_config() would accept them, -1 if not
+ */
+int viz_check_config(const viz_config_t* config);
+
+/*
+ * @brief   Applies a set of parameters from the next viz_process() on
+ *
+ * The parameters are copied, and the bucket edges converted to FFT bins.
+ * Call between frames (see config.h), never during viz_process().
+ *
+ * @param   config, the parameters
+ * @return  0 on success, -1 if they are invalid (nothing changes)
+ */
+int viz_set_config(const viz_config_t* config);
+
+/*
+ * @brief   Returns the color assigned to each bucket
+ *
+ * @param   none
+ * @return  const uint32_t*, NBUCKETS 24-bit colors
+ */
+const uint32_t* viz_get_palette();
+
+/*
+ * @brief   Selects how multi-channel frames are shown
+ *
+ * @param   view, the stereo view
+ * @return  none
+ */
+void viz_set_stereo_view(viz_stereo_view_t view);
+
+/*
+ * @brief   Sets a function to receive the spectrum of every channel
+ *
+ * The spectrum buffer is reused for the next channel, so the sink must copy
+ * what it keeps before returning. It holds fft_size/2 bins.
+ *
+ * @param   sink, the receiver, NULL for none
+ * @return  none
+ */
+void viz_set_spectrum_sink(viz_spectrum_sink_t sink);
+
+#endif // _VISUALIZER_H_
@@ -0,0 +1,400 @@
+/* -----------------------------------------------------------------------------
+ * viz_modes.c - The ways a frame's analysis is drawn on the strip
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "timestamp.h"
+#include "effects.h"
+#include "viz_modes.h"
+
+// the buckets spread over the gradient, short of wrapping to its start
+#define GRADIENT_STEP     ((256 - 256/FX_PALETTE_SIZE)/(NBUCKETS-1))
+
+#define VU_HUE_EMPTY      (85)    // green at the start of a meter, red at
+                                  // its end
+#define VU_HOLD_FRAMES    (30)    // the peak holds ~0.3 s,
+#define VU_FALL_FRAMES    (4)     // then falls a pixel every 4 frames
+#define PULSE_DECAY       (224)   // the pulse keeps 7/8 of its level a frame
+#define WHEEL_SPREAD      (96)    // the hues across the strip, of 256
+#define WHEEL_EASE_SHIFT  (3)     // turns 1/8 of the way to its hue a frame
+#define WHEEL_BEAT_KICK   (48)    // and this far on a beat
+#define FIRE_COOLING      (48)    // the most heat a pixel loses in a frame
+#define FIRE_SPARKS       (2)     // the pixels the bass sparks land on
+#define RIPPLE_MAX        (3)     // rings on the strip at once
+#define RIPPLE_DECAY      (208)   // a ring keeps 13/16 of its level a frame
+
+// the state each mode keeps from frame to frame
+static struct {
+  uint16_t peak[2];               // the lit pixels held, of each meter
+  uint8_t hold[2];                // frames until the peak falls
+} vu;
+static struct {
+  uint32_t level;
+  uint32_t color;
+} pulse;
+static struct {
+  uint32_t hue;                   // the hue at the start of the strip, 8.8
+} wheel;
+static struct {
+  uint8_t heat[NUM_PIXELS];
+  uint32_t seed;
+} fire = { .seed = 1 };
+static struct {
+  struct {
+    int32_t center;
+    int32_t radius;
+    uint32_t level;
+    uint32_t color;
+  } rings[RIPPLE_MAX];
+  uint32_t next;                  // the ring the next beat replaces
+} ripple;
+
+static viz_mode_stats_t stats[VIZ_NMODES];
+
+// the peak of bucket i of channel ch with the gain applied
+static int32_t _level(const viz_input_t* in, uint32_t ch, int i) {
+  return (int32_t)in->peaks[ch].mags[i]*(int32_t)in->config->gain_pct/100;
+}
+
+// how far bucket i of channel ch is over its threshold
+static int32_t _excess(const viz_input_t* in, uint32_t ch, int i) {
+  return _level(in, ch, i) - in->config->thresh[i];
+}
+
+// the color of a bucket, from the palette or shaded from the gradient
+static uint32_t _bucket_color(const viz_config_t* config, int bucket,
+                              uint32_t intensity) {
+  if (intensity == 0) {
+    return 0x0;
+  } else if (config->gradient == 0) {
+    return config->palette[bucket];
+  }
+  uint32_t color = fx_palette_color(&fx_palettes[config->gradient-1],
+                                    bucket*GRADIENT_STEP);
+  return fx_scale(color, intensity+1);
+}
+
+// lights a pixel in the color of a bucket if the bucket is over its
+// threshold by excess, else puts it out
+static void _light(const viz_input_t* in, uint32_t* colors, uint8_t* energy,
+                   int pixel, int bucket, int32_t excess) {
+  uint32_t intensity = fx_intensity(excess);
+  energy[pixel] = intensity;
+  colors[pixel] = _bucket_color(in->config, bucket, intensity);
+}
+
+// the bucket furthest over its threshold in any channel, and by how much
+static int _loudest(const viz_input_t* in, int32_t* excess) {
+  int loudest = 0;
+  *excess = INT32_MIN;
+  for (uint32_t ch=0; ch<in->nchannels; ch++) {
+    for (int i=0; i<NBUCKETS; i++) {
+      if (_excess(in, ch, i) > *excess) {
+        *excess = _excess(in, ch, i);
+        loudest = i;
+      }
+    }
+  }
+  return loudest;
+}
+
+// how loud channel ch is, 0 to 255, by its bucket furthest over threshold
+static uint32_t _loudness(const viz_input_t* in, uint32_t ch) {
+  int32_t excess = INT32_MIN;
+  for (int i=0; i<NBUCKETS; i++) {
+    if (_excess(in, ch, i) > excess) excess = _excess(in, ch, i);
+  }
+  return fx_intensity(excess);
+}
+
+// adds two colors, each channel saturating
+static uint32_t _add(uint32_t a, uint32_t b) {
+  uint32_t sum = 0;
+  for (int shift=0; shift<24; shift+=8) {
+    uint32_t c = ((a >> shift) & 0xFF) + ((b >> shift) & 0xFF);
+    sum |= (c > 0xFF ? 0xFF : c) << shift;
+  }
+  return sum;
+}
+
+// the bucket pixel i of npixels shows, the buckets spread evenly over them
+static int _bucket_of(int i, int npixels) {
+  return i*NBUCKETS/npixels;
+}
+
+// xorshift32, for the flicker of the flames
+static uint32_t _random() {
+  fire.seed ^= fire.seed << 13;
+  fire.seed ^= fire.seed >> 17;
+  fire.seed ^= fire.seed << 5;
+  return fire.seed;
+}
+
+// mono: each pixel lit when its bucket is over threshold. Split: each
+// half shows one channel, a pixel for the loudest of the buckets it
+// covers, mirrored so that the low frequencies of both channels meet in
+// the middle. Balance: the pixel at the left/right balance in the color of
+// the loudest bucket. The buckets spread evenly over the pixels, a bucket
+// to several pixels on a long strip or several to one on a short one
+static void _render_spectrum(const viz_input_t* in, uint32_t* colors,
+                             uint8_t* energy) {
+
+  if (in->nchannels == 1) {
+    for (int i=0; i<NUM_PIXELS; i++) {
+      int b = _bucket_of(i, NUM_PIXELS);
+      _light(in, colors, energy, i, b, _excess(in, 0, b));
+    }
+
+  } else if (in->config->stereo_view == VIZ_STEREO_SPLIT) {
+    const int half = NUM_PIXELS/2;
+    for (int i=0; i<half; i++) {
+      int b = _bucket_of(half-1-i, half);
+      int end = _bucket_of(half-i, half);
+      int32_t left = _excess(in, 0, b);
+      int32_t right = _excess(in, 1, b);
+      for (int k=b+1; k<end; k++) {
+        if (_excess(in, 0, k) > left) left = _excess(in, 0, k);
+        if (_excess(in, 1, k) > right) right = _excess(in, 1, k);
+      }
+      _light(in, colors, energy, i, b, left);
+      _light(in, colors, energy, NUM_PIXELS-1-i, b, right);
+    }
+    // the middle pixel of an odd strip belongs to neither channel
+    if (NUM_PIXELS % 2) _light(in, colors, energy, half, 0, 0);
+
+  } else {
+    const fft_peaks* left = &in->peaks[0];
+    const fft_peaks* right = &in->peaks[1];
+    int balance = dsp_balance((fft_peaks*)left, (fft_peaks*)right);
+    int loudest = 0;
+    int loudest_excess = INT32_MIN;
+    for (int i=0; i<NBUCKETS; i++) {
+      int mag = left->mags[i] > right->mags[i] ? _level(in, 0, i) :
+                                                 _level(in, 1, i);
+      if (mag - in->config->thresh[i] > loudest_excess) {
+        loudest_excess = mag - in->config->thresh[i];
+        loudest = i;
+      }
+    }
+    for (int i=0; i<NUM_PIXELS; i++) {
+      _light(in, colors, energy, i, _bucket_of(i, NUM_PIXELS), 0);
+    }
+    if (balance >= 0) {
+      _light(in, colors, energy, (balance*(NUM_PIXELS-1)+500)/1000, loudest,
+             loudest_excess);
+    }
+  }
+}
+
+// one meter per channel, from the start of the strip in mono, from the
+// middle outwards in stereo. The lit length follows the loudness, its last
+// pixel partly lit, and the peak holds for a while before it falls
+static void _render_vu(const viz_input_t* in, uint32_t* colors,
+                       uint8_t* energy) {
+
+  uint32_t nmeters = in->nchannels > 1 ? 2 : 1;
+  uint32_t length = NUM_PIXELS/nmeters;
+  uint32_t hue_step = length > 1 ? (VU_HUE_EMPTY << 8)/(length-1) : 0;
+
+  for (uint32_t m=0; m<nmeters; m++) {
+    uint32_t fill = _loudness(in, m)*length;    // in 1/256 pixels
+    uint32_t nlit = fill >> 8;
+
+    if (nlit >= vu.peak[m]) {
+      vu.peak[m] = nlit;
+      vu.hold[m] = VU_HOLD_FRAMES;
+    } else if (vu.hold[m] > 0) {
+      vu.hold[m]--;
+    } else {
+      vu.peak[m]--;
+      vu.hold[m] = VU_FALL_FRAMES;
+    }
+
+    for (uint32_t k=0; k<length; k++) {
+      uint32_t pixel = nmeters == 1 ? k : m == 0 ? length-1-k : length+k;
+      uint32_t val = k < nlit ? 255 : k == nlit ? (fill & 0xFF) : 0;
+      if (k+1 == vu.peak[m]) val = 255;
+      colors[pixel] = fx_hsv(VU_HUE_EMPTY - ((k*hue_step) >> 8), 255, val);
+      energy[pixel] = val;
+    }
+  }
+}
+
+// a beat lights the whole strip in the loudest bucket's color, which then
+// dies away
+static void _render_pulse(const viz_input_t* in, uint32_t* colors,
+                          uint8_t* energy) {
+
+  if (in->beat->is_beat) {
+    int32_t excess;
+    pulse.color = _bucket_color(in->config, _loudest(in, &excess), 255);
+    pulse.level = 255;
+  } else {
+    pulse.level = (pulse.level*PULSE_DECAY) >> 8;
+  }
+
+  uint32_t color = fx_scale(pulse.color, pulse.level + (pulse.level > 0));
+  for (int i=0; i<NUM_PIXELS; i++) {
+    colors[i] = color;
+    energy[i] = pulse.level;
+  }
+}
+
+// a band of hues, as bright as the sound is loud, that turns towards the
+// hue of the spectrum's centroid over the buckets (red for the bass around
+// to violet for the treble); a beat kicks it on
+static void _render_wheel(const viz_input_t* in, uint32_t* colors,
+                          uint8_t* energy) {
+
+  // the buckets weigh in by their shade, which keeps the sums small
+  uint32_t sum = 0, moment = 0, loudness = 0;
+  for (uint32_t ch=0; ch<in->nchannels; ch++) {
+    for (int i=0; i<NBUCKETS; i++) {
+      uint32_t intensity = fx_intensity(_excess(in, ch, i));
+      sum += intensity;
+      moment += intensity*i;
+      if (intensity > loudness) loudness = intensity;
+    }
+  }
+
+  // the shorter way around the circle, in 8.8
+  if (sum > 0) {
+    uint32_t target = (moment << 16)/(sum*NBUCKETS);
+    int32_t turn = (int16_t)(target - wheel.hue);
+    wheel.hue += turn >> WHEEL_EASE_SHIFT;
+  }
+  if (in->beat->is_beat) wheel.hue += WHEEL_BEAT_KICK << 8;
+
+  uint32_t hue = wheel.hue >> 8;
+  for (int i=0; i<NUM_PIXELS; i++) {
+    colors[i] = fx_hsv(hue + (i*WHEEL_SPREAD)/NUM_PIXELS, 255, loudness);
+    energy[i] = loudness;
+  }
+}
+
+// the bass sparks heat at the start of the strip, which rises along it and
+// cools at random, shown through the heat gradient
+static void _render_fire(const viz_input_t* in, uint32_t* colors,
+                         uint8_t* energy) {
+
+  for (int i=0; i<NUM_PIXELS; i++) {
+    uint32_t cooling = ((_random() & 0xFF)*FIRE_COOLING) >> 8;
+    fire.heat[i] = fire.heat[i] > cooling ? fire.heat[i] - cooling : 0;
+  }
+
+  // each pixel takes the heat of the two below it, the nearer twice
+  for (int i=NUM_PIXELS-1; i>=2; i--) {
+    fire.heat[i] = ((fire.heat[i-1]*2 + fire.heat[i-2])*85) >> 8;
+  }
+
+  int32_t bass = INT32_MIN;
+  for (uint32_t ch=0; ch<in->nchannels; ch++) {
+    for (int i=0; i<2; i++) {
+      if (_excess(in, ch, i) > bass) bass = _excess(in, ch, i);
+    }
+  }
+  uint32_t spark = _random() % FIRE_SPARKS;
+  uint32_t heat = fire.heat[spark] + fx_intensity(bass);
+  fire.heat[spark] = heat > 255 ? 255 : heat;
+
+  const fx_palette_t* palette = &fx_palettes[FX_PALETTE_HEAT];
+  for (int i=0; i<NUM_PIXELS; i++) {
+    uint32_t h = fire.heat[i];
+    colors[i] = fx_scale(fx_palette_color(palette, (h*240) >> 8),
+                         h + (h > 0));
+    energy[i] = h;
+  }
+}
+
+// a beat starts a ring at the loudest bucket's pixel, which spreads a pixel
+// a frame each way and fades; rings that cross add up
+static void _render_ripple(const viz_input_t* in, uint32_t* colors,
+                           uint8_t* energy) {
+
+  if (in->beat->is_beat) {
+    int32_t excess;
+    int bucket = _loudest(in, &excess);
+    ripple.rings[ripple.next].center = bucket*(NUM_PIXELS-1)/(NBUCKETS-1);
+    ripple.rings[ripple.next].radius = 0;
+    ripple.rings[ripple.next].level = 255;
+    ripple.rings[ripple.next].color = _bucket_color(in->config, bucket, 255);
+    ripple.next = (ripple.next + 1) % RIPPLE_MAX;
+  }
+
+  memset(colors, 0, NUM_PIXELS*sizeof(uint32_t));
+  memset(energy, 0, NUM_PIXELS);
+
+  for (int r=0; r<RIPPLE_MAX; r++) {
+    if (ripple.rings[r].level == 0) continue;
+    uint32_t color = fx_scale(ripple.rings[r].color,
+                              ripple.rings[r].level + 1);
+    int32_t side[2] = { ripple.rings[r].center - ripple.rings[r].radius,
+                        ripple.rings[r].center + ripple.rings[r].radius };
+    for (int s=0; s<2; s++) {
+      if (side[s] < 0 || side[s] >= NUM_PIXELS) continue;
+      colors[side[s]] = _add(colors[side[s]], color);
+      if (ripple.rings[r].level > energy[side[s]]) {
+        energy[side[s]] = ripple.rings[r].level;
+      }
+    }
+
+    ripple.rings[r].radius++;
+    ripple.rings[r].level = (ripple.rings[r].level*RIPPLE_DECAY) >> 8;
+    if (ripple.rings[r].radius >= NUM_PIXELS) ripple.rings[r].level = 0;
+  }
+}
+
+// see .h for more details
+const viz_mode_t viz_modes[VIZ_NMODES] = {
+  [VIZ_MODE_SPECTRUM] = { "spectrum", _render_spectrum, 0 },
+  [VIZ_MODE_VU]       = { "vu", _render_vu, sizeof(vu) },
+  [VIZ_MODE_PULSE]    = { "pulse", _render_pulse, sizeof(pulse) },
+  [VIZ_MODE_WHEEL]    = { "wheel", _render_wheel, sizeof(wheel) },
+  [VIZ_MODE_FIRE]     = { "fire", _render_fire, sizeof(fire) },
+  [VIZ_MODE_RIPPLE]   = { "ripple", _render_ripple, sizeof(ripple) },
+};
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+// see .h for more details
+void viz_render(viz_mode_id_t mode, const viz_input_t* in, uint32_t* colors,
+                uint8_t* energy) {
+
+  if (mode >= VIZ_NMODES) mode = VIZ_MODE_SPECTRUM;
+
+  uint32_t t_start = ts_now();
+  viz_modes[mode].render(in, colors, energy);
+  uint32_t ticks = ts_elapsed(t_start);
+
+  viz_mode_stats_t* s = &stats[mode];
+  if (ticks > s->max_ticks) s->max_ticks = ticks;
+  s->sum_ticks += ticks;
+  s->count++;
+}
+
+// see .h for more details
+int viz_find_mode(const char* name) {
+  for (int i=0; i<VIZ_NMODES; i++) {
+    if (!strcmp(name, viz_modes[i].name)) return i;
+  }
+  return -1;
+}
+
+// see .h for more details
+int viz_get_mode_stats(viz_mode_id_t mode, viz_mode_stats_t* dest) {
+  if (mode >= VIZ_NMODES || dest == NULL) return -1;
+  *dest = stats[mode];
+  return 0;
+}
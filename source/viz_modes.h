@@ -0,0 +1,97 @@
+/* -----------------------------------------------------------------------------
+ * viz_modes.h - The ways a frame's analysis is drawn on the strip
+ *
+ * Each mode turns the bucket peaks and the beat of a frame into the colors
+ * of the pixels:
+ *
+ *   spectrum  each bucket lights its own pixel (mono, split or balance view)
+ *   vu        a level meter per channel, green to red, with a peak hold
+ *   pulse     the whole strip flashes on each beat and dies away
+ *   wheel     a band of hues that turns to where the sound sits in the
+ *             spectrum, kicked along by the beats
+ *   fire      flames rising from the start of the strip, fed by the bass
+ *   ripple    rings spreading out from the loudest bucket on each beat
+ *
+ * A mode is a render function and the state it keeps between frames, in
+ * the const viz_modes[] table in flash. viz_render() dispatches with one
+ * indirect call per frame, nothing per pixel, and times the call, so each
+ * mode reports what it costs per frame next to the RAM it keeps.
+ *
+ * @author  Jake Michael
+ * @date    2026-10-19
+ * @rev     1.0
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _VIZ_MODES_H_
+#define _VIZ_MODES_H_
+
+#include <stdint.h>
+#include "visualizer.h"
+
+// what a mode draws a frame from
+typedef struct {
+  const fft_peaks* peaks;       // the bucket peaks of each channel
+  uint32_t nchannels;
+  const viz_beat_t* beat;
+  const viz_config_t* config;
+} viz_input_t;
+
+// draws one frame: the color of each of the NUM_PIXELS pixels, and how loud
+// the sound behind it is, 0 to 255, which speeds up its cross-fade
+typedef void (*viz_render_t)(const viz_input_t* in, uint32_t* colors,
+                             uint8_t* energy);
+
+// a mode
+typedef struct {
+  const char* name;             // as typed on the console
+  viz_render_t render;
+  uint32_t ram_bytes;           // the state kept between frames
+} viz_mode_t;
+
+// what rendering a mode has cost
+typedef struct {
+  uint32_t count;               // frames rendered
+  uint32_t max_ticks;           // in timestamp ticks (see timestamp.h)
+  uint64_t sum_ticks;
+} viz_mode_stats_t;
+
+// the modes, indexed by viz_mode_id_t
+extern const viz_mode_t viz_modes[VIZ_NMODES];
+
+/*
+ * -----------------------------------------------------------------------------
+ *    PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------
+ */
+
+/*
+ * @brief   Draws a frame in a mode
+ *
+ * @param   mode, the mode, VIZ_MODE_SPECTRUM if out of range
+ *          in, the frame's analysis and the parameters
+ *          colors, destination for NUM_PIXELS 24-bit colors
+ *          energy, destination for NUM_PIXELS levels, 0 to 255
+ * @return  none
+ */
+void viz_render(viz_mode_id_t mode, const viz_input_t* in, uint32_t* colors,
+                uint8_t* energy);
+
+/*
+ * @brief   Looks up a mode by name
+ *
+ * @param   name, the name of the mode
+ * @return  int, the viz_mode_id_t of the mode, -1 if there is none
+ */
+int viz_find_mode(const char* name);
+
+/*
+ * @brief   Copies what a mode has cost so far
+ *
+ * @param   mode, the mode
+ *          stats, destination for its timings
+ * @return  0 on success, -1 for an unknown mode
+ */
+int viz_get_mode_stats(viz_mode_id_t mode, viz_mode_stats_t* stats);
+
+#endif // _VIZ_MODES_H_